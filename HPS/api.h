@@ -42,6 +42,28 @@ extern "C" {
 #define ERR_TIMEOUT   -2  // Hardware não respondeu (timeout)
 #define ERR_HW        -3  // FPGA reportou um erro (FLAG_ERROR)
 
+/* Tempos padrão do driver até ASM_Set_Timing (TIMEOUT_LIMIT e DELAY_COUNT em lib.s) */
+#define DRV_DEFAULT_TIMEOUT_POLLS 0x3500  // Leituras de flags por tentativa
+#define DRV_DEFAULT_SETTLE_LOOPS  0x1000  // Voltas do laço de espera após cada pixel
+
+/* ===================================================================
+ * Estruturas de Dados
+ * =================================================================== */
+
+/**
+ * @brief Contadores acumulados do driver (mesma ordem de drv_stats em lib.s)
+ */
+typedef struct {
+    unsigned int stores;         // Chamadas a ASM_Store com endereço válido
+    unsigned int loads;          // Chamadas a ASM_Load com endereço válido
+    unsigned int timeouts;       // Sem FLAG_DONE mesmo após a nova tentativa
+    unsigned int hw_errors;      // FLAG_ERROR junto com FLAG_DONE
+    unsigned int invalid_addr;   // Endereços fora da imagem
+    unsigned int retries;        // Pacotes repetidos após um primeiro timeout
+    unsigned int worst_spin;     // Maior número de leituras de flags até FLAG_DONE
+    unsigned int total_spin;     // Leituras de flags das operações concluídas
+} DriverStats;
+
 /* ===================================================================
  * Protótipos das Funções Públicas (de lib.s)
  * =================================================================== */
@@ -65,6 +87,7 @@ extern void API_close(void);
  * @param address O endereço na VRAM do FPGA (0 a 76799).
  * @param pixel_data O valor do pixel (8 bits).
  * @param mem_sel 0 para Memória Principal, 1 para Memória Secundária (Bit 20).
+ * Após um primeiro timeout o pacote é repetido uma vez.
  * @return 0 (Sucesso), -1 (Endereço Inválido), -2 (Timeout), -3 (Erro de Hardware).
  */
 extern int ASM_Store(unsigned int address, unsigned char pixel_data, int mem_sel);
@@ -73,6 +96,8 @@ extern int ASM_Store(unsigned int address, unsigned char pixel_data, int mem_sel
  * @brief Lê um pixel do FPGA.
  * @param address Endereço na VRAM.
  * @param mem_sel 0 para Memória Principal, 1 para Memória Secundária (Bit 20).
+ * Após um primeiro timeout o pacote é repetido uma vez.
+ * @return O pixel (0 a 255), ou -1 (Endereço Inválido), -2 (Timeout), -3 (Erro de Hardware).
  */
 
 extern int ASM_Load(unsigned int address, int mem_sel);
@@ -88,6 +113,24 @@ extern void ASM_Refresh(void);
  */
 extern void ASM_Pulse_Enable(void);
 
+/**
+ * @brief Copia os contadores acumulados do driver.
+ * @param out Destino dos contadores.
+ */
+extern void ASM_Get_Stats(DriverStats *out);
+
+/**
+ * @brief Zera os contadores do driver.
+ */
+extern void ASM_Clear_Stats(void);
+
+/**
+ * @brief Substitui os tempos padrão do driver (calibração, timing_utils.h).
+ * @param timeout_polls Leituras de flags por tentativa antes do timeout.
+ * @param settle_loops Voltas do laço de espera após cada pixel (0 = nenhuma).
+ */
+extern void ASM_Set_Timing(unsigned int timeout_polls, unsigned int settle_loops);
+
 /*
  * ===================================================================
  * Funções de Algoritmo (ASSÍNCRONAS)
@@ -0,0 +1,221 @@
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdint.h>
+#include <unistd.h>
+#include "api.h"
+#include "vram_utils.h"
+#include "latency_utils.h"
+#include "residency_utils.h"
+#include "command_utils.h"
+#include "timing_utils.h"
+#include "metrics_utils.h"
+#include "verify_utils.h"
+
+// O que a tela exibe
+#define SHOW_UNKNOWN 0
+#define SHOW_PRIMARY 1               // Memória Principal, com o conteúdo de hash shown_hash
+
+/* Estado acompanhado do hardware */
+static int hw_reset = 0;             // Nenhum algoritmo desde o último Reset (desconhecido no início)
+static int shown = SHOW_UNKNOWN;
+static uint32_t shown_hash;
+
+/* Estatísticas */
+static long resets_sent, resets_elided;
+static long refreshes_sent, refreshes_elided;
+static long uploads, uploads_elided;
+static long pixels_sent, pixels_elided;
+static long recoveries, recoveries_failed;
+static long retries_ok, retries_failed;
+
+static int verify_percent;           // Fração conferida após cada envio (0 = desligado)
+
+
+/*
+ * --- COMANDOS ---
+ */
+
+int cmd_reset(int force) {
+    if (hw_reset && !force) {
+        resets_elided++;
+        met_add(MET_RESET_ELIDED, 1);
+        return 0;
+    }
+
+    ASM_Reset();
+    ASM_Pulse_Enable();
+    lat_stage_enter(LAT_STAGE_WAIT);
+    usleep(CMD_RESET_SETTLE_US);
+    lat_stage_leave(LAT_STAGE_WAIT);
+
+    hw_reset = 1;
+    shown = SHOW_UNKNOWN;
+    res_reset();
+    resets_sent++;
+    met_add(MET_RESET_SENT, 1);
+    return 1;
+}
+
+int cmd_upload_frame(const uint8_t *frame) {
+    int sent;
+
+    uploads++;
+    if (vram_mirror_valid()) {
+        sent = vram_sync_frame(frame);
+    } else {
+        sent = (vram_write_frame(frame) == 0) ? IMG_SIZE : -1;
+    }
+    if (sent < 0) {
+        return -1;
+    }
+
+    // Divergência: a VRAM não tem o que o espelho diz; o próximo envio será completo
+    if (verify_percent > 0 && sent > 0) {
+        VerifyReport report;
+        int bad = verify_primary(verify_percent, &report);
+        if (bad >= 0) {
+            verify_print(&report);
+        }
+        if (bad > 0) {
+            vram_mirror_invalidate();
+        }
+    }
+
+    pixels_sent += sent;
+    pixels_elided += IMG_SIZE - sent;
+    met_add(MET_UPLOAD_PIXELS_SENT, sent);
+    met_add(MET_UPLOAD_PIXELS_ELIDED, IMG_SIZE - sent);
+    if (sent == 0) {
+        uploads_elided++;
+        met_add(MET_UPLOAD_ELIDED, 1);
+    } else {
+        met_add(MET_UPLOAD_SENT, 1);
+    }
+    return sent;
+}
+
+void cmd_set_verify(int percent) {
+    verify_percent = percent;
+}
+
+int cmd_refresh(void) {
+    // Inclui o conteúdo que mudou e voltou ao que já está na tela
+    if (shown == SHOW_PRIMARY && vram_mirror_valid() && vram_mirror_hash() == shown_hash) {
+        lat_refresh();
+        res_show_primary();
+        refreshes_elided++;
+        met_add(MET_REFRESH_ELIDED, 1);
+        return 0;
+    }
+
+    vram_refresh();
+    res_show_primary();
+    refreshes_sent++;
+    met_add(MET_REFRESH_SENT, 1);
+
+    if (vram_mirror_valid()) {
+        shown = SHOW_PRIMARY;
+        shown_hash = vram_mirror_hash();
+    } else {
+        shown = SHOW_UNKNOWN;
+    }
+    return 1;
+}
+
+void cmd_algorithm(int op, int ok) {
+    hw_reset = 0;
+    shown = SHOW_UNKNOWN;
+    res_transform(op, ok);
+}
+
+void cmd_invalidate(void) {
+    shown = SHOW_UNKNOWN;
+    res_show_primary();
+}
+
+
+/*
+ * --- RECUPERAÇÃO ---
+ */
+
+int cmd_recover(const uint8_t *frame) {
+    int waited = 0;
+
+    recoveries++;
+    met_add(MET_RECOVERIES, 1);
+    cmd_reset(1);
+
+    // Reset aceito: flags de erro e de limite de zoom zeradas
+    while (ASM_Get_Flag_Error() || ASM_Get_Flag_Max_Zoom() || ASM_Get_Flag_Min_Zoom()) {
+        if (waited >= CMD_IDLE_WAIT_US) {
+            printf("   [C] Recuperacao: flags nao zeraram apos o Reset.\n");
+            recoveries_failed++;
+            met_add(MET_RECOVERIES_FAILED, 1);
+            return -1;
+        }
+        usleep(CMD_IDLE_POLL_US);
+        waited += CMD_IDLE_POLL_US;
+    }
+
+    if (frame == NULL) {
+        printf("   [C] Recuperacao: sem copia no host da entrada do algoritmo.\n");
+        recoveries_failed++;
+        met_add(MET_RECOVERIES_FAILED, 1);
+        return -1;
+    }
+
+    // Conteúdo da Memória Principal incerto: quadro inteiro, sem comparar com o espelho
+    vram_mirror_invalidate();
+    if (cmd_upload_frame(frame) < 0) {
+        printf("   [C] Recuperacao: falha ao reenviar o quadro.\n");
+        recoveries_failed++;
+        met_add(MET_RECOVERIES_FAILED, 1);
+        return -1;
+    }
+    cmd_refresh();
+    return 0;
+}
+
+void cmd_retry_result(int ok) {
+    if (ok) {
+        retries_ok++;
+    } else {
+        retries_failed++;
+    }
+}
+
+
+/*
+ * --- RELATÓRIO ---
+ */
+
+void cmd_dump(void) {
+    printf("\n=== FLUXO DE COMANDOS (enviados / descartados) ===\n");
+    printf("Reset:    %6ld / %ld\n", resets_sent, resets_elided);
+    printf("Refresh:  %6ld / %ld\n", refreshes_sent, refreshes_elided);
+    printf("Quadros:  %6ld / %ld sem nenhuma escrita\n", uploads - uploads_elided, uploads_elided);
+    printf("Pixels:   %6ld / %ld iguais a VRAM\n", pixels_sent, pixels_elided);
+    printf("Recuperacoes: %ld (%ld sem sucesso) | Novas tentativas: %ld OK, %ld falharam\n",
+           recoveries, recoveries_failed, retries_ok, retries_failed);
+
+    DriverStats drv;
+    ASM_Get_Stats(&drv);
+    printf("Driver: %u escritas, %u leituras | %u timeouts, %u erros de hardware, %u enderecos invalidos\n",
+           drv.stores, drv.loads, drv.timeouts, drv.hw_errors, drv.invalid_addr);
+    unsigned int done = drv.stores + drv.loads - drv.timeouts - drv.hw_errors;
+    printf("        %u pacotes repetidos apos timeout | leituras de flags: %.1f em media, pior %u de %u\n",
+           drv.retries, done ? (double)drv.total_spin / done : 0.0, drv.worst_spin,
+           timing_current()->timeout_polls);
+}
+
+void cmd_stats_clear(void) {
+    resets_sent = resets_elided = 0;
+    refreshes_sent = refreshes_elided = 0;
+    uploads = uploads_elided = 0;
+    pixels_sent = pixels_elided = 0;
+    recoveries = recoveries_failed = 0;
+    retries_ok = retries_failed = 0;
+    metrics_fold_driver();
+    ASM_Clear_Stats();
+}
@@ -0,0 +1,114 @@
+/*
+ * =========================================================================
+ * command_utils.h: Header do fluxo de comandos do coprocessador
+ * =========================================================================
+ *
+ * Camada entre o programa e o driver (lib.s) para os comandos que
+ * mudam o estado do coprocessador: Reset, envio de quadro à Memória
+ * Principal e Refresh. O estado do hardware é acompanhado (se ele está
+ * resetado, o que a tela exibe e o conteúdo da Memória Principal) e os
+ * comandos que não mudariam nada são descartados antes do barramento:
+ *
+ *   Reset    - nenhum algoritmo rodou desde o último Reset
+ *   Envio    - só os pixels que diferem do espelho (vram_utils.h) vão ao
+ *              barramento; um quadro idêntico não gera nenhuma escrita
+ *   Refresh  - a tela já exibe a Memória Principal com este mesmo
+ *              conteúdo (hash do espelho, vram_utils.h)
+ *
+ * Qualquer algoritmo executado deve ser informado (cmd_algorithm), e
+ * qualquer Refresh feito por fora desta camada (sobreposições) deve
+ * chamar cmd_invalidate: na dúvida o comando é sempre enviado. Os
+ * mesmos eventos alimentam o registro do conteúdo de cada memória
+ * (residency_utils.h).
+ *
+ */
+
+#ifndef COMMAND_UTILS_H
+#define COMMAND_UTILS_H
+
+#include <stdint.h>
+
+/* ===================================================================
+ * Constantes
+ * =================================================================== */
+#define CMD_RESET_SETTLE_US 10000    // Espera após Reset + Pulse_Enable (PULSE_DELAY_US em main.c)
+#define CMD_IDLE_WAIT_US    50000    // Recuperação: espera máxima pelas flags zeradas
+#define CMD_IDLE_POLL_US    1000
+
+/* ===================================================================
+ * Protótipos das Funções
+ * =================================================================== */
+
+/**
+ * @brief Reset do coprocessador (Reset, Pulse_Enable e espera)
+ * @param force 1 para enviar mesmo se já resetado (pedido explícito, recuperação)
+ * @return 1 se enviado, 0 se descartado (já estava resetado)
+ */
+int cmd_reset(int force);
+
+/**
+ * @brief Coloca um quadro completo na Memória Principal
+ *
+ * Com o espelho válido, só os pixels diferentes são escritos; sem ele,
+ * o quadro inteiro.
+ * @return Número de pixels escritos, ou -1 se alguma escrita falhou
+ */
+int cmd_upload_frame(const uint8_t *frame);
+
+/**
+ * @brief Confere a VRAM após cada cmd_upload_frame que escreveu pixels
+ *
+ * Blocos divergentes são impressos e invalidam o espelho, de modo que o
+ * envio seguinte é completo.
+ * @param percent Fração dos blocos lida (verify_utils.h), 0 = desligado
+ */
+void cmd_set_verify(int percent);
+
+/**
+ * @brief Exibe a Memória Principal (Refresh e espera da cópia)
+ *
+ * Descartado, a medição de latência aberta é fechada do mesmo modo:
+ * a tela já mostra o resultado.
+ * @return 1 se enviado, 0 se descartado
+ */
+int cmd_refresh(void);
+
+/**
+ * @brief Informa que um algoritmo terminou (a tela passa a exibir a saída)
+ * @param op Transformação aplicada (RES_OP_*, residency_utils.h)
+ * @param ok 0 se terminou com erro ou timeout
+ */
+void cmd_algorithm(int op, int ok);
+
+/**
+ * @brief Recupera o coprocessador depois de um timeout ou FLAG_ERROR
+ *
+ * Reset forçado, espera as flags voltarem a zero e reenvia por completo
+ * o último quadro bom (a cópia no host da entrada do algoritmo), já que
+ * o estado do hardware é incerto. A nova tentativa fica com quem chamou.
+ * @param frame Quadro a reenviar (NULL se o host não o tem: só o Reset)
+ * @return 0 se o coprocessador está pronto para tentar de novo, -1 caso contrário
+ */
+int cmd_recover(const uint8_t *frame);
+
+/**
+ * @brief Informa o resultado da nova tentativa após cmd_recover
+ */
+void cmd_retry_result(int ok);
+
+/**
+ * @brief Esquece o que a tela exibe (Refresh feito fora desta camada)
+ */
+void cmd_invalidate(void);
+
+/**
+ * @brief Imprime os comandos enviados e descartados e os contadores do driver
+ */
+void cmd_dump(void);
+
+/**
+ * @brief Zera as estatísticas (inclusive os contadores do driver)
+ */
+void cmd_stats_clear(void);
+
+#endif /* COMMAND_UTILS_H */
@@ -0,0 +1,268 @@
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/eventfd.h>
+#include "api.h"
+#include "event_loop.h"
+
+// Tipos de fonte
+#define EV_KIND_FD     0
+#define EV_KIND_TIMER  1
+#define EV_KIND_COPROC 2
+
+// Eventos tratados por chamada a epoll_wait
+#define EV_BATCH 8
+
+
+/*
+ * --- FUNÇÕES INTERNAS ---
+ */
+
+// Primeira posição livre da tabela de fontes
+static int alloc_source(EventLoop *loop) {
+    for (int id = 0; id < EV_MAX_SOURCES; id++) {
+        if (!loop->sources[id].active) return id;
+    }
+    return -1;
+}
+
+// Registra a fonte no epoll; o id vai no próprio evento
+static int register_source(EventLoop *loop, int id, int kind, int fd, uint32_t events,
+                           EvHandler handler, void *user) {
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.u32 = (uint32_t)id;
+
+    if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        return -1;
+    }
+
+    EvSource *src = &loop->sources[id];
+    memset(src, 0, sizeof(*src));
+    src->active = 1;
+    src->kind = kind;
+    src->fd = fd;
+    src->handler = handler;
+    src->user = user;
+    src->sampler = -1;
+    return id;
+}
+
+static int timespec_passed(const struct timespec *deadline) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec > deadline->tv_sec ||
+           (now.tv_sec == deadline->tv_sec && now.tv_nsec >= deadline->tv_nsec);
+}
+
+// Timer interno: amostra FLAG_DONE e sinaliza o eventfd da fonte do coprocessador
+static void coproc_sample(EventLoop *loop, int id, uint32_t events, void *user) {
+    int coproc_id = (int)(intptr_t)user;
+    EvSource *src = &loop->sources[coproc_id];
+    (void)events;
+
+    if (!src->active || src->kind != EV_KIND_COPROC) {
+        ev_remove(loop, id);
+        return;
+    }
+
+    if (ASM_Get_Flag_Done() != 0) {
+        src->status = (ASM_Get_Flag_Error() != 0) ? EV_COPROC_ERROR : EV_COPROC_DONE;
+    } else if (timespec_passed(&src->deadline)) {
+        src->status = EV_COPROC_TIMEOUT;
+    } else {
+        return;
+    }
+
+    uint64_t one = 1;
+    if (write(src->fd, &one, sizeof(one)) != sizeof(one)) {
+        perror("eventfd");
+    }
+    ev_remove(loop, id);
+    src->sampler = -1;
+}
+
+
+/*
+ * --- CICLO DE VIDA ---
+ */
+
+int ev_init(EventLoop *loop) {
+    memset(loop, 0, sizeof(*loop));
+    loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    return (loop->epoll_fd < 0) ? -1 : 0;
+}
+
+void ev_close(EventLoop *loop) {
+    for (int id = 0; id < EV_MAX_SOURCES; id++) {
+        if (loop->sources[id].active) {
+            ev_remove(loop, id);
+        }
+    }
+    if (loop->epoll_fd >= 0) {
+        close(loop->epoll_fd);
+        loop->epoll_fd = -1;
+    }
+}
+
+
+/*
+ * --- FONTES ---
+ */
+
+int ev_add_fd(EventLoop *loop, int fd, uint32_t events, EvHandler handler, void *user) {
+    int id = alloc_source(loop);
+    if (id < 0) return -1;
+    return register_source(loop, id, EV_KIND_FD, fd, events, handler, user);
+}
+
+int ev_add_timer(EventLoop *loop, int interval_ms, int periodic, EvHandler handler, void *user) {
+    int id = alloc_source(loop);
+    if (id < 0) return -1;
+
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0) return -1;
+
+    struct itimerspec spec;
+    memset(&spec, 0, sizeof(spec));
+    spec.it_value.tv_sec = interval_ms / 1000;
+    spec.it_value.tv_nsec = (long)(interval_ms % 1000) * 1000000L;
+    if (periodic) {
+        spec.it_interval = spec.it_value;
+    }
+
+    if (timerfd_settime(fd, 0, &spec, NULL) < 0 ||
+        register_source(loop, id, EV_KIND_TIMER, fd, EPOLLIN, handler, user) < 0) {
+        close(fd);
+        return -1;
+    }
+    return id;
+}
+
+int ev_add_coproc(EventLoop *loop, int timeout_ms, EvHandler handler, void *user) {
+    int id = alloc_source(loop);
+    if (id < 0) return -1;
+
+    int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd < 0) return -1;
+
+    if (register_source(loop, id, EV_KIND_COPROC, fd, EPOLLIN, handler, user) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    EvSource *src = &loop->sources[id];
+    clock_gettime(CLOCK_MONOTONIC, &src->deadline);
+    src->deadline.tv_sec += timeout_ms / 1000;
+    src->deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (src->deadline.tv_nsec >= 1000000000L) {
+        src->deadline.tv_sec++;
+        src->deadline.tv_nsec -= 1000000000L;
+    }
+
+    src->sampler = ev_add_timer(loop, EV_COPROC_SAMPLE_MS, 1, coproc_sample, (void*)(intptr_t)id);
+    if (src->sampler < 0) {
+        ev_remove(loop, id);
+        return -1;
+    }
+    return id;
+}
+
+int ev_set_events(EventLoop *loop, int id, uint32_t events) {
+    if (id < 0 || id >= EV_MAX_SOURCES || !loop->sources[id].active ||
+        loop->sources[id].kind != EV_KIND_FD) {
+        return -1;
+    }
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.u32 = (uint32_t)id;
+    return epoll_ctl(loop->epoll_fd, EPOLL_CTL_MOD, loop->sources[id].fd, &ev);
+}
+
+void ev_remove(EventLoop *loop, int id) {
+    if (id < 0 || id >= EV_MAX_SOURCES || !loop->sources[id].active) {
+        return;
+    }
+
+    EvSource *src = &loop->sources[id];
+    epoll_ctl(loop->epoll_fd, EPOLL_CTL_DEL, src->fd, NULL);
+
+    // timerfd e eventfd pertencem ao laço; fds externos não
+    if (src->kind != EV_KIND_FD) {
+        close(src->fd);
+    }
+    if (src->kind == EV_KIND_COPROC && src->sampler >= 0) {
+        int sampler = src->sampler;
+        src->sampler = -1;
+        ev_remove(loop, sampler);
+    }
+    src->active = 0;
+}
+
+
+/*
+ * --- DESPACHO ---
+ */
+
+int ev_run_once(EventLoop *loop, int timeout_ms) {
+    struct epoll_event events[EV_BATCH];
+
+    int n = epoll_wait(loop->epoll_fd, events, EV_BATCH, timeout_ms);
+    if (n < 0) {
+        return (errno == EINTR) ? 0 : -1;
+    }
+
+    int dispatched = 0;
+    for (int i = 0; i < n; i++) {
+        int id = (int)events[i].data.u32;
+        EvSource *src = &loop->sources[id];
+
+        // Um handler anterior do mesmo lote pode ter removido a fonte
+        if (!src->active) continue;
+
+        uint64_t count = 0;
+        uint32_t arg = events[i].events;
+
+        if (src->kind == EV_KIND_TIMER || src->kind == EV_KIND_COPROC) {
+            if (read(src->fd, &count, sizeof(count)) != sizeof(count)) continue;
+            arg = (src->kind == EV_KIND_TIMER) ? (uint32_t)count : src->status;
+        }
+
+        EvHandler handler = src->handler;
+        void *user = src->user;
+
+        // A fonte do coprocessador dispara uma única vez
+        if (src->kind == EV_KIND_COPROC) {
+            ev_remove(loop, id);
+        }
+
+        handler(loop, id, arg, user);
+        dispatched++;
+    }
+
+    loop->dispatched += dispatched;
+    return dispatched;
+}
+
+int ev_run(EventLoop *loop) {
+    loop->stop = 0;
+    while (!loop->stop) {
+        if (ev_run_once(loop, -1) < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void ev_stop(EventLoop *loop) {
+    loop->stop = 1;
+}
@@ -0,0 +1,146 @@
+/*
+ * =========================================================================
+ * event_loop.h: Header do laço de eventos (reator epoll)
+ * =========================================================================
+ *
+ * Um único epoll concentra todas as fontes de eventos do programa: fds de
+ * entrada (mouse, stdin), temporizadores (timerfd) e a conclusão das
+ * operações do coprocessador. Cada fonte registra um handler, chamado
+ * pelo laço quando a fonte fica pronta.
+ *
+ * O coprocessador não gera interrupção para o HPS: a conclusão é
+ * detectada por um timerfd que amostra FLAG_DONE a cada
+ * EV_COPROC_SAMPLE_MS e sinaliza um eventfd. Quem espera a operação vê
+ * apenas o eventfd, que poderia vir de um driver com interrupção sem
+ * mudar o restante do código.
+ *
+ */
+
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include <stdint.h>
+#include <time.h>
+
+/* ===================================================================
+ * Constantes
+ * =================================================================== */
+#define EV_MAX_SOURCES 16
+#define EV_COPROC_SAMPLE_MS 1        // Período de amostragem de FLAG_DONE
+
+/* Resultado entregue ao handler de uma fonte do coprocessador */
+#define EV_COPROC_DONE    1
+#define EV_COPROC_ERROR   2          // FLAG_ERROR ativa ao concluir
+#define EV_COPROC_TIMEOUT 3
+
+/* ===================================================================
+ * Estruturas de Dados
+ * =================================================================== */
+
+struct EventLoop;
+
+/**
+ * @brief Handler de uma fonte
+ * @param id Identificador retornado no registro
+ * @param events fd: máscara do epoll; timer: expirações; coprocessador: EV_COPROC_*
+ */
+typedef void (*EvHandler)(struct EventLoop *loop, int id, uint32_t events, void *user);
+
+/**
+ * @brief Uma fonte registrada no laço
+ */
+typedef struct {
+    int active;
+    int kind;                   // Tipo interno da fonte
+    int fd;                     // fd observado (timerfd/eventfd são do laço)
+    EvHandler handler;
+    void *user;
+
+    /* Apenas para fontes do coprocessador */
+    int sampler;                // Timer que amostra FLAG_DONE
+    struct timespec deadline;   // Limite para o timeout
+    uint32_t status;            // EV_COPROC_* a entregar
+} EvSource;
+
+/**
+ * @brief Estado do laço de eventos
+ */
+typedef struct EventLoop {
+    int epoll_fd;
+    EvSource sources[EV_MAX_SOURCES];
+    int stop;
+    long dispatched;            // Handlers chamados desde ev_init
+} EventLoop;
+
+/* ===================================================================
+ * Protótipos das Funções
+ * =================================================================== */
+
+/**
+ * @brief Cria o epoll do laço
+ * @return 0 em caso de sucesso, -1 em caso de falha
+ */
+int ev_init(EventLoop *loop);
+
+/**
+ * @brief Remove todas as fontes e fecha o epoll
+ */
+void ev_close(EventLoop *loop);
+
+/**
+ * @brief Observa um fd existente (o laço não o fecha)
+ * @param events Máscara do epoll (ex.: EPOLLIN)
+ * @return Identificador da fonte, ou -1 em caso de falha
+ */
+int ev_add_fd(EventLoop *loop, int fd, uint32_t events, EvHandler handler, void *user);
+
+/**
+ * @brief Cria um temporizador (timerfd)
+ * @param interval_ms Período ou atraso em milissegundos
+ * @param periodic 1 para repetir, 0 para disparar uma vez
+ * @return Identificador da fonte, ou -1 em caso de falha
+ */
+int ev_add_timer(EventLoop *loop, int interval_ms, int periodic, EvHandler handler, void *user);
+
+/**
+ * @brief Aguarda a conclusão da operação já disparada no coprocessador
+ *
+ * O handler é chamado uma vez com EV_COPROC_DONE, EV_COPROC_ERROR ou
+ * EV_COPROC_TIMEOUT; a fonte é removida em seguida.
+ * @param timeout_ms Tempo máximo de espera
+ * @return Identificador da fonte, ou -1 em caso de falha
+ */
+int ev_add_coproc(EventLoop *loop, int timeout_ms, EvHandler handler, void *user);
+
+/**
+ * @brief Troca a máscara do epoll de uma fonte de fd
+ *
+ * Com 0 a fonte continua registrada, mas deixa de ser observada.
+ * @return 0 em caso de sucesso, -1 em caso de falha
+ */
+int ev_set_events(EventLoop *loop, int id, uint32_t events);
+
+/**
+ * @brief Remove uma fonte (fecha os fds criados pelo laço)
+ */
+void ev_remove(EventLoop *loop, int id);
+
+/**
+ * @brief Espera eventos e chama os handlers das fontes prontas
+ * @param timeout_ms Espera máxima (-1 = indefinida, 0 = não bloqueia)
+ * @return Número de handlers chamados, ou -1 em caso de falha
+ */
+int ev_run_once(EventLoop *loop, int timeout_ms);
+
+/**
+ * @brief Executa o laço até ev_stop
+ * @return 0 ao parar, -1 em caso de falha
+ */
+int ev_run(EventLoop *loop);
+
+/**
+ * @brief Pede a parada de ev_run (pode ser chamada de um handler)
+ */
+void ev_stop(EventLoop *loop);
+
+#endif /* EVENT_LOOP_H */
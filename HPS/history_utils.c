@@ -0,0 +1,205 @@
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "api.h"
+#include "history_utils.h"
+
+// Pior caso do PackBits: um byte de controle a cada 128 literais
+#define PACKED_MAX (IMG_SIZE + IMG_SIZE / 128 + 1)
+
+#define PACK_MAX_RUN 128
+#define PACK_MIN_RUN 3               // Carreiras menores saem mais baratas como literais
+
+
+/*
+ * --- COMPRESSÃO ---
+ */
+
+// Diferença de cada linha para a de cima (a primeira fica como está)
+static void rows_to_deltas(const uint8_t *frame, uint8_t *out) {
+    memcpy(out, frame, IMG_WIDTH);
+    for (int i = IMG_WIDTH; i < IMG_SIZE; i++) {
+        out[i] = (uint8_t)(frame[i] - frame[i - IMG_WIDTH]);
+    }
+}
+
+static void deltas_to_rows(uint8_t *frame) {
+    for (int i = IMG_WIDTH; i < IMG_SIZE; i++) {
+        frame[i] = (uint8_t)(frame[i] + frame[i - IMG_WIDTH]);
+    }
+}
+
+// PackBits: controle c em [0,127] = c+1 literais; em [129,255] = carreira de 257-c
+static int pack(const uint8_t *src, int n, uint8_t *out) {
+    int pos = 0;
+    int i = 0;
+
+    while (i < n) {
+        int run = 1;
+        while (i + run < n && run < PACK_MAX_RUN && src[i + run] == src[i]) {
+            run++;
+        }
+        if (run >= PACK_MIN_RUN) {
+            out[pos++] = (uint8_t)(257 - run);
+            out[pos++] = src[i];
+            i += run;
+            continue;
+        }
+
+        // Literais até o início da próxima carreira
+        int start = i;
+        int count = 0;
+        while (i < n && count < PACK_MAX_RUN) {
+            if (i + 2 < n && src[i] == src[i + 1] && src[i] == src[i + 2]) {
+                break;
+            }
+            i++;
+            count++;
+        }
+        out[pos++] = (uint8_t)(count - 1);
+        memcpy(out + pos, src + start, count);
+        pos += count;
+    }
+    return pos;
+}
+
+static int unpack(const uint8_t *src, int size, uint8_t *out, int n) {
+    int pos = 0;
+    int i = 0;
+
+    while (i < size && pos < n) {
+        int c = src[i++];
+        if (c < 128) {
+            int count = c + 1;
+            if (i + count > size || pos + count > n) return -1;
+            memcpy(out + pos, src + i, count);
+            i += count;
+            pos += count;
+        } else if (c > 128) {
+            int run = 257 - c;
+            if (i >= size || pos + run > n) return -1;
+            memset(out + pos, src[i++], run);
+            pos += run;
+        }
+    }
+    return (pos == n) ? 0 : -1;
+}
+
+
+/*
+ * --- FUNÇÕES INTERNAS ---
+ */
+
+static void drop_entry(FrameHistory *hist, int index) {
+    hist->bytes -= hist->entries[index].size;
+    free(hist->entries[index].data);
+    memmove(&hist->entries[index], &hist->entries[index + 1],
+            (hist->count - index - 1) * sizeof(HistoryEntry));
+    hist->count--;
+}
+
+
+/*
+ * --- HISTÓRICO ---
+ */
+
+void history_init(FrameHistory *hist, size_t budget) {
+    memset(hist, 0, sizeof(*hist));
+    hist->pos = -1;
+    hist->budget = budget ? budget : HISTORY_BUDGET_BYTES;
+}
+
+void history_clear(FrameHistory *hist) {
+    for (int i = 0; i < hist->count; i++) {
+        free(hist->entries[i].data);
+    }
+    hist->count = 0;
+    hist->pos = -1;
+    hist->bytes = 0;
+}
+
+int history_push(FrameHistory *hist, const uint8_t *frame, int zoom_level) {
+    uint8_t *deltas = (uint8_t*)malloc(IMG_SIZE);
+    uint8_t *packed = (uint8_t*)malloc(PACKED_MAX);
+    if (!deltas || !packed) {
+        free(deltas);
+        free(packed);
+        return -1;
+    }
+
+    rows_to_deltas(frame, deltas);
+    int size = pack(deltas, IMG_SIZE, packed);
+    free(deltas);
+
+    // Codificação determinística: mesmos bytes = mesmo quadro
+    if (hist->pos >= 0) {
+        const HistoryEntry *current = &hist->entries[hist->pos];
+        if (current->zoom_level == zoom_level && current->size == size &&
+            memcmp(current->data, packed, size) == 0) {
+            free(packed);
+            return 0;
+        }
+    }
+
+    uint8_t *data = (uint8_t*)realloc(packed, size);
+    if (!data) {
+        data = packed;
+    }
+
+    // Novo ramo: o que estava à frente não é mais refazível
+    while (hist->count > hist->pos + 1) {
+        drop_entry(hist, hist->count - 1);
+    }
+    if (hist->count == HISTORY_MAX_ENTRIES) {
+        drop_entry(hist, 0);
+        hist->dropped++;
+    }
+
+    HistoryEntry *entry = &hist->entries[hist->count++];
+    entry->data = data;
+    entry->size = size;
+    entry->zoom_level = zoom_level;
+    hist->bytes += size;
+    hist->pos = hist->count - 1;
+
+    // Orçamento: descarta os mais antigos, nunca o atual
+    while (hist->bytes > hist->budget && hist->count > 1) {
+        drop_entry(hist, 0);
+        hist->dropped++;
+    }
+    hist->pos = hist->count - 1;
+    return 0;
+}
+
+int history_step(FrameHistory *hist, int step, uint8_t *frame_out, int *zoom_level_out) {
+    int target = hist->pos + step;
+    if (hist->pos < 0 || target < 0 || target >= hist->count) {
+        return -1;
+    }
+
+    const HistoryEntry *entry = &hist->entries[target];
+    if (unpack(entry->data, entry->size, frame_out, IMG_SIZE) != 0) {
+        return -1;
+    }
+    deltas_to_rows(frame_out);
+
+    hist->pos = target;
+    *zoom_level_out = entry->zoom_level;
+    return 0;
+}
+
+void history_dump(const FrameHistory *hist) {
+    printf("\n=== HISTORICO DE ZOOM GLOBAL (%d entradas, %zu de %zu bytes) ===\n",
+           hist->count, hist->bytes, hist->budget);
+    for (int i = 0; i < hist->count; i++) {
+        const HistoryEntry *entry = &hist->entries[i];
+        printf("%s %2d: nivel %+d, %6d bytes (%.1fx)\n", (i == hist->pos) ? ">" : " ",
+               i, entry->zoom_level, entry->size, (double)IMG_SIZE / entry->size);
+    }
+    if (hist->dropped > 0) {
+        printf("(%ld entradas antigas descartadas pelo limite)\n", hist->dropped);
+    }
+}
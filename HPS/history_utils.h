@@ -0,0 +1,93 @@
+/*
+ * =========================================================================
+ * history_utils.h: Header do histórico de quadros exibidos (desfazer/refazer)
+ * =========================================================================
+ *
+ * Guarda no host os quadros exibidos após cada zoom global, com o nível
+ * de cada um, para desfazer e refazer sem rodar o coprocessador: zoom-in
+ * seguido de zoom-out não é uma identidade (Decimation não inverte
+ * NearestNeighbor), mas o quadro guardado é o exato anterior.
+ *
+ * Cada quadro é comprimido: as linhas viram diferenças da linha de cima
+ * (linhas repetidas pelo zoom e gradientes verticais ficam zeradas) e o
+ * resultado é codificado em carreiras (PackBits). Os quadros mais antigos
+ * são descartados quando o histórico passa do orçamento de memória.
+ *
+ */
+
+#ifndef HISTORY_UTILS_H
+#define HISTORY_UTILS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* ===================================================================
+ * Constantes
+ * =================================================================== */
+#define HISTORY_MAX_ENTRIES   32
+#define HISTORY_BUDGET_BYTES  (512 * 1024)   // Soma dos quadros comprimidos
+
+/* ===================================================================
+ * Estruturas de Dados
+ * =================================================================== */
+
+/**
+ * @brief Um quadro comprimido do histórico
+ */
+typedef struct {
+    uint8_t *data;
+    int size;                        // Bytes comprimidos
+    int zoom_level;                  // Nível de zoom global do quadro
+} HistoryEntry;
+
+/**
+ * @brief Histórico linear: entradas [0, count), atual em pos
+ */
+typedef struct {
+    HistoryEntry entries[HISTORY_MAX_ENTRIES];
+    int count;
+    int pos;                         // Entrada exibida (-1 se vazio)
+    size_t bytes;                    // Soma de entries[].size
+    size_t budget;
+    long dropped;                    // Entradas descartadas pelo orçamento
+} FrameHistory;
+
+/* ===================================================================
+ * Protótipos das Funções
+ * =================================================================== */
+
+/**
+ * @brief Inicializa um histórico vazio
+ * @param budget Limite de bytes comprimidos (0 = HISTORY_BUDGET_BYTES)
+ */
+void history_init(FrameHistory *hist, size_t budget);
+
+/**
+ * @brief Libera todas as entradas (o histórico fica vazio)
+ */
+void history_clear(FrameHistory *hist);
+
+/**
+ * @brief Registra o quadro exibido após a entrada atual
+ *
+ * As entradas à frente (refazer) são descartadas. Um quadro idêntico ao
+ * atual com o mesmo nível não gera entrada nova.
+ * @param frame Quadro IMG_WIDTH x IMG_HEIGHT
+ * @return 0 em caso de sucesso, -1 se faltou memória
+ */
+int history_push(FrameHistory *hist, const uint8_t *frame, int zoom_level);
+
+/**
+ * @brief Volta (step = -1) ou avança (step = +1) uma entrada
+ * @param frame_out Recebe o quadro descomprimido
+ * @param zoom_level_out Recebe o nível do quadro
+ * @return 0 em caso de sucesso, -1 se não há entrada nessa direção
+ */
+int history_step(FrameHistory *hist, int step, uint8_t *frame_out, int *zoom_level_out);
+
+/**
+ * @brief Imprime as entradas, a posição atual e a taxa de compressão
+ */
+void history_dump(const FrameHistory *hist);
+
+#endif /* HISTORY_UTILS_H */
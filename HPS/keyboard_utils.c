@@ -0,0 +1,169 @@
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/ioctl.h>
+#include <linux/input.h>
+#include "mouse_utils.h"
+#include "keyboard_utils.h"
+
+// Tamanho máximo do buffer de caminho/nome
+#define MAX_PATH_LEN 256
+
+// Valores de EV_KEY
+#define KEY_RELEASED 0
+#define KEY_PRESSED  1
+#define KEY_REPEATED 2
+
+// Layout US, códigos KEY_ESC (1) a KEY_SPACE (57); 0 = sem caractere
+#define KEYMAP_SIZE 58
+
+static const char keymap[KEYMAP_SIZE] =
+    "\0\033" "1234567890" "-=\b\t" "qwertyuiop" "[]\n\0"
+    "asdfghjkl" ";'`\0" "\\zxcvbnm" ",./\0" "*\0 ";
+
+static const char keymap_shift[KEYMAP_SIZE] =
+    "\0\033" "!@#$%^&*()" "_+\b\t" "QWERTYUIOP" "{}\n\0"
+    "ASDFGHJKL" ":\"~\0" "|ZXCVBNM" "<>?\0" "*\0 ";
+
+
+/*
+ * --- FUNÇÕES INTERNAS ---
+ */
+
+// Caractere de uma tecla, ou 0 se ela não produz texto
+static char key_to_char(int code, int shift) {
+    if (code >= 0 && code < KEYMAP_SIZE) {
+        return shift ? keymap_shift[code] : keymap[code];
+    }
+
+    // Teclado numérico (Num Lock ligado)
+    switch (code) {
+        case KEY_KP0: return '0';
+        case KEY_KP1: return '1';
+        case KEY_KP2: return '2';
+        case KEY_KP3: return '3';
+        case KEY_KP4: return '4';
+        case KEY_KP5: return '5';
+        case KEY_KP6: return '6';
+        case KEY_KP7: return '7';
+        case KEY_KP8: return '8';
+        case KEY_KP9: return '9';
+        case KEY_KPPLUS: return '+';
+        case KEY_KPMINUS: return '-';
+        case KEY_KPENTER: return '\n';
+        default: return 0;
+    }
+}
+
+
+/*
+ * --- DETECÇÃO ---
+ */
+
+int is_keyboard(int fd) {
+    unsigned long evbit[NBITS(EV_MAX)];
+    unsigned long keybit[NBITS(KEY_MAX)];
+
+    memset(evbit, 0, sizeof(evbit));
+    memset(keybit, 0, sizeof(keybit));
+    if (ioctl(fd, EVIOCGBIT(0, sizeof(evbit)), evbit) < 0) return 0;
+    if (ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(keybit)), keybit) < 0) return 0;
+
+    // Mouses e touchpads também têm EV_KEY; um teclado tem letras e nenhum eixo relativo
+    return !test_bit(EV_REL, evbit) &&
+           test_bit(KEY_A, keybit) && test_bit(KEY_Z, keybit) && test_bit(KEY_ENTER, keybit);
+}
+
+int find_and_open_keyboard(char *device_path_out, char *name_out) {
+    struct dirent **namelist;
+    int keyboard_fd = -1;
+
+    int n = scandir("/dev/input", &namelist, NULL, alphasort);
+    if (n < 0) {
+        return -1;
+    }
+
+    for (int i = 0; i < n; i++) {
+        if (keyboard_fd < 0 && strncmp(namelist[i]->d_name, "event", 5) == 0) {
+            char filename[MAX_PATH_LEN];
+            snprintf(filename, MAX_PATH_LEN, "/dev/input/%.240s", namelist[i]->d_name);
+
+            int fd = open(filename, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+            if (fd >= 0) {
+                if (is_keyboard(fd)) {
+                    char name[MAX_PATH_LEN] = "Desconhecido";
+                    ioctl(fd, EVIOCGNAME(sizeof(name)), name);
+                    strncpy(device_path_out, filename, MAX_PATH_LEN);
+                    strncpy(name_out, name, MAX_PATH_LEN);
+                    keyboard_fd = fd;
+                } else {
+                    close(fd);
+                }
+            }
+        }
+        free(namelist[i]);
+    }
+    free(namelist);
+
+    return keyboard_fd;
+}
+
+
+/*
+ * --- LEITURA ---
+ */
+
+void keyboard_reader_init(KeyboardReader *reader, int fd) {
+    int clock = CLOCK_MONOTONIC;
+
+    memset(reader, 0, sizeof(*reader));
+    reader->fd = fd;
+
+    // Carimbos no relógio monotônico (medição de latência); falha não é grave
+    ioctl(fd, EVIOCSCLOCKID, &clock);
+}
+
+int keyboard_reader_poll(KeyboardReader *reader, char *key_out) {
+    while (1) {
+        // Buffer vazio: um único read() traz todos os eventos já disponíveis
+        if (reader->pos >= reader->count) {
+            ssize_t bytes_read = read(reader->fd, reader->buffer, sizeof(reader->buffer));
+            if (bytes_read < 0 && (errno == EAGAIN || errno == EINTR)) {
+                return 0;
+            }
+            if (bytes_read <= 0) {
+                return -1;
+            }
+            reader->count = (int)(bytes_read / sizeof(struct input_event));
+            reader->pos = 0;
+            continue;
+        }
+
+        const struct input_event *ev = &reader->buffer[reader->pos++];
+        if (ev->type != EV_KEY) continue;
+
+        if (ev->code == KEY_LEFTSHIFT || ev->code == KEY_RIGHTSHIFT) {
+            reader->shift = (ev->value != KEY_RELEASED);
+            continue;
+        }
+        if (ev->value == KEY_RELEASED) continue;
+
+        char key = key_to_char(ev->code, reader->shift);
+        if (key == 0) continue;
+
+        if (ev->value == KEY_REPEATED) reader->repeats++;
+        else reader->presses++;
+
+        reader->time = ev->time;
+        *key_out = key;
+        return 1;
+    }
+}
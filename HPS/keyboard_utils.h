@@ -0,0 +1,80 @@
+/*
+ * =========================================================================
+ * keyboard_utils.h: Header de utilitários do teclado (evdev)
+ * =========================================================================
+ *
+ * Lê o teclado diretamente do seu nó em /dev/input, sem passar pelo
+ * terminal. Cada tecla pressionada (e cada repetição automática do
+ * kernel, enquanto a tecla é mantida) vira um caractere no layout US.
+ *
+ * Só faz sentido quando o programa roda no console local: por SSH ou
+ * pela serial as teclas não passam pelo teclado USB da placa, e o
+ * terminal em modo raw é usado no lugar.
+ *
+ */
+
+#ifndef KEYBOARD_UTILS_H
+#define KEYBOARD_UTILS_H
+
+#include <linux/input.h>
+#include <stdint.h>
+
+/* ===================================================================
+ * Constantes
+ * =================================================================== */
+#define KEYBOARD_BATCH_EVENTS 64     // Eventos drenados por read()
+
+/* ===================================================================
+ * Estruturas de Dados
+ * =================================================================== */
+
+/**
+ * @brief Leitor em lote do teclado
+ */
+typedef struct {
+    int fd;
+    struct input_event buffer[KEYBOARD_BATCH_EVENTS];
+    int count;              // Eventos válidos em buffer
+    int pos;                // Próximo evento a processar
+    int shift;              // Shift esquerdo/direito mantido
+    struct timeval time;    // Carimbo no kernel da última tecla entregue
+
+    /* Estatísticas */
+    long presses;           // Teclas pressionadas
+    long repeats;           // Repetições automáticas
+} KeyboardReader;
+
+/* ===================================================================
+ * Protótipos das Funções
+ * =================================================================== */
+
+/**
+ * @brief Verifica se o dispositivo associado ao fd é um teclado
+ * @return 1 se for teclado (letras e Enter, sem eixo relativo), 0 caso contrário
+ */
+int is_keyboard(int fd);
+
+/**
+ * @brief Encontra e abre (sem bloqueio) o primeiro teclado em /dev/input
+ * @param device_path_out Buffer de saída para o caminho do dispositivo (size >= 256)
+ * @param name_out Buffer de saída para o nome do dispositivo (size >= 256)
+ * @return File descriptor do teclado, ou -1 se nenhum
+ */
+int find_and_open_keyboard(char *device_path_out, char *name_out);
+
+/**
+ * @brief Inicializa o leitor sobre um teclado já aberto com O_NONBLOCK
+ */
+void keyboard_reader_init(KeyboardReader *reader, int fd);
+
+/**
+ * @brief Próxima tecla disponível (não bloqueia)
+ *
+ * Pressionamentos e repetições geram caracteres; soltar não gera nada.
+ * Teclas sem caractere (setas, Ctrl, F1...) são ignoradas.
+ * @param key_out Caractere da tecla (ESC = 27, Enter = '\n')
+ * @return 1 se uma tecla foi entregue, 0 se nenhuma pronta, -1 para erro (ex.: desconectado)
+ */
+int keyboard_reader_poll(KeyboardReader *reader, char *key_out);
+
+#endif /* KEYBOARD_UTILS_H */
@@ -0,0 +1,191 @@
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+#include "latency_utils.h"
+
+/**
+ * @brief Histograma de uma etapa (microssegundos)
+ */
+typedef struct {
+    long count;
+    int64_t sum_us;
+    int64_t max_us;
+    long buckets[LAT_BUCKETS];
+} LatHistogram;
+
+static const char *stage_names[LAT_STAGES] = {
+    "fila", "calculo", "envio", "espera", "total"
+};
+
+static LatHistogram histograms[LAT_STAGES];
+
+/* Traço aberto */
+static int trace_active = 0;
+static int64_t trace_input_ns;               // Evento (relógio monotônico)
+static int64_t trace_start_ns;               // Início do tratamento
+static int64_t stage_ns[LAT_STAGES];         // Tempo acumulado por etapa
+static int64_t stage_since_ns[LAT_STAGES];   // Entrada na etapa (profundidade > 0)
+static int stage_depth[LAT_STAGES];
+
+
+/*
+ * --- FUNÇÕES INTERNAS ---
+ */
+
+static int64_t now_ns(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void record(int stage, int64_t ns) {
+    LatHistogram *h = &histograms[stage];
+    int64_t us = (ns < 0) ? 0 : ns / 1000;
+
+    int bucket = 0;
+    while (bucket < LAT_BUCKETS - 1 && us >= ((int64_t)2 << bucket)) {
+        bucket++;
+    }
+
+    h->count++;
+    h->sum_us += us;
+    if (us > h->max_us) h->max_us = us;
+    h->buckets[bucket]++;
+}
+
+// Percentil aproximado: limite superior da faixa que o contém
+static int64_t percentile_us(const LatHistogram *h, int pct) {
+    long target = (h->count * pct + 99) / 100;
+    long seen = 0;
+
+    for (int bucket = 0; bucket < LAT_BUCKETS; bucket++) {
+        seen += h->buckets[bucket];
+        if (seen >= target) {
+            int64_t upper = (int64_t)2 << bucket;
+            return (upper < h->max_us) ? upper : h->max_us;
+        }
+    }
+    return h->max_us;
+}
+
+
+/*
+ * --- TRAÇOS ---
+ */
+
+void lat_begin(const struct timeval *input_time) {
+    int64_t mono = now_ns(CLOCK_MONOTONIC);
+
+    trace_active = 1;
+    trace_start_ns = mono;
+    trace_input_ns = mono;
+    memset(stage_ns, 0, sizeof(stage_ns));
+    memset(stage_depth, 0, sizeof(stage_depth));
+
+    if (input_time == NULL) {
+        return;
+    }
+
+    // O evdev carimba em CLOCK_REALTIME, a menos que EVIOCSCLOCKID tenha mudado o relógio
+    int64_t event = (int64_t)input_time->tv_sec * 1000000000LL + (int64_t)input_time->tv_usec * 1000;
+    int64_t age_mono = mono - event;
+    int64_t age_real = now_ns(CLOCK_REALTIME) - event;
+    int64_t abs_mono = (age_mono < 0) ? -age_mono : age_mono;
+    int64_t abs_real = (age_real < 0) ? -age_real : age_real;
+    int64_t age = (abs_mono <= abs_real) ? age_mono : age_real;
+
+    trace_input_ns = mono - ((age > 0) ? age : 0);
+}
+
+void lat_cancel(void) {
+    trace_active = 0;
+}
+
+void lat_stage_enter(int stage) {
+    if (!trace_active) return;
+
+    if (stage_depth[stage]++ == 0) {
+        stage_since_ns[stage] = now_ns(CLOCK_MONOTONIC);
+    }
+}
+
+void lat_stage_leave(int stage) {
+    if (!trace_active || stage_depth[stage] == 0) return;
+
+    if (--stage_depth[stage] == 0) {
+        stage_ns[stage] += now_ns(CLOCK_MONOTONIC) - stage_since_ns[stage];
+    }
+}
+
+void lat_refresh(void) {
+    if (!trace_active) return;
+
+    int64_t end = now_ns(CLOCK_MONOTONIC);
+    int64_t total = end - trace_input_ns;
+    int64_t queue = trace_start_ns - trace_input_ns;
+    int64_t compute = total - queue - stage_ns[LAT_STAGE_UPLOAD] - stage_ns[LAT_STAGE_WAIT];
+
+    record(LAT_STAGE_QUEUE, queue);
+    record(LAT_STAGE_COMPUTE, compute);
+    record(LAT_STAGE_UPLOAD, stage_ns[LAT_STAGE_UPLOAD]);
+    record(LAT_STAGE_WAIT, stage_ns[LAT_STAGE_WAIT]);
+    record(LAT_STAGE_TOTAL, total);
+    trace_active = 0;
+}
+
+
+/*
+ * --- RELATÓRIO ---
+ */
+
+void lat_dump(void) {
+    const LatHistogram *total = &histograms[LAT_STAGE_TOTAL];
+
+    printf("\n=== LATENCIA ENTRADA -> TELA (%ld atualizacoes) ===\n", total->count);
+    if (total->count == 0) {
+        printf("Nenhuma atualizacao medida ainda.\n");
+        return;
+    }
+
+    printf("%-8s %10s %10s %10s %10s\n", "Etapa", "media(us)", "p50(us)", "p99(us)", "max(us)");
+    for (int stage = 0; stage < LAT_STAGES; stage++) {
+        const LatHistogram *h = &histograms[stage];
+        printf("%-8s %10lld %10lld %10lld %10lld\n", stage_names[stage],
+               (long long)(h->sum_us / h->count),
+               (long long)percentile_us(h, 50),
+               (long long)percentile_us(h, 99),
+               (long long)h->max_us);
+    }
+
+    for (int stage = 0; stage < LAT_STAGES; stage++) {
+        const LatHistogram *h = &histograms[stage];
+        printf("\n[%s]\n", stage_names[stage]);
+
+        long peak = 1;
+        for (int bucket = 0; bucket < LAT_BUCKETS; bucket++) {
+            if (h->buckets[bucket] > peak) peak = h->buckets[bucket];
+        }
+
+        for (int bucket = 0; bucket < LAT_BUCKETS; bucket++) {
+            if (h->buckets[bucket] == 0) continue;
+
+            char bar[41];
+            int len = (int)(h->buckets[bucket] * 40 / peak);
+            if (len == 0) len = 1;
+            memset(bar, '#', len);
+            bar[len] = '\0';
+
+            printf("  %8ld us+ %6ld %s\n", (bucket == 0) ? 0L : (1L << bucket),
+                   h->buckets[bucket], bar);
+        }
+    }
+}
+
+void lat_reset(void) {
+    memset(histograms, 0, sizeof(histograms));
+    trace_active = 0;
+}
@@ -0,0 +1,84 @@
+/*
+ * =========================================================================
+ * latency_utils.h: Header da medição de latência entrada -> tela
+ * =========================================================================
+ *
+ * Mede o tempo entre um evento de entrada (clique, movimento, tecla) e o
+ * ASM_Refresh que coloca na tela a atualização resultante. O início é o
+ * carimbo de tempo do próprio evento no kernel (input_event.time), não o
+ * momento em que o programa o leu, então o tempo de fila também entra.
+ *
+ * Cada medição (um "traço") é dividida em etapas:
+ *   fila     - do evento no kernel até o programa começar a tratá-lo
+ *   envio    - escritas na Memória Principal (vram_utils, overlay_utils)
+ *   espera   - espera do coprocessador e atrasos fixos do protocolo
+ *   cálculo  - o restante (CPU do HPS, leituras da Memória Secundária)
+ *
+ * Os traços alimentam histogramas em escala logarítmica por etapa,
+ * impressos sob demanda.
+ *
+ */
+
+#ifndef LATENCY_UTILS_H
+#define LATENCY_UTILS_H
+
+#include <sys/time.h>
+
+/* ===================================================================
+ * Constantes
+ * =================================================================== */
+
+/* Etapas */
+#define LAT_STAGE_QUEUE   0
+#define LAT_STAGE_COMPUTE 1
+#define LAT_STAGE_UPLOAD  2
+#define LAT_STAGE_WAIT    3
+#define LAT_STAGE_TOTAL   4
+#define LAT_STAGES        5
+
+#define LAT_BUCKETS 24               // Faixa k: [2^k, 2^(k+1)) us; a última vai até ~8 s e além
+
+/* ===================================================================
+ * Protótipos das Funções
+ * =================================================================== */
+
+/**
+ * @brief Inicia um traço para a atualização causada por um evento
+ *
+ * Um traço anterior ainda aberto (evento que não gerou atualização) é
+ * descartado.
+ * @param input_time Carimbo do evento (relógio monotônico ou de tempo
+ *                   real, detectado), ou NULL se não houver (sem fila)
+ */
+void lat_begin(const struct timeval *input_time);
+
+/**
+ * @brief Descarta o traço aberto, se houver
+ */
+void lat_cancel(void);
+
+/**
+ * @brief Marca a entrada/saída de uma etapa (LAT_STAGE_UPLOAD ou LAT_STAGE_WAIT)
+ *
+ * Chamadas aninhadas da mesma etapa contam uma vez. Sem traço aberto
+ * não fazem nada.
+ */
+void lat_stage_enter(int stage);
+void lat_stage_leave(int stage);
+
+/**
+ * @brief Chamada logo após cada ASM_Refresh: fecha e registra o traço aberto
+ */
+void lat_refresh(void);
+
+/**
+ * @brief Imprime os histogramas de todas as etapas
+ */
+void lat_dump(void);
+
+/**
+ * @brief Zera os histogramas
+ */
+void lat_reset(void);
+
+#endif /* LATENCY_UTILS_H */
@@ -20,6 +20,12 @@
     FPGA_BRIDGE_BASE: .word 0xFF200000
     FPGA_BRIDGE_SPAN: .word 0x00001000 @ 4 KB
 
+    @ Driver timing (TIMING_* offsets), set at startup by ASM_Set_Timing
+    .align 2
+    drv_timing:
+        .word TIMEOUT_LIMIT    @ flag polls before ERR_TIMEOUT
+        .word DELAY_COUNT      @ settle loop iterations after each pixel
+
     @ --- PIOs OFFSETS (Qsys) ---
     .equ PIO_INSTR_OFS,      0x00
     .equ PIO_ENABLE_OFS,     0x10
@@ -57,11 +63,14 @@
     .equ IMAGE_HEIGHT,     240   @ pixels
     .equ IMAGE_SIZE,       76800 @ 76800 Bytes
 
-    @ --- SYNCHRONIZATION PARAMETERS ---
+    @ --- SYNCHRONIZATION PARAMETERS (defaults until ASM_Set_Timing) ---
 
     .equ TIMEOUT_LIMIT,    0x3500
     .equ DELAY_COUNT,      0x1000
 
+    .equ TIMING_POLLS,     0       @ drv_timing offsets
+    .equ TIMING_SETTLE,    4
+
     @ --- RETURN CODES ---
 
     .equ ERR_SUCCESS,           0   @ Operation completed successfully
@@ -69,12 +78,25 @@
     .equ ERR_TIMEOUT,          -2   @ Operation timed out (no response)
     .equ ERR_HARDWARE,         -3   @ Hardware error (FLAG_ERROR set)
 
+    @ --- DRIVER STATISTICS (word offsets in drv_stats, see DriverStats in api.h) ---
+
+    .equ STAT_STORES,       0       @ ASM_Store calls with a valid address
+    .equ STAT_LOADS,        4       @ ASM_Load calls with a valid address
+    .equ STAT_TIMEOUTS,     8       @ No FLAG_DONE even after the retry
+    .equ STAT_HW_ERRORS,   12       @ FLAG_ERROR set with FLAG_DONE
+    .equ STAT_INVALID,     16       @ Address out of bounds
+    .equ STAT_RETRIES,     20       @ Packets re-pulsed after a first timeout
+    .equ STAT_WORST_SPIN,  24       @ Most flag polls before FLAG_DONE
+    .equ STAT_TOTAL_SPIN,  28       @ Flag polls of all completed operations
+    .equ DRV_STATS_WORDS,   8
+
 @ ===================================================================
 @ BSS SECTION (Global Variables)
 @ ===================================================================
 .section .bss
     .lcomm fd_mem, 4           @ File Descriptor for /dev/mem
     .lcomm lw_bridge_ptr, 4    @ virtual pointer for LW Bridge
+    .lcomm drv_stats, 32, 4    @ DRV_STATS_WORDS counters
 
 @ ===================================================================
 @ Text Section
@@ -85,6 +107,42 @@
 @ SUB-ROUTINES "PRIVATE" (Non-visible to C)
 @ ===================================================================        
 
+@ STAT_INC: increments a drv_stats counter
+@ Clobbers R2 and R3
+
+.macro STAT_INC ofs
+    LDR     R3, =drv_stats
+    LDR     R2, [R3, #\ofs]
+    ADD     R2, R2, #1
+    STR     R2, [R3, #\ofs]
+.endm
+
+@ _stat_spin: adds the polls of a completed operation and keeps the worst
+@ Receives: R5 = polls left (counts down from the TIMING_POLLS limit)
+
+_stat_spin:
+    PUSH    {R1, R2, R3}
+    LDR     R3, =drv_timing
+    LDR     R1, [R3, #TIMING_POLLS]
+    SUB     R2, R1, R5              @ R2 = polls used
+    LDR     R3, =drv_stats
+    LDR     R1, [R3, #STAT_TOTAL_SPIN]
+    ADD     R1, R1, R2
+    STR     R1, [R3, #STAT_TOTAL_SPIN]
+    LDR     R1, [R3, #STAT_WORST_SPIN]
+    CMP     R2, R1
+    STRHI   R2, [R3, #STAT_WORST_SPIN]
+    POP     {R1, R2, R3}
+    BX      LR
+
+@ LOAD_TIMING: R5 = a drv_timing word
+@ Polling and delay loops use SUBS + BHI, so a zero count ends after one pass
+
+.macro LOAD_TIMING ofs
+    LDR     R5, =drv_timing
+    LDR     R5, [R5, #\ofs]
+.endm
+
 @ _pulse_enable_safe: pulse the ENABLE bit
 @ Doesn't affects other flags
 
@@ -217,6 +275,8 @@ API_close:
 @ --- ASM_Store (R0=address, R1=pixel_data, R2=memory selection) ---
 @ BLOCKING FUNCTION - !
 @ Uses _pulse_enable_internal and _wait_for_done_internal
+@ A first timeout re-pulses the packet once (STAT_RETRIES)
+@ Returns ERR_SUCCESS, ERR_INVALID_ADDRESS, ERR_TIMEOUT or ERR_HARDWARE
 
 .global ASM_Store
 .type ASM_Store, %function
@@ -249,9 +309,13 @@ ASM_Store:
     STR     R5, [R4, #PIO_INSTR_OFS]
     DMB     sy
 
+    STAT_INC STAT_STORES
+    MOV     R6, #0              @ retry not used yet
+
+.WR_ISSUE:
     BL      _pulse_enable_safe
 
-    MOV     R5, #TIMEOUT_LIMIT
+    LOAD_TIMING TIMING_POLLS
 
 .WR_POLLING:
     @ polling for DONE flag
@@ -259,29 +323,42 @@ ASM_Store:
     TST     R2, #FLAG_DONE_MASK
     BNE     .WR_CHECK_ERROR
     SUBS    R5, R5, #1
-    BNE     .WR_POLLING
-    MOV     R0, #0
+    BHI     .WR_POLLING
+
+    @ timeout: the packet is still in PIO_INSTR, pulse it once more
+    CMP     R6, #0
+    BNE     .WR_TIMEOUT
+    MOV     R6, #1
+    STAT_INC STAT_RETRIES
+    B       .WR_ISSUE
+
+.WR_TIMEOUT:
+    STAT_INC STAT_TIMEOUTS
+    MOV     R0, #ERR_TIMEOUT
     B       .WR_EXIT
 
 .WR_CHECK_ERROR:
     @ check for ERROR flag
     TST     R2, #FLAG_ERROR_MASK
     BNE     .WR_HW_ERROR
+    BL      _stat_spin
     MOV     R0, #0
 
-    MOV     R5, #DELAY_COUNT
+    LOAD_TIMING TIMING_SETTLE
 
 .WR_DELAY:
     @ sync delay
     SUBS    R5, R5, #1
-    BNE     .WR_DELAY
+    BHI     .WR_DELAY
     B       .WR_EXIT
 
 .WR_INVALID_ADDRESS:
+    STAT_INC STAT_INVALID
     MOV     R0, #-1
     B       .WR_EXIT
 
 .WR_HW_ERROR:
+    STAT_INC STAT_HW_ERRORS
     MOV     R0, #-3
 
 .WR_EXIT:
@@ -294,6 +371,8 @@ ASM_Store:
 @ --- ASM_Load (R0=address, R1=memory selection) ---
 @ BLOCKING FUNCTION - !
 @ Uses _pulse_enable and _wait_for_done
+@ A first timeout re-pulses the packet once (STAT_RETRIES)
+@ Returns the pixel, or ERR_INVALID_ADDRESS, ERR_TIMEOUT or ERR_HARDWARE
 
 ASM_Load:
     PUSH    {R4-R6, LR}
@@ -319,9 +398,13 @@ ASM_Load:
 
     DMB     sy
 
+    STAT_INC STAT_LOADS
+    MOV     R6, #0              @ retry not used yet
+
+.RD_ISSUE:
     BL     _pulse_enable_safe
 
-    MOV     R5, #TIMEOUT_LIMIT
+    LOAD_TIMING TIMING_POLLS
 
 .RD_POLLING:
     LDR     R2, [R4, #PIO_FLAGS_OFS]
@@ -329,30 +412,42 @@ ASM_Load:
     BNE     .RD_SUCCESS
 
     SUBS    R5, R5, #1
-    BNE     .RD_POLLING
-
-    MOV     R0, #-2
+    BHI     .RD_POLLING
+
+    @ timeout: the packet is still in PIO_INSTR, pulse it once more
+    CMP     R6, #0
+    BNE     .RD_TIMEOUT
+    MOV     R6, #1
+    STAT_INC STAT_RETRIES
+    B       .RD_ISSUE
+
+.RD_TIMEOUT:
+    STAT_INC STAT_TIMEOUTS
+    MOV     R0, #ERR_TIMEOUT
     B       .RD_EXIT
 
 .RD_SUCCESS:
     TST    R2, #FLAG_ERROR_MASK
     BNE     .RD_HW_ERROR
 
+    BL      _stat_spin
     LDR     R0, [R4, #PIO_DATAOUT_OFS]
 
-    MOV     R5, #DELAY_COUNT
+    LOAD_TIMING TIMING_SETTLE
 
 .RD_DELAY:
     SUBS    R5, R5, #1
-    BNE     .RD_DELAY
+    BHI     .RD_DELAY
     
     B       .RD_EXIT
 
 .RD_INVALID_ADDRESS:
+    STAT_INC STAT_INVALID
     MOV     R0, #-1
     B       .RD_EXIT
 
 .RD_HW_ERROR:
+    STAT_INC STAT_HW_ERRORS
     MOV     R0, #-3
 
 .RD_EXIT:
@@ -390,6 +485,60 @@ ASM_Pulse_Enable:
     POP {PC}
 .size ASM_Pulse_Enable, .-ASM_Pulse_Enable
 
+@ --- ASM_Get_Stats (R0 = DriverStats*) ---
+@ Copies the driver counters (DRV_STATS_WORDS words)
+
+.global ASM_Get_Stats
+.type ASM_Get_Stats, %function
+
+ASM_Get_Stats:
+    PUSH    {R1-R3, LR}
+    LDR     R1, =drv_stats
+    MOV     R2, #DRV_STATS_WORDS
+
+.GS_COPY:
+    LDR     R3, [R1], #4
+    STR     R3, [R0], #4
+    SUBS    R2, R2, #1
+    BNE     .GS_COPY
+
+    POP     {R1-R3, PC}
+.size ASM_Get_Stats, .-ASM_Get_Stats
+
+@ --- ASM_Set_Timing (R0 = timeout polls, R1 = settle loops) ---
+@ Replaces TIMEOUT_LIMIT and DELAY_COUNT (startup calibration)
+
+.global ASM_Set_Timing
+.type ASM_Set_Timing, %function
+
+ASM_Set_Timing:
+    PUSH    {R2, LR}
+    LDR     R2, =drv_timing
+    STR     R0, [R2, #TIMING_POLLS]
+    STR     R1, [R2, #TIMING_SETTLE]
+    POP     {R2, PC}
+.size ASM_Set_Timing, .-ASM_Set_Timing
+
+@ --- ASM_Clear_Stats (void) ---
+@ Zeroes the driver counters
+
+.global ASM_Clear_Stats
+.type ASM_Clear_Stats, %function
+
+ASM_Clear_Stats:
+    PUSH    {R1-R3, LR}
+    LDR     R1, =drv_stats
+    MOV     R2, #DRV_STATS_WORDS
+    MOV     R3, #0
+
+.CS_CLEAR:
+    STR     R3, [R1], #4
+    SUBS    R2, R2, #1
+    BNE     .CS_CLEAR
+
+    POP     {R1-R3, PC}
+.size ASM_Clear_Stats, .-ASM_Clear_Stats
+
 @ ===================================================================
 @ ALGORITHM BLOCKS - Non-blocking functions
 @ ONLY DEFINE THE INSTRUCTIONS - PULSE THE ENABLE WITH ASM_Pulse_Enable TO RUN
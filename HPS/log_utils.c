@@ -0,0 +1,277 @@
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "log_utils.h"
+
+/**
+ * @brief Uma mensagem formatada
+ */
+typedef struct {
+    int64_t ns;
+    int level;
+    char text[LOG_MSG_MAX];
+} LogRecord;
+
+/**
+ * @brief Buffer de uma thread: ela escreve head, a thread de escrita escreve tail
+ */
+typedef struct {
+    LogRecord slots[LOG_RING_SLOTS];
+    uint32_t head;
+    uint32_t tail;
+} LogRing;
+
+static const char *level_names[] = { "ERRO", "AVISO", "INFO", "DEBUG", "TRACE" };
+
+static LogRing rings[LOG_MAX_THREADS];
+static int ring_count;                       // Buffers já entregues a threads
+static __thread LogRing *my_ring;
+static __thread int my_ring_missing;         // Sem buffer livre: escrita direta
+
+/* Thread de escrita */
+static pthread_t writer;
+static pthread_mutex_t wake_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wake_cond = PTHREAD_COND_INITIALIZER;
+static int running;
+static FILE *out_file;                       // NULL = stdout
+static int64_t start_ns;
+
+static int runtime_level = LOG_LEVEL_MAX;
+
+/* Estatísticas (atômicas) */
+static uint64_t pushed, written, suppressed, dropped;
+
+
+/*
+ * --- FUNÇÕES INTERNAS ---
+ */
+
+static int64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static LogRing *thread_ring(void) {
+    if (!my_ring && !my_ring_missing) {
+        int index = __atomic_fetch_add(&ring_count, 1, __ATOMIC_RELAXED);
+        if (index < LOG_MAX_THREADS) {
+            my_ring = &rings[index];
+        } else {
+            my_ring_missing = 1;
+        }
+    }
+    return my_ring;
+}
+
+// Limite do ponto de registro: 1 se a mensagem passa
+static int site_allows(LogSite *site, int64_t now) {
+    if (site->interval_ms > 0) {
+        if (site->window_start_ns != 0 && now - site->window_start_ns < site->interval_ms * 1000000LL) {
+            return 0;
+        }
+        site->window_start_ns = now;
+        return 1;
+    }
+
+    if (now - site->window_start_ns >= LOG_SITE_WINDOW_MS * 1000000LL) {
+        site->window_start_ns = now;
+        site->in_window = 0;
+    }
+    return site->in_window++ < LOG_SITE_BURST;
+}
+
+static void emit(const LogRecord *rec) {
+    if (!out_file) {
+        fputs(rec->text, stdout);
+        return;
+    }
+
+    // Em arquivo: uma linha por mensagem, com o tempo e o nível
+    int len = (int)strcspn(rec->text, "\r\n");
+    fprintf(out_file, "%10.3f %-5s %.*s\n", (rec->ns - start_ns) / 1e9,
+            level_names[rec->level], len, rec->text);
+}
+
+// Esvazia todos os buffers (só a thread de escrita, ou sem ela rodando)
+static void drain(void) {
+    int count = __atomic_load_n(&ring_count, __ATOMIC_ACQUIRE);
+    uint64_t done = 0;
+
+    if (count > LOG_MAX_THREADS) {
+        count = LOG_MAX_THREADS;
+    }
+    for (int i = 0; i < count; i++) {
+        LogRing *ring = &rings[i];
+        uint32_t tail = ring->tail;
+        uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+        while (tail != head) {
+            emit(&ring->slots[tail & (LOG_RING_SLOTS - 1)]);
+            tail++;
+            done++;
+        }
+        __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+    }
+    fflush(out_file ? out_file : stdout);
+    if (done) {
+        __atomic_fetch_add(&written, done, __ATOMIC_RELEASE);
+    }
+}
+
+static void *writer_main(void *arg) {
+    (void)arg;
+
+    pthread_mutex_lock(&wake_lock);
+    while (__atomic_load_n(&running, __ATOMIC_ACQUIRE)) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += LOG_FLUSH_MS * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait(&wake_cond, &wake_lock, &deadline);
+
+        pthread_mutex_unlock(&wake_lock);
+        drain();
+        pthread_mutex_lock(&wake_lock);
+    }
+    pthread_mutex_unlock(&wake_lock);
+
+    drain();
+    return NULL;
+}
+
+static void wake_writer(void) {
+    pthread_mutex_lock(&wake_lock);
+    pthread_cond_signal(&wake_cond);
+    pthread_mutex_unlock(&wake_lock);
+}
+
+
+/*
+ * --- REGISTRO ---
+ */
+
+int log_init(const char *path, int level) {
+    if (running) {
+        return 0;
+    }
+    log_set_level(level);
+    start_ns = now_ns();
+
+    if (path) {
+        out_file = fopen(path, "w");
+        if (!out_file) {
+            printf("!!! AVISO: nao foi possivel abrir o log %s; usando o terminal.\n", path);
+        }
+    }
+
+    __atomic_store_n(&running, 1, __ATOMIC_RELEASE);
+    if (pthread_create(&writer, NULL, writer_main, NULL) != 0) {
+        __atomic_store_n(&running, 0, __ATOMIC_RELEASE);
+        if (out_file) {
+            fclose(out_file);
+            out_file = NULL;
+        }
+        return -1;
+    }
+    atexit(log_close);
+    return 0;
+}
+
+void log_set_level(int level) {
+    runtime_level = (level > LOG_LEVEL_MAX) ? LOG_LEVEL_MAX : level;
+}
+
+void log_write(LogSite *site, int level, const char *fmt, ...) {
+    if (level > runtime_level) {
+        return;
+    }
+
+    int64_t now = now_ns();
+    if (!site_allows(site, now)) {
+        __atomic_fetch_add(&suppressed, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    va_list args;
+    LogRing *ring = __atomic_load_n(&running, __ATOMIC_ACQUIRE) ? thread_ring() : NULL;
+    if (!ring) {
+        // Sem a thread de escrita (antes de log_init, depois de log_close)
+        va_start(args, fmt);
+        vprintf(fmt, args);
+        va_end(args);
+        fflush(stdout);
+        return;
+    }
+
+    uint32_t head = ring->head;
+    if (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) >= LOG_RING_SLOTS) {
+        __atomic_fetch_add(&dropped, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    LogRecord *rec = &ring->slots[head & (LOG_RING_SLOTS - 1)];
+    rec->ns = now;
+    rec->level = level;
+    va_start(args, fmt);
+    vsnprintf(rec->text, LOG_MSG_MAX, fmt, args);
+    va_end(args);
+
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&pushed, 1, __ATOMIC_RELAXED);
+}
+
+void log_flush(void) {
+    if (!__atomic_load_n(&running, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+
+    uint64_t target = __atomic_load_n(&pushed, __ATOMIC_RELAXED);
+    if (__atomic_load_n(&written, __ATOMIC_ACQUIRE) >= target) {
+        return;
+    }
+    wake_writer();
+    while (__atomic_load_n(&written, __ATOMIC_ACQUIRE) < target) {
+        struct timespec pause = { 0, 200000 };
+        nanosleep(&pause, NULL);
+    }
+}
+
+void log_close(void) {
+    if (!__atomic_load_n(&running, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+    __atomic_store_n(&running, 0, __ATOMIC_RELEASE);
+    wake_writer();
+    pthread_join(writer, NULL);
+
+    if (out_file) {
+        fclose(out_file);
+        out_file = NULL;
+    }
+}
+
+
+/*
+ * --- RELATÓRIO ---
+ */
+
+void log_dump(void) {
+    log_flush();
+    printf("\n=== REGISTRO ===\n");
+    printf("Mensagens: %llu escritas, %llu suprimidas pelo limite, %llu descartadas (buffer cheio)\n",
+           (unsigned long long)__atomic_load_n(&written, __ATOMIC_ACQUIRE),
+           (unsigned long long)__atomic_load_n(&suppressed, __ATOMIC_RELAXED),
+           (unsigned long long)__atomic_load_n(&dropped, __ATOMIC_RELAXED));
+    printf("Nivel: ate %s (compilado ate %s)%s\n", level_names[runtime_level], level_names[LOG_LEVEL_MAX],
+           out_file ? ", em arquivo" : "");
+}
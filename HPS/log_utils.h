@@ -0,0 +1,131 @@
+/*
+ * =========================================================================
+ * log_utils.h: Header do registro assíncrono (logger)
+ * =========================================================================
+ *
+ * printf + fflush nos laços internos (movimento do mouse, linhas de
+ * estado do pan e do zoom, pontos de progresso) seguram o programa na
+ * velocidade do terminal, e num console serial isso basta para travar
+ * a interação. Aqui a mensagem só é formatada: o texto vai para um
+ * buffer circular da própria thread (um produtor e um consumidor, sem
+ * trava) e uma thread de fundo o escreve no stdout ou em um arquivo.
+ *
+ *   - Buffer cheio: a mensagem é descartada e contada, quem registra
+ *     nunca espera
+ *   - Cada ponto de registro tem seu limite: no máximo LOG_SITE_BURST
+ *     mensagens por LOG_SITE_WINDOW_MS (LOG_EVERY dá um intervalo
+ *     mínimo próprio); as suprimidas são contadas (log_dump)
+ *   - Níveis acima de LOG_LEVEL_MAX somem na compilação: com -DNDEBUG
+ *     (build de release) LOG_DEBUG e LOG_TRACE não geram código
+ *
+ * Antes de ler o teclado, log_flush garante que tudo o que foi
+ * registrado já está na tela, na ordem.
+ *
+ */
+
+#ifndef LOG_UTILS_H
+#define LOG_UTILS_H
+
+#include <stdint.h>
+
+/* ===================================================================
+ * Constantes
+ * =================================================================== */
+
+/* Níveis */
+#define LOG_LVL_ERROR 0
+#define LOG_LVL_WARN  1
+#define LOG_LVL_INFO  2
+#define LOG_LVL_DEBUG 3
+#define LOG_LVL_TRACE 4
+
+#ifndef LOG_LEVEL_MAX
+#ifdef NDEBUG
+#define LOG_LEVEL_MAX LOG_LVL_INFO
+#else
+#define LOG_LEVEL_MAX LOG_LVL_DEBUG
+#endif
+#endif
+
+#define LOG_MSG_MAX         160      // Texto de uma mensagem (o resto é cortado)
+#define LOG_RING_SLOTS      256      // Mensagens por thread (potência de 2)
+#define LOG_MAX_THREADS     4
+#define LOG_FLUSH_MS        20       // Período da thread de escrita
+#define LOG_SITE_BURST      50       // Acima do ritmo das linhas de estado (MOUSE_PRINT_INTERVAL_MS)
+#define LOG_SITE_WINDOW_MS  1000
+
+/* ===================================================================
+ * Estruturas de Dados
+ * =================================================================== */
+
+/**
+ * @brief Estado de um ponto de registro (limite de taxa)
+ */
+typedef struct {
+    int interval_ms;                 // > 0: intervalo mínimo (LOG_EVERY); 0: rajada por janela
+    int64_t window_start_ns;
+    int in_window;                   // Mensagens na janela atual
+} LogSite;
+
+/* ===================================================================
+ * Macros de Registro
+ * =================================================================== */
+
+#define LOG_AT_(level, interval, ...)                                        \
+    do {                                                                     \
+        if ((level) <= LOG_LEVEL_MAX) {                                      \
+            static LogSite log_site_ = { (interval), 0, 0 };                 \
+            log_write(&log_site_, (level), __VA_ARGS__);                     \
+        }                                                                    \
+    } while (0)
+
+#define LOG_ERROR(...) LOG_AT_(LOG_LVL_ERROR, 0, __VA_ARGS__)
+#define LOG_WARN(...)  LOG_AT_(LOG_LVL_WARN, 0, __VA_ARGS__)
+#define LOG_INFO(...)  LOG_AT_(LOG_LVL_INFO, 0, __VA_ARGS__)
+#define LOG_DEBUG(...) LOG_AT_(LOG_LVL_DEBUG, 0, __VA_ARGS__)
+#define LOG_TRACE(...) LOG_AT_(LOG_LVL_TRACE, 0, __VA_ARGS__)
+
+/* No máximo uma mensagem a cada interval_ms neste ponto (linhas de estado) */
+#define LOG_EVERY(level, interval_ms, ...) LOG_AT_(level, interval_ms, __VA_ARGS__)
+
+/* ===================================================================
+ * Protótipos das Funções
+ * =================================================================== */
+
+/**
+ * @brief Inicia a thread de escrita (encerrada por atexit)
+ * @param path Arquivo de destino (NULL = stdout; em arquivo, cada linha
+ *             recebe o tempo e o nível)
+ * @param level Nível máximo registrado em tempo de execução
+ * @return 0 em caso de sucesso, -1 em caso de falha (mensagens vão direto
+ *         para o stdout)
+ */
+int log_init(const char *path, int level);
+
+/**
+ * @brief Muda o nível máximo em tempo de execução (até LOG_LEVEL_MAX)
+ */
+void log_set_level(int level);
+
+/**
+ * @brief Registra uma mensagem (use as macros LOG_*)
+ */
+void log_write(LogSite *site, int level, const char *fmt, ...)
+    __attribute__((format(printf, 3, 4)));
+
+/**
+ * @brief Espera a thread de escrita esvaziar todos os buffers
+ */
+void log_flush(void);
+
+/**
+ * @brief Esvazia os buffers, encerra a thread e fecha o arquivo
+ */
+void log_close(void);
+
+/**
+ * @brief Imprime mensagens escritas, suprimidas pelo limite e descartadas
+ */
+void log_dump(void);
+
+#endif /* LOG_UTILS_H */
@@ -5,8 +5,27 @@
  * 
  */
 
+#define _GNU_SOURCE
+
 #include "api.h"
 #include "mouse_utils.h"
+#include "vram_utils.h"
+#include "zoom_utils.h"
+#include "pip_utils.h"
+#include "tile_utils.h"
+#include "event_loop.h"
+#include "overlay_utils.h"
+#include "keyboard_utils.h"
+#include "latency_utils.h"
+#include "session_utils.h"
+#include "command_utils.h"
+#include "residency_utils.h"
+#include "history_utils.h"
+#include "timing_utils.h"
+#include "rt_utils.h"
+#include "metrics_utils.h"
+#include "log_utils.h"
+#include "verify_utils.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
@@ -15,6 +34,10 @@
 #include <string.h>
 #include <errno.h>
 #include <termios.h>
+#include <time.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/time.h>
 
 /* ===================================================================
  * CONSTANTS AND CONFIGURATION
@@ -39,7 +62,35 @@
 /* Maximum zoom levels */
 #define MAX_REGIONAL_ZOOM_LEVELS 3
 
-/* Regional zoom context */
+/* Magnifier lens */
+#define LENS_WIDTH 64
+#define LENS_HEIGHT 48
+#define LENS_BORDER_COLOR 255
+
+/* Continuous zoom steps (in 1/16 units) */
+#define CZOOM_KEY_STEP 1
+#define CZOOM_WHEEL_STEP 2
+
+/* Minimum interval between cursor position prints */
+#define MOUSE_PRINT_INTERVAL_MS 30
+
+/* Coprocessor wait (event loop) */
+#define COPROC_TIMEOUT_MS (TIMEOUT_LOOPS * REFRESH_DELAY_US / 1000)
+#define COPROC_PROGRESS_MS 250
+
+/* Single-key controls: keys read but not yet consumed */
+#define KEY_QUEUE_LEN 64
+
+/* Returned by key_next when wheel ticks are pending (outside the char range) */
+#define KEY_WHEEL 0x100
+
+/* Global zoom driven by the wheel: levels 0 (original) to MAX_ZOOM_IN_LEVEL */
+#define WHEEL_ZOOM_LEVELS (MAX_ZOOM_IN_LEVEL + 1)
+
+/* Batch mode: longest script line and words per step */
+#define BATCH_LINE_LEN 512
+#define BATCH_MAX_WORDS 8
+
 /* Regional zoom context */
 typedef struct {
     int x;                    /* Top-left X coordinate */
@@ -56,12 +107,110 @@ typedef struct {
     
     /* Buffer com a imagem completa de base (preserva zoom global) */
     uint8_t *original_full_image;
+
+    /* Modo pan: janela de origem deslocavel dentro da imagem base */
+    int src_x;                /* Canto X da janela de origem */
+    int src_y;                /* Canto Y da janela de origem */
+    uint8_t *view_buffer;     /* Conteudo exibido na regiao (width*height) */
+
+    /* Quadros em blocos: imagem base e o que esta na Primary Memory */
+    TiledFrame *base_tiles;
+    TiledFrame *screen_tiles;
 } RegionalZoomContext;
 
 
 /* Global mouse file descriptor */
 int mouse_fd_global = -1;
 
+/* Batched reader over mouse_fd_global (shared so buffered events are not lost) */
+MouseReader mouse_reader;
+
+/* Mouse hotplug: /dev/input watcher and the active device */
+MouseHotplug mouse_hotplug = { -1, -1 };
+char mouse_device_path[MAX_PATH_LEN] = "";
+int mouse_source_id = -1;
+
+/* Event loop shared by the menu and the coprocessor waits */
+EventLoop main_loop;
+
+/* Menu input collected by the stdin handler */
+typedef struct {
+    char buf[512];
+    int len;
+    int eof;
+    int busy;                 /* Operation running: input is only queued */
+    int source_id;            /* stdin in the event loop */
+    int paused;               /* Buffer full: stdin not watched until bytes are consumed */
+    struct timeval time;      /* When the last bytes were read (latency start for keys) */
+} MenuInput;
+
+MenuInput menu_input;
+
+/* Single-key session: terminal kept raw, keys from stdin or the console keyboard */
+typedef struct {
+    int active;
+    struct termios saved;     /* Terminal attributes restored at the end */
+    int keyboard_fd;          /* evdev keyboard (-1 = keys come from stdin) */
+    int source_id;
+    KeyboardReader reader;
+    char queue[KEY_QUEUE_LEN];/* Keys read from the keyboard, not yet consumed */
+    struct timeval times[KEY_QUEUE_LEN];  /* Kernel timestamp of each queued key */
+    int count;
+    struct timeval key_time;  /* Timestamp of the last key returned by key_next */
+    long keys;                /* Keys consumed */
+    long superseded;          /* Zoom keys dropped by key_coalesce_zoom */
+    int wheel;                /* Mouse wheel ticks are delivered as KEY_WHEEL */
+    int wheel_ticks;          /* Ticks not yet taken (positive = away from the user) */
+    struct timeval wheel_time;/* Timestamp of the first tick not yet taken */
+    long wheel_bursts;        /* key_take_wheel calls that found ticks */
+} KeySession;
+
+KeySession key_session = { .keyboard_fd = -1, .source_id = -1 };
+
+/* Frames shown by the global zoom, for undo/redo without the coprocessor */
+FrameHistory zoom_history;
+
+/* Metrics server (--metrics, --metrics-tcp) */
+int metrics_enabled = 0;
+int metrics_tcp_port = 0;
+
+/* State of a coprocessor wait */
+typedef struct {
+    int status;               /* EV_COPROC_* (0 while waiting) */
+    struct timespec start;
+    int progress_shown;
+} CoprocWait;
+
+/* Global zoom driven by the mouse wheel */
+typedef struct {
+    uint8_t *frames[WHEEL_ZOOM_LEVELS];  /* Screen of each level already seen (0 = image_data) */
+    int shown;                /* Level on screen */
+    int hw_base;              /* Level of the frame in primary memory */
+    int hw_level;             /* hw_base + NearestNeighbor runs since the last reset */
+    int fpga_runs;
+    int cache_hits;
+    int requests;             /* Target levels served (one per burst) */
+} WheelZoom;
+
+/* Batch mode state (same meaning as the menu variables in main) */
+typedef struct {
+    uint8_t *image_data;
+    int image_sent_to_fpga;
+    int zoom_level;
+    int steps;                /* Steps executed */
+    double total_ms;          /* Sum of the step times */
+} BatchState;
+
+/* Defined in the MOUSE AREA SELECTION section */
+int capture_mouse_area(int *corner1_x, int *corner1_y, int *corner2_x, int *corner2_y,
+                       int show_cursor);
+
+/* Defined in the REGIONAL ZOOM CLEANUP section */
+void regional_zoom_cleanup(RegionalZoomContext *ctx);
+
+/* Defined in the GLOBAL ZOOM HISTORY section */
+void history_record_screen(int zoom_level);
+
 /* ===================================================================
  * BMP FILE STRUCTURES
  * =================================================================== */
@@ -90,265 +239,1126 @@ typedef struct {
 #pragma pack(pop)
 
 /* ===================================================================
- * UTILITY FUNCTIONS
+ * EVENT LOOP
  * =================================================================== */
 
+void on_mouse_ready(EventLoop *loop, int id, uint32_t events, void *user);
+int menu_read_line(char *out, int size);
+int menu_take_line(char *out, int size);
+
 /**
- * @brief Converts RGB color to grayscale using standard luminosity formula
+ * @brief Returns elapsed milliseconds between two timestamps
  */
-uint8_t rgb_to_gray(uint8_t r, uint8_t g, uint8_t b) {
-    return (uint8_t)((299 * r + 587 * g + 114 * b) / 1000);
+double elapsed_ms(const struct timespec *start, const struct timespec *end) {
+    return (end->tv_sec - start->tv_sec) * 1000.0 +
+           (end->tv_nsec - start->tv_nsec) / 1000000.0;
 }
 
 /**
- * @brief Clears input buffer to prevent scanf issues
+ * @brief Tells whether the menu buffer has no room for more input
  */
-void clear_input_buffer(void) {
-    int c;
-    while ((c = getchar()) != '\n' && c != EOF);
+int menu_input_full(void) {
+    return menu_input.len >= (int)sizeof(menu_input.buf) - 1;
 }
 
 /**
- * @brief Waits for user to press Enter
+ * @brief Watches stdin again once bytes were taken from a full buffer
  */
-void wait_for_enter(void) {
-    printf("\nPressione Enter para continuar...");
-    getchar();
+void menu_input_consumed(void) {
+    if (menu_input.paused && !menu_input_full()) {
+        ev_set_events(&main_loop, menu_input.source_id, EPOLLIN);
+        menu_input.paused = 0;
+    }
 }
 
 /**
- * @brief Lê um único caractere do teclado sem esperar o Enter
- * @return O caractere lido
+ * @brief stdin handler: appends what was typed to the menu buffer
+ *
+ * While the buffer is full stdin is left unwatched (the bytes wait in
+ * the terminal) instead of being read with a size of 0, which would
+ * look like EOF.
  */
-char read_key_direct(void) {
-    struct termios oldt, newt;
-    char ch;
-
-    // 1. Pega os atributos atuais do terminal
-    tcgetattr(STDIN_FILENO, &oldt);
-    newt = oldt;
-
-    // 2. Desabilita o modo canônico (buffer de linha) e o echo (impressão na tela)
-    newt.c_lflag &= ~(ICANON | ECHO);
-
-    // 3. Aplica as novas configurações imediatamente
-    tcsetattr(STDIN_FILENO, TCSANOW, &newt);
-
-    // 4. Lê o caractere
-    ch = getchar();
-
-    // 5. Restaura as configurações originais
-    tcsetattr(STDIN_FILENO, TCSANOW, &oldt);
+void on_stdin_ready(EventLoop *loop, int id, uint32_t events, void *user) {
+    MenuInput *in = (MenuInput*)user;
+    size_t room = sizeof(in->buf) - 1 - in->len;
+    (void)events;
+    
+    if (room == 0) {
+        ev_set_events(loop, id, 0);
+        in->paused = 1;
+        return;
+    }
+    
+    ssize_t n = read(STDIN_FILENO, in->buf + in->len, room);
+    if (n < 0 && (errno == EINTR || errno == EAGAIN)) {
+        return;
+    }
+    if (n <= 0) {
+        /* EOF: nada mais a ler, parar de observar o stdin */
+        in->eof = 1;
+        ev_remove(loop, id);
+        return;
+    }
+    
+    in->len += n;
+    gettimeofday(&in->time, NULL);
+    
+    if (menu_input_full()) {
+        ev_set_events(loop, id, 0);
+        in->paused = 1;
+    }
+    
+    if (in->busy && memchr(in->buf + in->len - n, '\n', n) != NULL) {
+        printf("\n[OCUPADO] Entrada recebida; sera processada ao final da operacao.\n");
+    }
+}
 
-    return ch;
+/**
+ * @brief Makes a newly opened mouse the active device
+ *
+ * The cursor position survives the swap.
+ */
+void mouse_attach(int fd, const char *path, const char *name) {
+    Cursor cursor = mouse_reader.cursor;
+    
+    mouse_fd_global = fd;
+    strncpy(mouse_device_path, path, MAX_PATH_LEN - 1);
+    mouse_reader_init(&mouse_reader, fd);
+    mouse_reader.cursor = cursor;
+    mouse_source_id = ev_add_fd(&main_loop, fd, EPOLLIN, on_mouse_ready, NULL);
+    
+    printf("\n[MOUSE] Conectado: %s (%s)\n", name, path);
 }
 
-/* ===================================================================
- * BMP IMAGE LOADING
- * =================================================================== */
+/**
+ * @brief Drops the active mouse (unplugged or failing)
+ *
+ * Another mouse already connected, if any, takes its place.
+ */
+void mouse_detach(void) {
+    if (mouse_fd_global < 0) {
+        return;
+    }
+    
+    ev_remove(&main_loop, mouse_source_id);
+    close(mouse_fd_global);
+    mouse_fd_global = -1;
+    mouse_source_id = -1;
+    printf("\n[MOUSE] Desconectado: %s\n", mouse_device_path);
+    mouse_device_path[0] = '\0';
+    
+    char path[MAX_PATH_LEN] = {0};
+    char name[MAX_PATH_LEN] = {0};
+    int fd = find_and_open_mouse(path, name);
+    if (fd >= 0) {
+        mouse_attach(fd, path, name);
+    }
+}
 
 /**
- * @brief Loads a BMP image file into memory buffer
- * @param filename Path to BMP file
- * @param image_data Output buffer for grayscale pixel data
- * @return 0 on success, -1 on failure
+ * @brief inotify handler: new input nodes are probed, removals detach the mouse
  */
-int load_bmp(const char *filename, uint8_t *image_data) {
-    FILE *file;
-    BMPHeader header;
-    BMPInfoHeader info_header;
-   
-    file = fopen(filename, "rb");
-    if (!file) {
-        printf(" Erro ao abrir '%s'\n", filename);
-        return -1;
+void on_hotplug_ready(EventLoop *loop, int id, uint32_t events, void *user) {
+    char path[MAX_PATH_LEN] = {0};
+    char name[MAX_PATH_LEN] = {0};
+    int removed;
+    (void)loop;
+    (void)id;
+    (void)events;
+    (void)user;
+    
+    int fd = mouse_hotplug_handle(&mouse_hotplug, mouse_device_path, &removed, path, name);
+    if (removed) {
+        mouse_detach();
     }
-   
-    /* Read and validate BMP header */
-    fread(&header, sizeof(BMPHeader), 1, file);
-    if (header.type != 0x4D42) {
-        printf(" Arquivo nao e BMP valido (assinatura 0x%X)\n", header.type);
-        fclose(file);
-        return -1;
+    if (fd >= 0) {
+        if (mouse_fd_global < 0) {
+            mouse_attach(fd, path, name);
+        } else {
+            close(fd);      /* Ja ha um mouse ativo */
+        }
     }
-   
-    /* Read and validate info header */
-    fread(&info_header, sizeof(BMPInfoHeader), 1, file);
-    if (info_header.width != IMG_WIDTH || abs(info_header.height) != IMG_HEIGHT) {
-        printf(" Dimensao incorreta: %dx%d (esperado %dx%d)\n",
-               info_header.width, abs(info_header.height), IMG_WIDTH, IMG_HEIGHT);
-        fclose(file);
-        return -1;
+}
+
+/**
+ * @brief One-shot timer: first scan of /dev/input, after the menu is up
+ */
+void on_initial_probe(EventLoop *loop, int id, uint32_t expirations, void *user) {
+    char path[MAX_PATH_LEN] = {0};
+    char name[MAX_PATH_LEN] = {0};
+    (void)expirations;
+    (void)user;
+    
+    ev_remove(loop, id);
+    if (mouse_fd_global >= 0) {
+        return;             /* O hotplug chegou antes */
     }
-   
-    /* Position file pointer at pixel data */
-    fseek(file, header.offset, SEEK_SET);
-   
-    /* Calculate row size with padding */
-    int row_size = ((info_header.width * info_header.bits + 31) / 32) * 4;
-   
-    uint8_t *row_data = (uint8_t*)malloc(row_size);
-    if (!row_data) {
-        printf("\nErro ao alocar memoria para a linha do BMP\n");
-        fclose(file);
-        return -1;
+    
+    int fd = find_and_open_mouse(path, name);
+    if (fd >= 0) {
+        mouse_attach(fd, path, name);
+    } else if (errno == EACCES) {
+        printf("!!! AVISO: Permissao negada para mouse. Execute como root (sudo).\n");
+    } else {
+        printf("!!! AVISO: Nenhum mouse encontrado. Conecte um mouse a qualquer momento.\n");
     }
-   
-    /* Read and convert pixel data */
-    printf("Carregando");
-    for (int y = 0; y < IMG_HEIGHT; y++) {
-        fread(row_data, 1, row_size, file);
-       
-        for (int x = 0; x < IMG_WIDTH; x++) {
-            uint8_t gray;
-           
-            /* Handle different bit depths */
-            if (info_header.bits == 32) {
-                uint8_t b = row_data[x * 4 + 0];
-                uint8_t g = row_data[x * 4 + 1];
-                uint8_t r = row_data[x * 4 + 2];
-                gray = rgb_to_gray(r, g, b);
-            } else if (info_header.bits == 24) {
-                uint8_t b = row_data[x * 3 + 0];
-                uint8_t g = row_data[x * 3 + 1];
-                uint8_t r = row_data[x * 3 + 2];
-                gray = rgb_to_gray(r, g, b);
-            } else if (info_header.bits == 8) {
-                gray = row_data[x];
-            } else {
-                printf("\nFormato %d bits nao suportado\n", info_header.bits);
-                free(row_data);
-                fclose(file);
+}
+
+/**
+ * @brief Reads the next mouse report, surviving an unplugged device
+ * @param wait_reconnect 1 to wait for a mouse to be plugged in (Enter cancels)
+ * @return 1 on success, -1 if no mouse is available
+ */
+int mouse_next(MousePacket *packet, int wait_reconnect) {
+    SessionMouse rec;
+    
+    if (session_mode() == SESSION_REPLAY) {
+        if (session_get(SES_REC_MOUSE, NULL, &rec, sizeof(rec)) != (int)sizeof(rec)) {
+            return -1;
+        }
+        memset(packet, 0, sizeof(*packet));
+        packet->dx = rec.dx;
+        packet->dy = rec.dy;
+        packet->wheel = rec.wheel;
+        packet->buttons = rec.buttons;
+        packet->pressed = rec.pressed;
+        packet->released = rec.released;
+        packet->cursor_pos.x = rec.cursor_x;
+        packet->cursor_pos.y = rec.cursor_y;
+        gettimeofday(&packet->time, NULL);
+        mouse_reader.cursor = packet->cursor_pos;
+        return 1;
+    }
+    
+    while (1) {
+        if (mouse_fd_global >= 0) {
+            int status = mouse_reader_next(&mouse_reader, packet);
+            if (status == 1) {
+                rec.dx = (int16_t)packet->dx;
+                rec.dy = (int16_t)packet->dy;
+                rec.wheel = (int16_t)packet->wheel;
+                rec.buttons = (uint8_t)packet->buttons;
+                rec.pressed = (uint8_t)packet->pressed;
+                rec.released = (uint8_t)packet->released;
+                rec.pad = 0;
+                rec.cursor_x = (int16_t)packet->cursor_pos.x;
+                rec.cursor_y = (int16_t)packet->cursor_pos.y;
+                session_put(SES_REC_MOUSE, 0, &rec, sizeof(rec));
+                return 1;
+            }
+            mouse_detach();
+            if (!wait_reconnect) {
+                session_put(SES_REC_MOUSE, 0, NULL, 0);
                 return -1;
             }
-           
-            /* BMP rows are stored bottom-to-top */
-            int addr = (IMG_HEIGHT - 1 - y) * IMG_WIDTH + x;
-            image_data[addr] = gray;
+            continue;
         }
-       
-        /* Progress indicator */
-        if (y % 60 == 0) {
-            printf(".");
-            fflush(stdout);
+        
+        if (!wait_reconnect || mouse_hotplug.fd < 0) {
+            printf("\nERRO: Mouse desconectado.\n");
+            session_put(SES_REC_MOUSE, 0, NULL, 0);
+            return -1;
+        }
+        
+        log_flush();
+        printf("\n[MOUSE] Reconecte um mouse para continuar (Enter cancela)...\n");
+        fflush(stdout);
+        while (mouse_fd_global < 0) {
+            if (memchr(menu_input.buf, '\n', menu_input.len) != NULL || menu_input_full() || menu_input.eof) {
+                menu_take_line(NULL, 0);
+                session_put(SES_REC_MOUSE, 0, NULL, 0);
+                return -1;
+            }
+            if (ev_run_once(&main_loop, -1) < 0) {
+                session_put(SES_REC_MOUSE, 0, NULL, 0);
+                return -1;
+            }
         }
     }
-   
-    printf(" OK!\n");
-    free(row_data);
-    fclose(file);
-    return 0;
 }
 
-/* ===================================================================
- * TEST PATTERN GENERATION
- * =================================================================== */
-
 /**
- * @brief Generates a horizontal gradient test pattern
+ * @brief True if a mouse is connected (the answer is part of the recorded session)
  */
-void generate_test_pattern(uint8_t *image_data) {
-    printf("   [C] Gerando padrao de teste (gradiente 320x240)...\n");
-    for (int y = 0; y < IMG_HEIGHT; y++) {
-        for (int x = 0; x < IMG_WIDTH; x++) {
-            uint8_t pixel_value = (uint8_t)((x * 255) / (IMG_WIDTH - 1));
-            image_data[y * IMG_WIDTH + x] = pixel_value;
-        }
+int mouse_available(void) {
+    int code = 0;
+    
+    if (session_mode() == SESSION_REPLAY) {
+        return session_get(SES_REC_AVAIL, &code, NULL, 0) >= 0 && code;
     }
+    session_put(SES_REC_AVAIL, mouse_fd_global >= 0, NULL, 0);
+    return mouse_fd_global >= 0;
 }
 
-/* ===================================================================
- * FPGA COMMUNICATION
- * =================================================================== */
-
 /**
- * @brief Sends entire image buffer to FPGA VRAM (Primary Memory)
- * @param image_data Source pixel buffer
- * @return 0 on success, -1 on failure
+ * @brief True if more mouse reports are already waiting (drain loops)
+ *
+ * How many reports arrive together depends on timing, so the decision
+ * is recorded and replayed instead of polled.
  */
-int send_image_to_fpga(uint8_t *image_data) {
-    int total_pixels = IMG_WIDTH * IMG_HEIGHT;
-    int errors = 0;
+int mouse_more_pending(struct pollfd *pfd) {
+    int code = 0;
+    
+    if (session_mode() == SESSION_REPLAY) {
+        return session_get(SES_REC_MORE, &code, NULL, 0) >= 0 && code;
+    }
+    int more = mouse_reader_pending(&mouse_reader) || poll(pfd, 1, 0) > 0;
+    session_put(SES_REC_MORE, more, NULL, 0);
+    return more;
+}
 
-    printf("   [C] Enviando %d pixels para o FPGA (testando ASM_Store)...\n", total_pixels);
-   
-    for (int i = 0; i < total_pixels; i++) {
-        int status = ASM_Store(i, image_data[i], 0); // mem_sel = 0 (Primary Memory)
-        if (status != 0) {
-            printf("\n   [C] ERRO: ASM_Store falhou no pixel %d (codigo %d)\n", i, status);
-            errors++;
-            if (errors > 10) {
-                printf("   [C] Muitos erros, abortando envio.\n");
-                return -1;
+/**
+ * @brief Mouse handler: consumes reports while no mode is reading the mouse
+ *
+ * Keeps the cursor position current and discards clicks made at the
+ * menu, so they do not leak into the next area capture. Wheel ticks are
+ * kept for a key session that accepts them.
+ */
+void on_mouse_ready(EventLoop *loop, int id, uint32_t events, void *user) {
+    MousePacket packet;
+    int status;
+    (void)events;
+    (void)user;
+    
+    while ((status = mouse_reader_poll(&mouse_reader, &packet)) == 1) {
+        /* Roda: acumulada para a sessao de teclas que a aceita */
+        if (key_session.active && key_session.wheel && packet.wheel != 0) {
+            if (key_session.wheel_ticks == 0) {
+                key_session.wheel_time = packet.time;
             }
+            key_session.wheel_ticks += packet.wheel;
         }
     }
-   
-    printf("   [C] Envio de pixels OK.\n");
-    printf("   [C] Testando ASM_Refresh()...\n");
-    ASM_Refresh();
-    usleep(REFRESH_DELAY_US);
-
-    if (errors > 0) {
-        printf("   [C] ERRO: %d falhas de escrita de pixel.\n", errors);
-        return -1;
+    
+    if (status < 0) {
+        (void)loop;
+        (void)id;
+        mouse_detach();
     }
-    return 0;
 }
 
 /**
- * @brief Executes an algorithm on FPGA and waits for completion
- * @param algo_name Algorithm name for logging
- * @param algo_func Pointer to algorithm function
- * @return 0 on success, -1 on failure
+ * @brief Waits for a line of stdin while dispatching other events (not recorded)
+ * @param out Output buffer, without the newline (NULL discards the line)
+ * @param size Size of the output buffer
+ * @return Line length on success, -1 on EOF or event loop failure
  */
-int execute_algorithm(const char *algo_name, void (*algo_func)(void)) {
-    printf("   [C] Executando '%s' (assincrono)...\n", algo_name);
-   
-    /* Set algorithm opcode */
-    algo_func();
-   
-    printf("   [C] Hardware iniciado. Aguardando FLAG_DONE (polling)...\n");
-
-    /* Poll for completion */
-    int timeout_counter = 0;
-    while (ASM_Get_Flag_Done() == 0) {
-        usleep(REFRESH_DELAY_US);
-        timeout_counter++;
-       
-        if (timeout_counter > TIMEOUT_LOOPS) {
-            printf("\n   [C] ERRO FATAL: TIMEOUT DO ALGORITMO '%s'!\n", algo_name);
+int menu_take_line(char *out, int size) {
+    char *newline;
+    
+    log_flush();
+    fflush(stdout);
+    while ((newline = memchr(menu_input.buf, '\n', menu_input.len)) == NULL) {
+        /* Linha maior que o buffer: entregue em partes */
+        if (menu_input_full()) {
+            break;
+        }
+        if (menu_input.eof || ev_run_once(&main_loop, -1) < 0) {
             return -1;
         }
     }
-   
-    printf("   [C] FLAG_DONE recebida para '%s'!\n", algo_name);
+    
+    int line_len = newline ? (int)(newline - menu_input.buf) : menu_input.len;
+    if (out != NULL && size > 0) {
+        int copy = (line_len < size - 1) ? line_len : size - 1;
+        memcpy(out, menu_input.buf, copy);
+        out[copy] = '\0';
+    }
+    
+    int consumed = newline ? line_len + 1 : line_len;
+    menu_input.len -= consumed;
+    memmove(menu_input.buf, menu_input.buf + consumed, menu_input.len);
+    menu_input_consumed();
+    return line_len;
+}
 
-    /* Check for hardware errors */
-    if (ASM_Get_Flag_Error() != 0) {
-        printf("   [C] ATENCAO: O FPGA reportou um ERRO (Flag_Error) durante '%s'!\n", algo_name);
+/**
+ * @brief Waits for a line of input (recorded, or taken from the replay)
+ * @param out Output buffer, without the newline (NULL discards the line)
+ * @param size Size of the output buffer
+ * @return 0 on success, -1 on EOF or event loop failure
+ */
+int menu_read_line(char *out, int size) {
+    char text[sizeof(menu_input.buf)];
+    int code = 0;
+    
+    if (session_mode() == SESSION_REPLAY) {
+        log_flush();
+        fflush(stdout);
+        int len = session_get(SES_REC_LINE, &code, text, sizeof(text) - 1);
+        if (len < 0 || code != 0) {
+            return -1;
+        }
+        text[(len < (int)sizeof(text) - 1) ? len : (int)sizeof(text) - 1] = '\0';
+        printf("%s\n", text);      /* Eco: a reproducao fica legivel como a sessao original */
+        gettimeofday(&menu_input.time, NULL);
+        if (out != NULL && size > 0) {
+            snprintf(out, size, "%s", text);
+        }
+        return 0;
+    }
+    
+    int len = menu_take_line(text, sizeof(text));
+    if (len < 0) {
+        session_put(SES_REC_LINE, 1, NULL, 0);      /* EOF */
         return -1;
     }
-
-    /* Pulse enable to acknowledge completion */
-    ASM_Pulse_Enable();
-   
-    printf("   [C] '%s' executado com sucesso.\n", algo_name);
+    session_put(SES_REC_LINE, 0, text, len);
+    if (out != NULL && size > 0) {
+        snprintf(out, size, "%s", text);
+    }
     return 0;
 }
 
 /**
- * @brief Reads a rectangular window from FPGA memory
- * @param buffer Output buffer for pixel data
- * @param x Starting X coordinate
- * @param y Starting Y coordinate
- * @param width Window width
- * @param height Window height
- * @param mem_sel Memory selector (0=Primary, 1=Secondary)
- * @return 0 on success, -1 on failure
+ * @brief Completion handler of a coprocessor wait
  */
+void on_coproc_done(EventLoop *loop, int id, uint32_t status, void *user) {
+    (void)loop;
+    (void)id;
+    ((CoprocWait*)user)->status = (int)status;
+}
 
-int read_fpga_window(uint8_t *buffer, int x, int y, int width, int height, int mem_sel) {
+/**
+ * @brief Periodic progress line while the coprocessor is busy
+ */
+void on_coproc_progress(EventLoop *loop, int id, uint32_t expirations, void *user) {
+    CoprocWait *wait = (CoprocWait*)user;
+    struct timespec now;
+    (void)loop;
+    (void)id;
+    (void)expirations;
+    
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    LOG_INFO("   [C] Aguardando FPGA... %.2f s\r", elapsed_ms(&wait->start, &now) / 1000.0);
+    wait->progress_shown = 1;
+}
+
+/**
+ * @brief Waits for the operation already started on the coprocessor
+ *
+ * Runs the event loop meanwhile: input keeps being collected (and is
+ * processed once the operation ends) and progress is shown by a timer
+ * instead of a sleep loop.
+ * @return EV_COPROC_DONE, EV_COPROC_ERROR, EV_COPROC_TIMEOUT, or -1 if the
+ *         event loop failed (the coprocessor state is then unknown)
+ */
+int wait_coprocessor(void) {
+    CoprocWait wait = {0};
+    clock_gettime(CLOCK_MONOTONIC, &wait.start);
+    
+    int done_id = ev_add_coproc(&main_loop, COPROC_TIMEOUT_MS, on_coproc_done, &wait);
+    if (done_id < 0) {
+        printf("   [C] ERRO: Nao foi possivel aguardar o coprocessador no laco de eventos.\n");
+        return -1;
+    }
+    int progress_id = ev_add_timer(&main_loop, COPROC_PROGRESS_MS, 1, on_coproc_progress, &wait);
+    
+    session_op_begin(SES_OP_ALGORITHM);
+    lat_stage_enter(LAT_STAGE_WAIT);
+    menu_input.busy = 1;
+    while (wait.status == 0) {
+        if (ev_run_once(&main_loop, -1) < 0) {
+            printf("\n   [C] ERRO: Laco de eventos falhou durante a espera (%s).\n", strerror(errno));
+            ev_remove(&main_loop, done_id);
+            wait.status = -1;
+        }
+    }
+    menu_input.busy = 0;
+    lat_stage_leave(LAT_STAGE_WAIT);
+    session_op_end(SES_OP_ALGORITHM, wait.status);
+    
+    ev_remove(&main_loop, progress_id);
+    if (wait.progress_shown) {
+        log_flush();
+        printf("\n");
+    }
+    return wait.status;
+}
+
+/**
+ * @brief Fixed protocol delay, counted as a wait in the latency breakdown
+ */
+void settle_us(int us) {
+    lat_stage_enter(LAT_STAGE_WAIT);
+    usleep(us);
+    lat_stage_leave(LAT_STAGE_WAIT);
+}
+
+/* ===================================================================
+ * UTILITY FUNCTIONS
+ * =================================================================== */
+
+/**
+ * @brief Converts RGB color to grayscale using standard luminosity formula
+ */
+uint8_t rgb_to_gray(uint8_t r, uint8_t g, uint8_t b) {
+    return (uint8_t)((299 * r + 587 * g + 114 * b) / 1000);
+}
+
+/**
+ * @brief Waits for user to press Enter
+ */
+void wait_for_enter(void) {
+    printf("\nPressione Enter para continuar...");
+    menu_read_line(NULL, 0);
+}
+
+/**
+ * @brief Puts the terminal in non-canonical, no-echo mode for a session
+ * @param saved Output: previous attributes, to be passed to terminal_restore
+ */
+void terminal_raw_enter(struct termios *saved) {
+    struct termios raw;
+    
+    tcgetattr(STDIN_FILENO, saved);
+    raw = *saved;
+    raw.c_lflag &= ~(ICANON | ECHO);
+    raw.c_cc[VMIN] = 1;
+    raw.c_cc[VTIME] = 0;
+    tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+}
+
+/**
+ * @brief Restores terminal attributes saved by terminal_raw_enter
+ */
+void terminal_restore(const struct termios *saved) {
+    tcsetattr(STDIN_FILENO, TCSANOW, saved);
+}
+
+/**
+ * @brief True when stdin is the local console, fed by the keyboard's evdev node
+ *
+ * Over SSH or the serial line the board's keyboard is not the one typing.
+ */
+int stdin_is_console(void) {
+    const char *name = ttyname(STDIN_FILENO);
+    
+    if (name == NULL) {
+        return 0;
+    }
+    if (strcmp(name, "/dev/console") == 0) {
+        return 1;
+    }
+    return strncmp(name, "/dev/tty", 8) == 0 && name[8] >= '0' && name[8] <= '9';
+}
+
+/**
+ * @brief Keyboard handler: queues the keys (presses and auto-repeats)
+ */
+void on_keyboard_ready(EventLoop *loop, int id, uint32_t events, void *user) {
+    KeySession *ks = (KeySession*)user;
+    char key;
+    int status;
+    (void)events;
+    
+    while ((status = keyboard_reader_poll(&ks->reader, &key)) == 1) {
+        if (ks->count < KEY_QUEUE_LEN) {
+            ks->times[ks->count] = ks->reader.time;
+            ks->queue[ks->count++] = key;
+        }
+    }
+    
+    if (status < 0) {
+        /* Teclado desconectado: voltar a ler do terminal */
+        ev_remove(loop, id);
+        close(ks->keyboard_fd);
+        ks->keyboard_fd = -1;
+        ks->source_id = -1;
+        printf("\n[TECLADO] Desconectado; usando o terminal.\n");
+    }
+}
+
+/**
+ * @brief Starts reading single keys without Enter
+ *
+ * The terminal stays raw for the whole session instead of being toggled
+ * around every key, so keys typed while an operation runs are kept. On
+ * the local console keys come from the keyboard's evdev node (the
+ * terminal copy is discarded); otherwise from stdin.
+ * @param accept_wheel 1 to also deliver mouse wheel ticks (KEY_WHEEL)
+ */
+void key_session_begin(int accept_wheel) {
+    char path[MAX_PATH_LEN] = {0};
+    char name[MAX_PATH_LEN] = {0};
+    
+    if (key_session.active) {
+        return;
+    }
+    
+    terminal_raw_enter(&key_session.saved);
+    key_session.active = 1;
+    key_session.count = 0;
+    key_session.keys = 0;
+    key_session.superseded = 0;
+    key_session.wheel = accept_wheel;
+    key_session.wheel_ticks = 0;
+    key_session.wheel_bursts = 0;
+    
+    if (!stdin_is_console() || session_mode() == SESSION_REPLAY) {
+        return;
+    }
+    
+    int fd = find_and_open_keyboard(path, name);
+    if (fd < 0) {
+        return;
+    }
+    
+    keyboard_reader_init(&key_session.reader, fd);
+    key_session.source_id = ev_add_fd(&main_loop, fd, EPOLLIN, on_keyboard_ready, &key_session);
+    if (key_session.source_id < 0) {
+        close(fd);
+        return;
+    }
+    key_session.keyboard_fd = fd;
+    
+    /* Teclas digitadas antes da sessao ja estao no buffer do terminal */
+    int carried = (menu_input.len < KEY_QUEUE_LEN) ? menu_input.len : KEY_QUEUE_LEN;
+    memcpy(key_session.queue, menu_input.buf, carried);
+    for (int i = 0; i < carried; i++) {
+        key_session.times[i] = menu_input.time;
+    }
+    key_session.count = carried;
+    menu_input.len = 0;
+    menu_input_consumed();
+}
+
+/**
+ * @brief Ends the key session and restores the terminal
+ */
+void key_session_end(void) {
+    if (!key_session.active) {
+        return;
+    }
+    
+    if (key_session.keyboard_fd >= 0) {
+        ev_remove(&main_loop, key_session.source_id);
+        close(key_session.keyboard_fd);
+        key_session.keyboard_fd = -1;
+        key_session.source_id = -1;
+        
+        /* O console recebeu as mesmas teclas: descartar a copia */
+        tcflush(STDIN_FILENO, TCIFLUSH);
+        menu_input.len = 0;
+        menu_input_consumed();
+    }
+    
+    terminal_restore(&key_session.saved);
+    key_session.active = 0;
+    
+    if (key_session.superseded > 0) {
+        printf("Teclado: %ld teclas, %ld pedidos de zoom substituidos descartados\n",
+               key_session.keys, key_session.superseded);
+    }
+    key_session.wheel = 0;
+}
+
+/**
+ * @brief Oldest pending key without consuming it, or -1 if none
+ */
+int key_peek(void) {
+    if (key_session.keyboard_fd >= 0) {
+        menu_input.len = 0;     /* Copia do console: ignorada */
+        menu_input_consumed();
+        return (key_session.count > 0) ? (unsigned char)key_session.queue[0] : -1;
+    }
+    return (menu_input.len > 0) ? (unsigned char)menu_input.buf[0] : -1;
+}
+
+/**
+ * @brief Consumes the oldest pending key, or returns -1 if none
+ */
+int key_pop(void) {
+    int key = key_peek();
+    
+    if (key < 0) {
+        return -1;
+    }
+    if (key_session.keyboard_fd >= 0) {
+        key_session.key_time = key_session.times[0];
+        memmove(key_session.queue, key_session.queue + 1, --key_session.count);
+        memmove(key_session.times, key_session.times + 1, key_session.count * sizeof(struct timeval));
+    } else {
+        key_session.key_time = menu_input.time;
+        memmove(menu_input.buf, menu_input.buf + 1, --menu_input.len);
+        menu_input_consumed();
+    }
+    key_session.keys++;
+    return key;
+}
+
+/**
+ * @brief Waits for the next key of the session
+ * @return The key, or KEY_WHEEL if wheel ticks are pending (see key_take_wheel);
+ *         end of input reads as ESC so every key loop exits
+ */
+int key_next(void) {
+    int32_t key = -1;
+    
+    log_flush();
+    fflush(stdout);
+    
+    if (session_mode() == SESSION_REPLAY) {
+        if (session_get(SES_REC_KEY, NULL, &key, sizeof(key)) != (int)sizeof(key)) {
+            return 27;
+        }
+        gettimeofday(&key_session.key_time, NULL);
+        key_session.keys++;
+        return key;
+    }
+    
+    while (key < 0) {
+        key = key_pop();
+        if (key >= 0) {
+            break;
+        }
+        if (key_session.wheel && key_session.wheel_ticks != 0) {
+            key = KEY_WHEEL;
+        } else if (key_session.keyboard_fd < 0 && menu_input.eof) {
+            key = 27;
+        } else if (ev_run_once(&main_loop, -1) < 0) {
+            key = 27;
+        }
+    }
+    
+    session_put(SES_REC_KEY, 0, &key, sizeof(key));
+    return key;
+}
+
+/**
+ * @brief Takes every wheel tick received so far as a single request
+ *
+ * Ticks that arrived while the previous zoom was running are summed, so
+ * a burst becomes one target level instead of a queue of FPGA runs.
+ * key_time becomes the timestamp of the first tick of the burst.
+ * @return Net ticks (positive = zoom in)
+ */
+int key_take_wheel(void) {
+    int32_t ticks = 0;
+    
+    if (session_mode() == SESSION_REPLAY) {
+        session_get(SES_REC_WHEEL, NULL, &ticks, sizeof(ticks));
+        if (ticks != 0) {
+            key_session.wheel_bursts++;
+            gettimeofday(&key_session.key_time, NULL);
+        }
+        return ticks;
+    }
+    
+    ev_run_once(&main_loop, 0);     /* Recolhe o que chegou durante o zoom anterior */
+    
+    ticks = key_session.wheel_ticks;
+    key_session.wheel_ticks = 0;
+    if (ticks != 0) {
+        key_session.wheel_bursts++;
+        key_session.key_time = key_session.wheel_time;
+    }
+    session_put(SES_REC_WHEEL, 0, &ticks, sizeof(ticks));
+    return ticks;
+}
+
+int is_zoom_key(int key) {
+    return key == ZOOM_IN || key == '=' || key == ZOOM_OUT || key == '_';
+}
+
+/**
+ * @brief Zoom direction of a key: 1 in, -1 out, 0 not a zoom key
+ */
+int zoom_key_direction(int key) {
+    if (key == ZOOM_IN || key == '=') return 1;
+    if (key == ZOOM_OUT || key == '_') return -1;
+    return 0;
+}
+
+/**
+ * @brief Collapses a run of repeats of the same zoom key into one
+ *
+ * Holding '+' auto-repeats faster than a zoom can be computed. Repeats of
+ * this key that piled up behind it are superseded, so the zoom follows the
+ * key at the repeat rate without a backlog to drain after the key is
+ * released. The run stops at a key of the other direction, which is
+ * served next instead of being thrown away.
+ */
+int key_coalesce_zoom(int key) {
+    int32_t rec[2];     /* Tecla final, teclas substituidas */
+    
+    if (session_mode() == SESSION_REPLAY) {
+        if (session_get(SES_REC_COALESCE, NULL, rec, sizeof(rec)) != (int)sizeof(rec)) {
+            return 27;
+        }
+        key_session.superseded += rec[1];
+        key_session.keys += rec[1];
+        return rec[0];
+    }
+    
+    ev_run_once(&main_loop, 0);     /* Recolhe o que chegou durante o zoom anterior */
+    
+    long superseded = key_session.superseded;
+    while (is_zoom_key(key) && zoom_key_direction(key_peek()) == zoom_key_direction(key)) {
+        key = key_pop();
+        key_session.superseded++;
+    }
+    
+    rec[0] = key;
+    rec[1] = (int32_t)(key_session.superseded - superseded);
+    session_put(SES_REC_COALESCE, 0, rec, sizeof(rec));
+    return key;
+}
+
+/**
+ * @brief Net zoom steps of a burst of zoom keys
+ *
+ * For step-wise zooms where every key counts (continuous zoom): the zoom
+ * keys that piled up behind this one are consumed and summed, '+' as +1
+ * and '-' as -1, so a held key advances by the number of repeats whatever
+ * the frame time, and a mixed burst keeps its balance.
+ * @param key A zoom key (is_zoom_key) just returned by key_next
+ * @return Net steps (positive = zoom in)
+ */
+int key_zoom_net(int key) {
+    int32_t rec[2];     /* Passos liquidos, teclas consumidas */
+    
+    if (session_mode() == SESSION_REPLAY) {
+        if (session_get(SES_REC_ZOOM_NET, NULL, rec, sizeof(rec)) != (int)sizeof(rec)) {
+            return 0;
+        }
+        key_session.keys += rec[1];
+        return rec[0];
+    }
+    
+    ev_run_once(&main_loop, 0);     /* Recolhe o que chegou durante o quadro anterior */
+    
+    rec[0] = zoom_key_direction(key);
+    rec[1] = 0;
+    while (is_zoom_key(key_peek())) {
+        rec[0] += zoom_key_direction(key_pop());
+        rec[1]++;
+    }
+    
+    session_put(SES_REC_ZOOM_NET, 0, rec, sizeof(rec));
+    return rec[0];
+}
+
+/* ===================================================================
+ * BMP IMAGE LOADING
+ * =================================================================== */
+
+/**
+ * @brief Loads a BMP image file into memory buffer
+ * @param filename Path to BMP file
+ * @param image_data Output buffer for grayscale pixel data
+ * @return 0 on success, -1 on failure
+ */
+int load_bmp(const char *filename, uint8_t *image_data) {
+    FILE *file;
+    BMPHeader header;
+    BMPInfoHeader info_header;
+   
+    file = fopen(filename, "rb");
+    if (!file) {
+        printf(" Erro ao abrir '%s'\n", filename);
+        return -1;
+    }
+   
+    /* Read and validate BMP header */
+    fread(&header, sizeof(BMPHeader), 1, file);
+    if (header.type != 0x4D42) {
+        printf(" Arquivo nao e BMP valido (assinatura 0x%X)\n", header.type);
+        fclose(file);
+        return -1;
+    }
+   
+    /* Read and validate info header */
+    fread(&info_header, sizeof(BMPInfoHeader), 1, file);
+    if (info_header.width != IMG_WIDTH || abs(info_header.height) != IMG_HEIGHT) {
+        printf(" Dimensao incorreta: %dx%d (esperado %dx%d)\n",
+               info_header.width, abs(info_header.height), IMG_WIDTH, IMG_HEIGHT);
+        fclose(file);
+        return -1;
+    }
+   
+    /* Position file pointer at pixel data */
+    fseek(file, header.offset, SEEK_SET);
+   
+    /* Calculate row size with padding */
+    int row_size = ((info_header.width * info_header.bits + 31) / 32) * 4;
+   
+    uint8_t *row_data = (uint8_t*)malloc(row_size);
+    if (!row_data) {
+        printf("\nErro ao alocar memoria para a linha do BMP\n");
+        fclose(file);
+        return -1;
+    }
+   
+    /* Read and convert pixel data */
+    printf("Carregando");
+    for (int y = 0; y < IMG_HEIGHT; y++) {
+        fread(row_data, 1, row_size, file);
+       
+        for (int x = 0; x < IMG_WIDTH; x++) {
+            uint8_t gray;
+           
+            /* Handle different bit depths */
+            if (info_header.bits == 32) {
+                uint8_t b = row_data[x * 4 + 0];
+                uint8_t g = row_data[x * 4 + 1];
+                uint8_t r = row_data[x * 4 + 2];
+                gray = rgb_to_gray(r, g, b);
+            } else if (info_header.bits == 24) {
+                uint8_t b = row_data[x * 3 + 0];
+                uint8_t g = row_data[x * 3 + 1];
+                uint8_t r = row_data[x * 3 + 2];
+                gray = rgb_to_gray(r, g, b);
+            } else if (info_header.bits == 8) {
+                gray = row_data[x];
+            } else {
+                printf("\nFormato %d bits nao suportado\n", info_header.bits);
+                free(row_data);
+                fclose(file);
+                return -1;
+            }
+           
+            /* BMP rows are stored bottom-to-top */
+            int addr = (IMG_HEIGHT - 1 - y) * IMG_WIDTH + x;
+            image_data[addr] = gray;
+        }
+       
+        /* Progress indicator */
+        if (y % 60 == 0) {
+            LOG_DEBUG(".");
+        }
+    }
+   
+    log_flush();
+    printf(" OK!\n");
+    free(row_data);
+    fclose(file);
+    return 0;
+}
+
+/**
+ * @brief Saves a grayscale buffer as an 8-bit BMP (readable by load_bmp)
+ * @param filename Output path
+ * @param data Pixel buffer, row-major, top row first
+ * @param width, height Buffer dimensions
+ * @return 0 on success, -1 on failure
+ */
+int save_bmp(const char *filename, const uint8_t *data, int width, int height) {
+    BMPHeader header;
+    BMPInfoHeader info_header;
+    int row_size = (width + 3) & ~3;
+    uint8_t palette[256 * 4];
+    uint8_t pad[3] = { 0, 0, 0 };
+
+    FILE *file = fopen(filename, "wb");
+    if (!file) {
+        printf(" Erro ao criar '%s'\n", filename);
+        return -1;
+    }
+
+    memset(&header, 0, sizeof(header));
+    header.type = 0x4D42;
+    header.offset = sizeof(BMPHeader) + sizeof(BMPInfoHeader) + sizeof(palette);
+    header.size = header.offset + row_size * height;
+
+    memset(&info_header, 0, sizeof(info_header));
+    info_header.size = sizeof(BMPInfoHeader);
+    info_header.width = width;
+    info_header.height = height;
+    info_header.planes = 1;
+    info_header.bits = 8;
+    info_header.imagesize = row_size * height;
+    info_header.ncolours = 256;
+
+    /* Paleta em tons de cinza (B, G, R, 0) */
+    for (int i = 0; i < 256; i++) {
+        palette[i * 4 + 0] = palette[i * 4 + 1] = palette[i * 4 + 2] = (uint8_t)i;
+        palette[i * 4 + 3] = 0;
+    }
+
+    int ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+             fwrite(&info_header, sizeof(info_header), 1, file) == 1 &&
+             fwrite(palette, sizeof(palette), 1, file) == 1;
+
+    /* BMP rows are stored bottom-to-top */
+    for (int y = height - 1; ok && y >= 0; y--) {
+        ok = fwrite(data + y * width, 1, width, file) == (size_t)width &&
+             fwrite(pad, 1, row_size - width, file) == (size_t)(row_size - width);
+    }
+
+    if (fclose(file) != 0 || !ok) {
+        printf(" Erro ao gravar '%s'\n", filename);
+        return -1;
+    }
+    return 0;
+}
+
+/* ===================================================================
+ * TEST PATTERN GENERATION
+ * =================================================================== */
+
+/**
+ * @brief Generates a horizontal gradient test pattern
+ */
+void generate_test_pattern(uint8_t *image_data) {
+    printf("   [C] Gerando padrao de teste (gradiente 320x240)...\n");
+    for (int y = 0; y < IMG_HEIGHT; y++) {
+        for (int x = 0; x < IMG_WIDTH; x++) {
+            uint8_t pixel_value = (uint8_t)((x * 255) / (IMG_WIDTH - 1));
+            image_data[y * IMG_WIDTH + x] = pixel_value;
+        }
+    }
+}
+
+/* ===================================================================
+ * FPGA COMMUNICATION
+ * =================================================================== */
+
+/**
+ * @brief Sends entire image buffer to FPGA VRAM (Primary Memory)
+ * @param image_data Source pixel buffer
+ * @return 0 on success, -1 on failure
+ */
+int send_image_to_fpga(uint8_t *image_data) {
+    int total_pixels = IMG_WIDTH * IMG_HEIGHT;
+
+    printf("   [C] Enviando %d pixels para o FPGA (testando ASM_Store)...\n", total_pixels);
+   
+    session_op_begin(SES_OP_UPLOAD);
+    int sent = cmd_upload_frame(image_data); // mem_sel = 0 (Primary Memory)
+   
+    if (sent < 0) {
+        session_op_end(SES_OP_UPLOAD, sent);
+        printf("   [C] ERRO: falha de escrita de pixel (%s).\n", vram_error_name(vram_last_error()));
+        return -1;
+    }
+
+    printf("   [C] Envio de pixels OK (%d diferentes da VRAM).\n", sent);
+    printf("   [C] Testando ASM_Refresh()...\n");
+    cmd_refresh();
+    session_op_end(SES_OP_UPLOAD, sent);
+    return 0;
+}
+
+/**
+ * @brief Maps an algorithm entry point to its transform code (residency_utils.h)
+ */
+int algorithm_op(void (*algo_func)(void)) {
+    if (algo_func == &NearestNeighbor) return RES_OP_NEAREST;
+    if (algo_func == &PixelReplication) return RES_OP_REPLICATE;
+    if (algo_func == &Decimation) return RES_OP_DECIMATE;
+    return RES_OP_AVERAGE;
+}
+
+/**
+ * @brief Maps a coprocessor wait status to an algorithm result (metrics_utils.h)
+ *
+ * Only for statuses the coprocessor reported; an event loop failure (-1)
+ * is not counted.
+ */
+int algorithm_result(int status) {
+    if (status == EV_COPROC_DONE) return MET_ALG_OK;
+    if (status == EV_COPROC_ERROR) return MET_ALG_ERROR;
+    return MET_ALG_TIMEOUT;
+}
+
+/**
+ * @brief Starts an algorithm and waits for it, recovering once from a hang
+ *
+ * On timeout or FLAG_ERROR the coprocessor is reset, checked idle and
+ * given back the algorithm's input frame from the host copy (mirror or
+ * last readback), then the algorithm runs once more. The session keeps
+ * the loaded image and its caches either way.
+ * @return EV_COPROC_DONE, or the status of the last attempt
+ */
+int run_algorithm(void (*algo_func)(void)) {
+    int op = algorithm_op(algo_func);
+    Residency input = res_algorithm_input();
+    
+    algo_func();
+    int status = wait_coprocessor();
+    cmd_algorithm(op, status == EV_COPROC_DONE);
+    if (status >= 0) {
+        metrics_algorithm(op, algorithm_result(status));
+    }
+    if (status != EV_COPROC_TIMEOUT && status != EV_COPROC_ERROR) {
+        return status;
+    }
+    
+    printf("\n   [C] %s no coprocessador. Recuperando (Reset + reenvio do ultimo quadro)...\n",
+           (status == EV_COPROC_TIMEOUT) ? "Timeout" : "Flag_Error");
+    
+    uint8_t *frame = (uint8_t*)malloc(IMG_WIDTH * IMG_HEIGHT);
+    if (frame && res_lookup(&input, frame) != 0) {
+        free(frame);
+        frame = NULL;
+    }
+    int recovered = cmd_recover(frame);
+    free(frame);
+    if (recovered != 0) {
+        return status;
+    }
+    
+    printf("   [C] Coprocessador recuperado. Nova tentativa...\n");
+    algo_func();
+    status = wait_coprocessor();
+    cmd_algorithm(op, status == EV_COPROC_DONE);
+    if (status >= 0) {
+        metrics_algorithm(op, algorithm_result(status));
+    }
+    cmd_retry_result(status == EV_COPROC_DONE);
+    return status;
+}
+
+/**
+ * @brief Executes an algorithm on FPGA and waits for completion
+ * @param algo_name Algorithm name for logging
+ * @param algo_func Pointer to algorithm function
+ * @return 0 on success, -1 on failure
+ */
+int execute_algorithm(const char *algo_name, void (*algo_func)(void)) {
+    printf("   [C] Executando '%s' (assincrono)...\n", algo_name);
+   
+    printf("   [C] Hardware iniciado. Aguardando FLAG_DONE (laco de eventos)...\n");
+
+    /* Set opcode and wait (input stays responsive; one recovery on a hang) */
+    int status = run_algorithm(algo_func);
+    if (status < 0) {
+        printf("   [C] ERRO: Espera por '%s' interrompida (falha no laco de eventos).\n", algo_name);
+        return -1;
+    }
+    if (status != EV_COPROC_DONE && status != EV_COPROC_ERROR) {
+        printf("\n   [C] ERRO: TIMEOUT DO ALGORITMO '%s' (mesmo apos recuperacao)!\n", algo_name);
+        return -1;
+    }
+   
+    printf("   [C] FLAG_DONE recebida para '%s'!\n", algo_name);
+
+    /* Check for hardware errors */
+    if (status == EV_COPROC_ERROR) {
+        printf("   [C] ATENCAO: O FPGA reportou um ERRO (Flag_Error) durante '%s'!\n", algo_name);
+        return -1;
+    }
+
+    /* Pulse enable to acknowledge completion */
+    ASM_Pulse_Enable();
+   
+    printf("   [C] '%s' executado com sucesso.\n", algo_name);
+    return 0;
+}
+
+/**
+ * @brief Reads a rectangular window from FPGA memory
+ * @param buffer Output buffer for pixel data
+ * @param x Starting X coordinate
+ * @param y Starting Y coordinate
+ * @param width Window width
+ * @param height Window height
+ * @param mem_sel Memory selector (0=Primary, 1=Secondary)
+ * @return 0 on success, -1 on failure
+ */
+
+int read_fpga_window(uint8_t *buffer, int x, int y, int width, int height, int mem_sel) {
     if (!buffer) {
         printf("ERRO: Buffer nulo em read_fpga_window\n");
         return -1;
@@ -364,35 +1374,24 @@ int read_fpga_window(uint8_t *buffer, int x, int y, int width, int height, int m
         return -1;
     }
    
-    int buffer_index = 0;
-    int errors = 0;
-   
     printf("   [C] Lendo janela (%d,%d) com tamanho %dx%d da FPGA (Memoria %d)...\n",
            x, y, width, height, mem_sel);
+    session_op_begin(SES_OP_READBACK);
    
-    for (int row = 0; row < height; row++) {
-        for (int col = 0; col < width; col++) {
-            int addr = (y + row) * IMG_WIDTH + (x + col);
-            int pixel_value = ASM_Load(addr, mem_sel);
-           
-            if (pixel_value < 0 || pixel_value > 255) {
-                printf("   [C] AVISO: Valor invalido no pixel [%d,%d]: %d\n",
-                       x + col, y + row, pixel_value);
-                errors++;
-                pixel_value = 0;
-            }
-           
-            buffer[buffer_index++] = (uint8_t)pixel_value;
-        }
-    }
+    /* Espelho ou copia no host quando tiverem o mesmo conteudo da memoria */
+    int result = res_read(mem_sel, buffer, width, x, y, width, height);
+    session_op_end(SES_OP_READBACK, width * height);
    
-    if (errors > 0) {
-        printf("   [C] AVISO: %d erros durante leitura da janela\n", errors);
-    } else {
-        printf("   [C] Janela lida com sucesso (%d pixels)\n", buffer_index);
+    if (result < 0) {
+        printf("   [C] AVISO: Conteudo da memoria %d desconhecido, leitura recusada\n", mem_sel);
+        return -1;
     }
-   
-    return (errors > 0) ? -1 : 0;
+    if (result > 0) {
+        printf("   [C] AVISO: %d erros durante leitura da janela\n", result);
+        return -1;
+    }
+    printf("   [C] Janela lida com sucesso (%d pixels)\n", width * height);
+    return 0;
 }
 
 /**
@@ -452,23 +1451,20 @@ void print_matrix(const uint8_t *data, int width, int height) {
 /* ===================================================================
  * REGIONAL ZOOM START
  * =================================================================== */
-int regional_zoom_start(RegionalZoomContext *ctx, int global_zoom_level) {
-    int corner1_x, corner1_y, corner2_x, corner2_y;
-    
-    printf("\n=== INICIO DO ZOOM REGIONAL ===\n");
-    printf("Zoom global atual: %d\n", global_zoom_level);
-    
-    /* Capture area using standard mouse function */
-    if (capture_mouse_area(&corner1_x, &corner1_y, &corner2_x, &corner2_y) != 0) {
-        printf("ERRO: Falha na captura da area.\n");
-        return -1;
-    }
-    
-    /* Normalize coordinates */
-    ctx->x = (corner1_x < corner2_x) ? corner1_x : corner2_x;
-    ctx->y = (corner1_y < corner2_y) ? corner1_y : corner2_y;
-    ctx->width = abs(corner2_x - corner1_x);
-    ctx->height = abs(corner2_y - corner1_y);
+
+/**
+ * @brief Initializes the regional zoom context for an explicit region
+ *
+ * Saves the screen as the base image and the region as cache level 0.
+ * @param x, y, width, height Region on the screen
+ * @return 0 on success, -1 on failure
+ */
+int regional_zoom_init(RegionalZoomContext *ctx, int x, int y, int width, int height,
+                       int global_zoom_level) {
+    ctx->x = x;
+    ctx->y = y;
+    ctx->width = width;
+    ctx->height = height;
     
     /* Validate selection */
     if (ctx->width == 0 || ctx->height == 0) {
@@ -492,14 +1488,26 @@ int regional_zoom_start(RegionalZoomContext *ctx, int global_zoom_level) {
         ctx->zoom_buffers[i] = NULL;
         ctx->buffer_sizes[i] = 0;
     }
-    
-    /*  DETERMINAR DE QUAL MEMÓRIA LER BASEADO NO ZOOM GLOBAL */
-    int source_memory = (global_zoom_level > 0) ? 1 : 0;
+    ctx->src_x = ctx->x;
+    ctx->src_y = ctx->y;
+    ctx->view_buffer = NULL;
+    ctx->base_tiles = NULL;
+    ctx->screen_tiles = NULL;
+    
+    /*  A base e o que a tela exibe, da memoria que a contem */
+    int source_memory = res_screen_memory();
+    char content[96];
+    
+    if (source_memory < 0) {
+        printf("ERRO: Conteudo da tela indefinido (algoritmo com falha). Use Reset (7).\n");
+        return -1;
+    }
+    res_describe(source_memory, content, sizeof(content));
     
     printf("\n[INIT] Salvando imagem base completa da memoria %d...\n", source_memory);
-    printf("       (zoom global = %d, fonte = %s)\n", 
+    printf("       (zoom global = %d, fonte = %s: %s)\n", 
            global_zoom_level, 
-           source_memory == 1 ? "Secondary (zoom-in aplicado)" : "Primary (original)");
+           source_memory == RES_SECONDARY ? "Secondary" : "Primary", content);
     
     /*  Alocar e salvar imagem completa de base */
     ctx->original_full_image = (uint8_t*)malloc(IMG_WIDTH * IMG_HEIGHT);
@@ -508,358 +1516,1332 @@ int regional_zoom_start(RegionalZoomContext *ctx, int global_zoom_level) {
         return -1;
     }
     
-    /* Ler da memória correta (1 se zoom global > 0, senão 0) */
-    for (int addr = 0; addr < IMG_WIDTH * IMG_HEIGHT; addr++) {
-        ctx->original_full_image[addr] = (uint8_t)ASM_Load(addr, source_memory);
+    /* Do espelho ou da copia no host quando possivel */
+    if (res_read(source_memory, ctx->original_full_image, IMG_WIDTH,
+                 0, 0, IMG_WIDTH, IMG_HEIGHT) != 0) {
+        printf("ERRO: Falha ao ler a imagem base.\n");
+        free(ctx->original_full_image);
+        ctx->original_full_image = NULL;
+        return -1;
+    }
+    
+    /* Versao em blocos da imagem base e da tela (inicialmente iguais) */
+    ctx->base_tiles = (TiledFrame*)malloc(sizeof(TiledFrame));
+    ctx->screen_tiles = (TiledFrame*)malloc(sizeof(TiledFrame));
+    if (!ctx->base_tiles || !ctx->screen_tiles) {
+        printf("ERRO: Falha ao alocar quadros em blocos.\n");
+        regional_zoom_cleanup(ctx);
+        return -1;
     }
+    tiled_from_linear(ctx->base_tiles, ctx->original_full_image);
+    tiled_from_linear(ctx->screen_tiles, ctx->original_full_image);
     
     /*  Salvar nível 0 (região inicial) extraída da imagem base */
     printf("[INIT] Criando cache do nível 0 (estado inicial)...\n");
     ctx->zoom_buffers[0] = (uint8_t*)malloc(ctx->width * ctx->height);
     if (!ctx->zoom_buffers[0]) {
         printf("ERRO: Falha ao alocar cache nível 0.\n");
+        regional_zoom_cleanup(ctx);
+        return -1;
+    }
+    
+    ctx->buffer_sizes[0] = ctx->width * ctx->height;
+    
+    /* Extrair região da imagem base já salva (só os blocos envolvidos) */
+    tiled_extract_rect(ctx->base_tiles, ctx->x, ctx->y, ctx->width, ctx->height,
+                       ctx->zoom_buffers[0], ctx->width);
+    
+    printf("\n>>> Contexto inicializado:\n");
+    printf("    Janela: (%d, %d) tamanho %dx%d\n", ctx->x, ctx->y, ctx->width, ctx->height);
+    printf("    Fonte: Memoria %d (zoom_global=%d)\n", source_memory, global_zoom_level);
+    printf("    Imagem base: %d bytes\n", IMG_WIDTH * IMG_HEIGHT);
+    printf("    Cache nível 0: %d pixels\n", ctx->buffer_sizes[0]);
+    printf("    Max zoom levels: %d\n", MAX_REGIONAL_ZOOM_LEVELS);
+    
+    return 0;
+}
+
+int regional_zoom_start(RegionalZoomContext *ctx, int global_zoom_level) {
+    int corner1_x, corner1_y, corner2_x, corner2_y;
+    
+    printf("\n=== INICIO DO ZOOM REGIONAL ===\n");
+    printf("Zoom global atual: %d\n", global_zoom_level);
+    
+    /* Capture area using standard mouse function */
+    if (capture_mouse_area(&corner1_x, &corner1_y, &corner2_x, &corner2_y,
+                           res_screen_memory() == RES_PRIMARY) != 0) {
+        printf("ERRO: Falha na captura da area.\n");
+        return -1;
+    }
+    
+    /* Normalize coordinates */
+    return regional_zoom_init(ctx,
+                              (corner1_x < corner2_x) ? corner1_x : corner2_x,
+                              (corner1_y < corner2_y) ? corner1_y : corner2_y,
+                              abs(corner2_x - corner1_x), abs(corner2_y - corner1_y),
+                              global_zoom_level);
+}
+
+
+/* ===================================================================
+ * REGIONAL ZOOM CLEANUP
+ * =================================================================== */
+
+void regional_zoom_cleanup(RegionalZoomContext *ctx) {
+    printf("\nLimpando buffers de zoom...\n");
+    
+    /*  Liberar imagem base */
+    if (ctx->original_full_image != NULL) {
         free(ctx->original_full_image);
+        ctx->original_full_image = NULL;
+        printf("  Imagem base liberada\n");
+    }
+    
+    /* Liberar quadros em blocos */
+    free(ctx->base_tiles);
+    free(ctx->screen_tiles);
+    ctx->base_tiles = NULL;
+    ctx->screen_tiles = NULL;
+    
+    /* Liberar vista do modo pan */
+    if (ctx->view_buffer != NULL) {
+        free(ctx->view_buffer);
+        ctx->view_buffer = NULL;
+    }
+    
+    /* Liberar cache de zooms */
+    for (int i = 0; i < MAX_REGIONAL_ZOOM_LEVELS; i++) {
+        if (ctx->zoom_buffers[i] != NULL) {
+            free(ctx->zoom_buffers[i]);
+            ctx->zoom_buffers[i] = NULL;
+            printf("  Buffer nivel %d liberado\n", i);
+        }
+    }
+}
+
+/**
+ * @brief Shows a region buffer over the base image
+ *
+ * Outside the region the screen always holds the base image, so only the
+ * tiles under the region can change. They are updated in the tiled screen
+ * frame and only the tiles whose content changed are sent to the VRAM.
+ *
+ * @param ctx Regional zoom context
+ * @param region Region content (width x height)
+ * @return Number of pixels sent, or -1 on failure
+ */
+int regional_present(RegionalZoomContext *ctx, const uint8_t *region) {
+    /* Espelho invalido: conteudo da VRAM desconhecido, reenviar tudo */
+    if (!vram_mirror_valid()) {
+        tiled_mark_all(ctx->screen_tiles);
+    }
+    
+    tiled_blit_rect(ctx->screen_tiles, region, ctx->width,
+                    ctx->x, ctx->y, ctx->width, ctx->height);
+    
+    int tiles = 0;
+    int sent = tiled_upload_dirty(ctx->screen_tiles, &tiles);
+    if (sent >= 0) {
+        printf("  %d blocos atualizados, %d pixels enviados\n", tiles, sent);
+    }
+    return sent;
+}
+
+/* ===================================================================
+ * REGIONAL ZOOM APPLY
+ * =================================================================== */
+
+/**
+ * @brief Computes level + 1 of the region on the FPGA and stores it in the cache
+ *
+ * The frame sent is the base image with the cached region of `level` on
+ * top, i.e. what the screen shows at that level. Nothing is presented.
+ * @return 0 on success, -1 on failure
+ */
+int regional_zoom_compute(RegionalZoomContext *ctx, int level, int global_zoom_level) {
+    int target_level = level + 1;
+    
+    printf("\n[CACHE MISS] Nivel %d nao existe. Processando na FPGA...\n", target_level);
+    
+    /* Alocar buffers */
+    uint8_t *current_image = (uint8_t*)malloc(IMG_WIDTH * IMG_HEIGHT);
+    uint8_t *region_buffer = (uint8_t*)malloc(ctx->width * ctx->height);
+    
+    if (!current_image || !region_buffer) {
+        printf("ERRO: Falha ao alocar memoria.\n");
+        if (current_image) free(current_image);
+        if (region_buffer) free(region_buffer);
+        return -1;
+    }
+    
+    /* PASSO 1: Montar a imagem do nivel atual (base + regiao do cache) */
+    printf("\n[1/4] Montando imagem do nivel %d (base salva no inicio, zoom global %d)\n",
+           level, global_zoom_level);
+    
+    memcpy(current_image, ctx->original_full_image, IMG_WIDTH * IMG_HEIGHT);
+    for (int row = 0; row < ctx->height; row++) {
+        memcpy(current_image + (ctx->y + row) * IMG_WIDTH + ctx->x,
+               ctx->zoom_buffers[level] + row * ctx->width, ctx->width);
+    }
+    
+    /* PASSO 2: Reset e enviar IMAGEM COMPLETA para FPGA */
+    printf("\n[2/4] RESET e enviando IMAGEM COMPLETA para FPGA...\n");
+    cmd_reset(0);
+    
+    /* Enviar imagem completa (só difere do espelho dentro da região) */
+    if (cmd_upload_frame(current_image) < 0) {
+        printf("ERRO: Falha ao enviar imagem (%s).\n", vram_error_name(vram_last_error()));
+        free(region_buffer);
+        free(current_image);
+        return -1;
+    }
+    
+    settle_us(REFRESH_DELAY_US);
+    printf("  Imagem completa enviada (%d pixels)\n", IMG_WIDTH * IMG_HEIGHT);
+    
+    /* PASSO 3: Executar NearestNeighbor */
+    printf("\n[3/4] Executando NearestNeighbor na imagem completa...\n");
+    int status = run_algorithm(&NearestNeighbor);
+    if (status != EV_COPROC_DONE && status != EV_COPROC_ERROR) {
+        printf("ERRO: %s!\n", (status < 0) ? "Falha no laco de eventos" : "Timeout");
+        free(region_buffer);
+        free(current_image);
+        return -1;
+    }
+    
+    if (status == EV_COPROC_ERROR) {
+        printf("ERRO: Flag de erro!\n");
+        free(region_buffer);
+        free(current_image);
+        return -1;
+    }
+    
+    ASM_Pulse_Enable();
+    printf("  NearestNeighbor concluido\n");
+    
+    /* PASSO 4: Ler APENAS a região processada da Secondary */
+    printf("\n[4/4] Lendo APENAS a regiao processada (%d,%d) %dx%d...\n",
+           ctx->x, ctx->y, ctx->width, ctx->height);
+    
+    /* Lê da posição REAL da região na imagem processada (Secondary) */
+    if (res_read(RES_SECONDARY, region_buffer, ctx->width,
+                 ctx->x, ctx->y, ctx->width, ctx->height) != 0) {
+        printf("ERRO: Falha ao ler a regiao processada.\n");
+        free(region_buffer);
+        free(current_image);
+        return -1;
+    }
+    
+    /* O buffer lido passa a ser o cache do novo nível */
+    ctx->zoom_buffers[target_level] = region_buffer;
+    ctx->buffer_sizes[target_level] = ctx->width * ctx->height;
+    
+    printf("  Regiao salva no cache[%d]: %d pixels\n",
+           target_level, ctx->buffer_sizes[target_level]);
+    
+    free(current_image);
+    return 0;
+}
+
+/**
+ * @brief Moves the region straight to a zoom level
+ *
+ * Missing levels on the way are computed and cached, but only the target
+ * is presented: a burst of requests costs one screen update, and every
+ * intermediate level stays in the cache for later.
+ * @param target_level Desired level (clamped to the valid range)
+ * @return 0 on success, -1 on failure
+ */
+int regional_zoom_to(RegionalZoomContext *ctx, int global_zoom_level, int target_level) {
+    if (target_level < 0) target_level = 0;
+    if (target_level > MAX_REGIONAL_ZOOM_LEVELS - 1) target_level = MAX_REGIONAL_ZOOM_LEVELS - 1;
+    
+    if (target_level == ctx->zoom_level) {
+        return 0;
+    }
+    
+    session_op_begin(SES_OP_REGIONAL);
+    for (int level = 0; level < target_level; level++) {
+        if (ctx->zoom_buffers[level + 1] == NULL &&
+            regional_zoom_compute(ctx, level, global_zoom_level) != 0) {
+            session_op_end(SES_OP_REGIONAL, target_level);
+            return -1;
+        }
+    }
+    
+    printf("  [CACHE] Exibindo nivel %d...\n", target_level);
+    
+    /* Reset: fora da região a tela volta a ser a base */
+    cmd_reset(0);
+    
+    if (regional_present(ctx, ctx->zoom_buffers[target_level]) < 0) {
+        printf("ERRO: Falha ao enviar a regiao.\n");
+        session_op_end(SES_OP_REGIONAL, target_level);
+        return -1;
+    }
+    
+    cmd_refresh();
+    session_op_end(SES_OP_REGIONAL, target_level);
+    
+    ctx->zoom_level = target_level;
+    return 0;
+}
+
+int regional_zoom_apply(RegionalZoomContext *ctx, uint8_t *image_data,
+                        int global_zoom_level, int operation) {
+    (void)image_data;
+    
+    /* Validate zoom out limit */
+    if (operation == ZOOM_OUT && ctx->zoom_level <= 0) {
+        printf("\nLimite de zoom-out atingido (resolucao original).\n");
+        return 0;
+    }
+    
+    /* Validate zoom in limit */
+    if (operation == ZOOM_IN && ctx->zoom_level >= MAX_REGIONAL_ZOOM_LEVELS - 1) {
+        printf("\nLimite maximo de zoom-in atingido (%d niveis).\n", MAX_REGIONAL_ZOOM_LEVELS);
+        return 0;
+    }
+    
+    printf("\n=== APLICANDO ZOOM %s ===\n", (operation == ZOOM_IN) ? "IN" : "OUT");
+    printf("Zoom level da janela: %d | Zoom global: %d\n", ctx->zoom_level, global_zoom_level);
+    
+    /* Niveis ja visitados ficam no cache nos dois sentidos */
+    int target_level = ctx->zoom_level + ((operation == ZOOM_IN) ? 1 : -1);
+    if (regional_zoom_to(ctx, global_zoom_level, target_level) != 0) {
+        return -1;
+    }
+    
+    printf("\n>>> ZOOM %s concluido! Nivel: %d\n\n",
+           (operation == ZOOM_IN) ? "IN" : "OUT", ctx->zoom_level);
+    return 0;
+}
+
+
+/* ===================================================================
+ * REGIONAL ZOOM PAN
+ * =================================================================== */
+
+/**
+ * @brief Moves the pan source window and updates only the exposed strips
+ *
+ * The part of the view that stays visible is shifted in place with
+ * memmove; only the newly exposed rows/columns are resampled from the
+ * base image. The caller uploads the result with vram_sync_rect.
+ *
+ * @param ctx Regional zoom context (view_buffer must be rendered)
+ * @param scale Current magnification (2^zoom_level)
+ * @param new_src_x New source window X (already clamped)
+ * @param new_src_y New source window Y (already clamped)
+ */
+void regional_pan_shift(RegionalZoomContext *ctx, int scale, int new_src_x, int new_src_y) {
+    int w = ctx->width;
+    int h = ctx->height;
+    int shift_x = (new_src_x - ctx->src_x) * scale;   /* deslocamento na vista */
+    int shift_y = (new_src_y - ctx->src_y) * scale;
+    
+    ctx->src_x = new_src_x;
+    ctx->src_y = new_src_y;
+    
+    /* Deslocamento maior que a janela: nada reaproveitavel */
+    if (abs(shift_x) >= w || abs(shift_y) >= h) {
+        zoom_nearest_rect(ctx->original_full_image, IMG_WIDTH,
+                          ctx->src_x, ctx->src_y, scale,
+                          ctx->view_buffer, w, 0, 0, w, h);
+        return;
+    }
+    
+    /* Reaproveitar a parte ainda visivel (ordem das linhas evita sobrescrita) */
+    int keep_w = w - abs(shift_x);
+    int keep_h = h - abs(shift_y);
+    int dst_col = (shift_x < 0) ? -shift_x : 0;
+    int src_col = (shift_x > 0) ? shift_x : 0;
+    
+    for (int i = 0; i < keep_h; i++) {
+        int row = (shift_y > 0) ? i : keep_h - 1 - i;
+        int dst_row = (shift_y < 0) ? row - shift_y : row;
+        int src_row = dst_row + shift_y;
+        memmove(ctx->view_buffer + dst_row * w + dst_col,
+                ctx->view_buffer + src_row * w + src_col, keep_w);
+    }
+    
+    /* Recalcular somente as colunas expostas */
+    if (shift_x != 0) {
+        zoom_nearest_rect(ctx->original_full_image, IMG_WIDTH,
+                          ctx->src_x, ctx->src_y, scale,
+                          ctx->view_buffer, w,
+                          (shift_x > 0) ? keep_w : 0, 0, abs(shift_x), h);
+    }
+    
+    /* Recalcular somente as linhas expostas */
+    if (shift_y != 0) {
+        zoom_nearest_rect(ctx->original_full_image, IMG_WIDTH,
+                          ctx->src_x, ctx->src_y, scale,
+                          ctx->view_buffer, w,
+                          0, (shift_y > 0) ? keep_h : 0, w, abs(shift_y));
+    }
+}
+
+/**
+ * @brief Interactive pan of the zoomed region (drag with left button)
+ *
+ * The region shows the base image magnified by 2^zoom_level around a
+ * movable source window. Dragging moves the window; each update sends
+ * only the pixels that changed on screen.
+ *
+ * @param ctx Regional zoom context
+ * @return 0 on success, -1 on failure
+ */
+int regional_zoom_pan(RegionalZoomContext *ctx) {
+    int scale = 1 << ctx->zoom_level;
+    int src_w = (ctx->width + scale - 1) / scale;
+    int src_h = (ctx->height + scale - 1) / scale;
+    int max_src_x = IMG_WIDTH - src_w;
+    int max_src_y = IMG_HEIGHT - src_h;
+    
+    if (!mouse_available()) {
+        printf("\nERRO: Mouse nao inicializado.\n");
+        return -1;
+    }
+    
+    printf("\n=== MODO PAN (zoom %dx) ===\n", scale);
+    printf("  - Segure o botao ESQUERDO e arraste para mover a janela\n");
+    printf("  - Botao DIREITO: sair do modo pan\n");
+    
+    if (ctx->view_buffer == NULL) {
+        ctx->view_buffer = (uint8_t*)malloc(ctx->width * ctx->height);
+        if (!ctx->view_buffer) {
+            printf("ERRO: Falha ao alocar vista do pan.\n");
+            return -1;
+        }
+    }
+    
+    /* Janela de origem centrada na regiao selecionada */
+    ctx->src_x = ctx->x + (ctx->width - src_w) / 2;
+    ctx->src_y = ctx->y + (ctx->height - src_h) / 2;
+    if (ctx->src_x > max_src_x) ctx->src_x = max_src_x;
+    if (ctx->src_y > max_src_y) ctx->src_y = max_src_y;
+    
+    zoom_nearest_rect(ctx->original_full_image, IMG_WIDTH,
+                      ctx->src_x, ctx->src_y, scale,
+                      ctx->view_buffer, ctx->width, 0, 0, ctx->width, ctx->height);
+    
+    /* Quadro inicial: vista sobreposta a imagem base (envia so diferencas) */
+    int sent = regional_present(ctx, ctx->view_buffer);
+    if (sent < 0) {
+        printf("ERRO: Falha ao enviar quadro inicial do pan.\n");
         return -1;
     }
+    cmd_refresh();
     
-    ctx->buffer_sizes[0] = ctx->width * ctx->height;
+    MousePacket packet;
+    int dragging = 0;
+    int acc_x = 0, acc_y = 0;      /* movimento acumulado ainda nao aplicado */
+    struct timeval acc_time;       /* carimbo do primeiro movimento acumulado */
+    int moves = 0;
+    long pixels_sent = 0;
+    double total_ms = 0.0;
     
-    /* Extrair região da imagem base já salva */
-    for (int row = 0; row < ctx->height; row++) {
-        for (int col = 0; col < ctx->width; col++) {
-            int img_addr = (ctx->y + row) * IMG_WIDTH + (ctx->x + col);
-            int buf_idx = row * ctx->width + col;
-            ctx->zoom_buffers[0][buf_idx] = ctx->original_full_image[img_addr];
+    while (1) {
+        if (mouse_next(&packet, 1) < 0) {
+            return -1;
+        }
+        
+        if (packet.pressed & MOUSE_BTN_RIGHT) {
+            break;
+        }
+        if ((packet.pressed | packet.released) & MOUSE_BTN_LEFT) {
+            dragging = (packet.buttons & MOUSE_BTN_LEFT) != 0;
+            acc_x = acc_y = 0;
+        } else if (dragging) {
+            if (acc_x == 0 && acc_y == 0) {
+                acc_time = packet.time;
+            }
+            acc_x += packet.dx;
+            acc_y += packet.dy;
+        }
+        
+        /* Relatorios ja lidos no mesmo lote: acumular antes de redesenhar */
+        if (mouse_reader_pending(&mouse_reader)) {
+            continue;
+        }
+        
+        if (acc_x != 0 || acc_y != 0) {
+            /* Arrastar para a direita move a janela de origem para a esquerda */
+            int step_x = acc_x / scale;
+            int step_y = acc_y / scale;
+            acc_x -= step_x * scale;
+            acc_y -= step_y * scale;
+            
+            int new_src_x = ctx->src_x - step_x;
+            int new_src_y = ctx->src_y - step_y;
+            if (new_src_x < 0) new_src_x = 0;
+            if (new_src_y < 0) new_src_y = 0;
+            if (new_src_x > max_src_x) new_src_x = max_src_x;
+            if (new_src_y > max_src_y) new_src_y = max_src_y;
+            
+            if (new_src_x == ctx->src_x && new_src_y == ctx->src_y) {
+                continue;
+            }
+            
+            struct timespec t0, t1;
+            clock_gettime(CLOCK_MONOTONIC, &t0);
+            lat_begin(&acc_time);
+            
+            regional_pan_shift(ctx, scale, new_src_x, new_src_y);
+            tiled_blit_rect(ctx->screen_tiles, ctx->view_buffer, ctx->width,
+                            ctx->x, ctx->y, ctx->width, ctx->height);
+            sent = tiled_upload_dirty(ctx->screen_tiles, NULL);
+            if (sent < 0) {
+                printf("\nERRO: Falha ao enviar atualizacao do pan.\n");
+                return -1;
+            }
+            cmd_refresh();
+            
+            clock_gettime(CLOCK_MONOTONIC, &t1);
+            total_ms += elapsed_ms(&t0, &t1);
+            pixels_sent += sent;
+            moves++;
+            
+            LOG_INFO("[PAN] Origem (%d, %d) | %d pixels enviados\r",
+                     ctx->src_x, ctx->src_y, sent);
         }
     }
     
-    printf("\n>>> Contexto inicializado:\n");
-    printf("    Janela: (%d, %d) tamanho %dx%d\n", ctx->x, ctx->y, ctx->width, ctx->height);
-    printf("    Fonte: Memoria %d (zoom_global=%d)\n", source_memory, global_zoom_level);
-    printf("    Imagem base: %d bytes\n", IMG_WIDTH * IMG_HEIGHT);
-    printf("    Cache nível 0: %d pixels\n", ctx->buffer_sizes[0]);
-    printf("    Max zoom levels: %d\n", MAX_REGIONAL_ZOOM_LEVELS);
-    
+    log_flush();
+    printf("\n>>> Modo pan encerrado: %d atualizacoes, %ld pixels enviados", moves, pixels_sent);
+    if (moves > 0) {
+        printf(", %.1f ms/atualizacao", total_ms / moves);
+    }
+    printf("\n");
     return 0;
 }
 
 
 /* ===================================================================
- * REGIONAL ZOOM CLEANUP
+ * SCREEN OVERLAYS
  * =================================================================== */
 
-void regional_zoom_cleanup(RegionalZoomContext *ctx) {
-    printf("\nLimpando buffers de zoom...\n");
+/**
+ * @brief Returns a host copy of the image currently on screen
+ *
+ * Primary memory usually holds image_data; after a global zoom the
+ * screen shows the secondary memory, and after undo/redo primary holds a
+ * frame from the history. Those are read back (or taken from the mirror
+ * or the host copy of the same content).
+ *
+ * @return image_data itself, a new buffer, or NULL on failure
+ */
+uint8_t *acquire_display_frame(uint8_t *image_data) {
+    int mem = res_screen_memory();
     
-    /*  Liberar imagem base */
-    if (ctx->original_full_image != NULL) {
-        free(ctx->original_full_image);
-        ctx->original_full_image = NULL;
-        printf("  Imagem base liberada\n");
+    if (mem == RES_PRIMARY && vram_mirror_valid() &&
+        memcmp(vram_mirror(), image_data, IMG_WIDTH * IMG_HEIGHT) == 0) {
+        return image_data;
     }
     
-    /* Liberar cache de zooms */
-    for (int i = 0; i < MAX_REGIONAL_ZOOM_LEVELS; i++) {
-        if (ctx->zoom_buffers[i] != NULL) {
-            free(ctx->zoom_buffers[i]);
-            ctx->zoom_buffers[i] = NULL;
-            printf("  Buffer nivel %d liberado\n", i);
-        }
+    uint8_t *frame = (uint8_t*)malloc(IMG_WIDTH * IMG_HEIGHT);
+    if (!frame) {
+        return NULL;
+    }
+    if (mem < 0 || res_read(mem, frame, IMG_WIDTH, 0, 0, IMG_WIDTH, IMG_HEIGHT) != 0) {
+        free(frame);
+        return NULL;
     }
+    return frame;
 }
 
-/* ===================================================================
- * REGIONAL ZOOM APPLY
- * =================================================================== */
-int regional_zoom_apply(RegionalZoomContext *ctx, uint8_t *image_data,
-                        int global_zoom_level, int operation) {
-    
-    /* Validate zoom out limit */
-    if (operation == ZOOM_OUT && ctx->zoom_level <= 0) {
-        printf("\nLimite de zoom-out atingido (resolucao original).\n");
-        return 0;
+/**
+ * @brief Undoes acquire_display_frame after an overlay session
+ *
+ * Overlays draw into primary memory. If the screen was not image_data,
+ * primary must hold the original image again, so the global zoom is
+ * reset (same policy as leaving regional zoom).
+ */
+void release_display_frame(uint8_t *frame, uint8_t *image_data, int *zoom_level) {
+    if (frame == image_data) {
+        return;
     }
     
-    /* Validate zoom in limit */
-    if (operation == ZOOM_IN && ctx->zoom_level >= MAX_REGIONAL_ZOOM_LEVELS - 1) {
-        printf("\nLimite maximo de zoom-in atingido (%d niveis).\n", MAX_REGIONAL_ZOOM_LEVELS);
-        return 0;
+    free(frame);
+    cmd_reset(0);
+    *zoom_level = 0;
+    cmd_upload_frame(image_data);
+    cmd_refresh();
+    history_record_screen(0);
+    printf(">>> Imagem original restaurada (zoom global resetado).\n");
+}
+
+/* ===================================================================
+ * MAGNIFIER LENS
+ * =================================================================== */
+
+/**
+ * @brief Computes the on-screen rectangle of the lens centered at the cursor
+ */
+void lens_rect_at(int cx, int cy, int *x, int *y) {
+    *x = cx - LENS_WIDTH / 2;
+    *y = cy - LENS_HEIGHT / 2;
+    if (*x < 0) *x = 0;
+    if (*y < 0) *y = 0;
+    if (*x > IMG_WIDTH - LENS_WIDTH) *x = IMG_WIDTH - LENS_WIDTH;
+    if (*y > IMG_HEIGHT - LENS_HEIGHT) *y = IMG_HEIGHT - LENS_HEIGHT;
+}
+
+/**
+ * @brief Renders the lens (magnified source around the cursor) into a frame
+ * @param frame Full-size frame receiving the lens
+ * @param base_frame Image being magnified
+ * @param cx, cy Cursor position (center of the magnified area)
+ * @param scale Magnification (2 or 4)
+ */
+void lens_render(uint8_t *frame, const uint8_t *base_frame, int cx, int cy, int scale) {
+    int lens_x, lens_y;
+    int src_w = LENS_WIDTH / scale;
+    int src_h = LENS_HEIGHT / scale;
+    int src_x = cx - src_w / 2;
+    int src_y = cy - src_h / 2;
+    
+    if (src_x < 0) src_x = 0;
+    if (src_y < 0) src_y = 0;
+    if (src_x > IMG_WIDTH - src_w) src_x = IMG_WIDTH - src_w;
+    if (src_y > IMG_HEIGHT - src_h) src_y = IMG_HEIGHT - src_h;
+    
+    lens_rect_at(cx, cy, &lens_x, &lens_y);
+    zoom_nearest_rect(base_frame, IMG_WIDTH, src_x, src_y, scale,
+                      frame + lens_y * IMG_WIDTH + lens_x, IMG_WIDTH,
+                      0, 0, LENS_WIDTH, LENS_HEIGHT);
+    
+    /* Borda da lente */
+    memset(frame + lens_y * IMG_WIDTH + lens_x, LENS_BORDER_COLOR, LENS_WIDTH);
+    memset(frame + (lens_y + LENS_HEIGHT - 1) * IMG_WIDTH + lens_x, LENS_BORDER_COLOR, LENS_WIDTH);
+    for (int row = 1; row < LENS_HEIGHT - 1; row++) {
+        frame[(lens_y + row) * IMG_WIDTH + lens_x] = LENS_BORDER_COLOR;
+        frame[(lens_y + row) * IMG_WIDTH + lens_x + LENS_WIDTH - 1] = LENS_BORDER_COLOR;
     }
+}
+
+/**
+ * @brief Real-time magnifier lens that follows the mouse cursor
+ *
+ * All pending mouse events are drained before each redraw, so queued
+ * motion collapses into a single update at the latest position. Each
+ * update restores the old footprint from base_frame, draws the new lens
+ * and sends only the pixels that changed inside both footprints.
+ *
+ * @param base_frame Image currently shown on screen (IMG_WIDTH x IMG_HEIGHT)
+ * @return 0 on success, -1 on failure
+ */
+int magnifier_lens(const uint8_t *base_frame) {
+    int scale = 2;
     
-    printf("\n=== APLICANDO ZOOM %s ===\n", (operation == ZOOM_IN) ? "IN" : "OUT");
-    printf("Zoom level da janela: %d | Zoom global: %d\n", ctx->zoom_level, global_zoom_level);
+    printf("\n=== LUPA EM TEMPO REAL (%dx%d) ===\n", LENS_WIDTH, LENS_HEIGHT);
+    printf("  - Mova o mouse para posicionar a lupa\n");
+    printf("  - Botao ESQUERDO: alterna ampliacao 2x/4x\n");
+    printf("  - Botao DIREITO: sair\n");
     
-    /* ============================================================
-     * ZOOM OUT: RESTAURAR BUFFER ANTERIOR DO CACHE
-     * ============================================================ */
-    if (operation == ZOOM_OUT) {
-        printf("\n[ZOOM OUT] Restaurando buffer do nivel %d...\n", ctx->zoom_level - 1);
-        
-        int prev_level = ctx->zoom_level - 1;
+    uint8_t *frame = (uint8_t*)malloc(IMG_WIDTH * IMG_HEIGHT);
+    if (!frame) {
+        printf("ERRO: Falha ao alocar quadro da lupa.\n");
+        return -1;
+    }
+    memcpy(frame, base_frame, IMG_WIDTH * IMG_HEIGHT);
+    
+    Cursor cursor = {IMG_WIDTH / 2, IMG_HEIGHT / 2};
+    MousePacket packet;
+    struct pollfd pfd = { .fd = mouse_fd_global, .events = POLLIN };
+    int lens_x, lens_y;
+    int result = 0;
+    
+    lens_render(frame, base_frame, cursor.x, cursor.y, scale);
+    lens_rect_at(cursor.x, cursor.y, &lens_x, &lens_y);
+    if (vram_sync_frame(frame) < 0) {
+        free(frame);
+        return -1;
+    }
+    cmd_refresh();
+    
+    int updates = 0;
+    int events = 0;
+    double total_ms = 0.0;
+    mouse_reader.cursor = cursor;
+    struct timespec start, now;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    
+    int running = 1;
+    while (running) {
+        int redraw = 0;
+        int last_x = cursor.x, last_y = cursor.y;
+        int batch_events = 0;
+        struct timeval batch_time;
         
-        if (ctx->zoom_buffers[prev_level] == NULL) {
-            printf("ERRO: Buffer do nivel anterior nao existe!\n");
-            return -1;
-        }
+        /* Bloqueia pelo primeiro relatorio e drena os que ja estao na fila */
+        do {
+            if (mouse_next(&packet, 0) < 0) {
+                result = -1;
+                running = 0;
+                break;
+            }
+            if (batch_events++ == 0) {
+                batch_time = packet.time;
+            }
+            events++;
+            cursor = packet.cursor_pos;
+            
+            if (packet.pressed & MOUSE_BTN_LEFT) {
+                scale = (scale == 2) ? 4 : 2;
+                redraw = 1;
+            }
+            if (packet.pressed & MOUSE_BTN_RIGHT) {
+                running = 0;
+            }
+        } while (running && mouse_more_pending(&pfd));
         
-        printf("  [CACHE] Carregando nível %d do cache (%d pixels)...\n",
-               prev_level, ctx->buffer_sizes[prev_level]);
+        if (!running) break;
+        if (!redraw && cursor.x == last_x && cursor.y == last_y) continue;
         
-        /* Reset e recarregar imagem BASE completa (já veio da memória correta) */
-        ASM_Reset();
-        ASM_Pulse_Enable();
-        usleep(PULSE_DELAY_US);
+        struct timespec t0, t1;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        lat_begin(&batch_time);
         
-        /* Restaurar background da imagem base salva (não precisa ler da FPGA) */
-        for (int addr = 0; addr < IMG_WIDTH * IMG_HEIGHT; addr++) {
-            ASM_Store(addr, ctx->original_full_image[addr], 0);
+        /* Restaurar a pegada antiga a partir da imagem base */
+        int old_x = lens_x, old_y = lens_y;
+        for (int row = 0; row < LENS_HEIGHT; row++) {
+            int offset = (old_y + row) * IMG_WIDTH + old_x;
+            memcpy(frame + offset, base_frame + offset, LENS_WIDTH);
         }
         
-        /* Sobrepor buffer do nível anterior */
-        printf("  Sobrepondo buffer do nivel %d na posicao (%d,%d)...\n",
-               prev_level, ctx->x, ctx->y);
-        
-        for (int row = 0; row < ctx->height; row++) {
-            for (int col = 0; col < ctx->width; col++) {
-                int img_addr = (ctx->y + row) * IMG_WIDTH + (ctx->x + col);
-                int buf_idx = row * ctx->width + col;
-                ASM_Store(img_addr, ctx->zoom_buffers[prev_level][buf_idx], 0);
-            }
-        }
+        lens_render(frame, base_frame, cursor.x, cursor.y, scale);
+        lens_rect_at(cursor.x, cursor.y, &lens_x, &lens_y);
         
-        ASM_Refresh();
-        usleep(REFRESH_DELAY_US);
+        /* Enviar apenas o retangulo que cobre as duas pegadas */
+        int x0 = (old_x < lens_x) ? old_x : lens_x;
+        int y0 = (old_y < lens_y) ? old_y : lens_y;
+        int x1 = ((old_x > lens_x) ? old_x : lens_x) + LENS_WIDTH;
+        int y1 = ((old_y > lens_y) ? old_y : lens_y) + LENS_HEIGHT;
         
-        /* Liberar buffer do nível atual (não precisamos mais) */
-        if (ctx->zoom_buffers[ctx->zoom_level] != NULL) {
-            free(ctx->zoom_buffers[ctx->zoom_level]);
-            ctx->zoom_buffers[ctx->zoom_level] = NULL;
+        if (vram_sync_rect(frame + y0 * IMG_WIDTH + x0, IMG_WIDTH,
+                           x0, y0, x1 - x0, y1 - y0) < 0) {
+            printf("\nERRO: Falha ao atualizar a lupa.\n");
+            result = -1;
+            break;
         }
+        cmd_refresh();
         
-        /* Decrementar zoom level */
-        ctx->zoom_level--;
-        printf("\n>>> ZOOM OUT concluido! Nivel: %d\n\n", ctx->zoom_level);
-        return 0;
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        total_ms += elapsed_ms(&t0, &t1);
+        updates++;
+    }
+    
+    /* Remover a lupa da tela */
+    vram_sync_frame(base_frame);
+    cmd_refresh();
+    free(frame);
+    
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double session_s = elapsed_ms(&start, &now) / 1000.0;
+    printf("\n>>> Lupa encerrada: %d atualizacoes para %d relatorios do mouse", updates, events);
+    if (updates > 0 && total_ms > 0.0) {
+        printf(", %.1f ms/atualizacao (max %.1f atualizacoes/s)",
+               total_ms / updates, 1000.0 * updates / total_ms);
+    }
+    printf(" em %.1f s\n", session_s);
+    return result;
+}
+
+
+/* ===================================================================
+ * PICTURE-IN-PICTURE
+ * =================================================================== */
+
+/**
+ * @brief Keeps the algorithm consistent with the zoom direction of a level
+ */
+int pip_algorithm_for_level(int level, int algorithm) {
+    if (level < 0) {
+        return (algorithm == ZOOM_ALG_AVERAGE) ? ZOOM_ALG_AVERAGE : ZOOM_ALG_DECIMATION;
+    }
+    return (algorithm == ZOOM_ALG_REPLICATION) ? ZOOM_ALG_REPLICATION : ZOOM_ALG_NEAREST;
+}
+
+/**
+ * @brief Interactive picture-in-picture session over a base frame
+ * @param base_frame Image currently shown on screen
+ * @return 0 on success, -1 on failure
+ */
+int pip_session(const uint8_t *base_frame) {
+    static const char *alg_names[] = {"Vizinho", "Replicacao", "Decimacao", "Media"};
+    
+    PipCompositor *comp = (PipCompositor*)malloc(sizeof(PipCompositor));
+    if (!comp) {
+        printf("ERRO: Falha ao alocar compositor.\n");
+        return -1;
     }
+    pip_init(comp, base_frame);
     
-    /* ============================================================
-     * ZOOM IN: PROCESSAR E SALVAR NO BUFFER (COM CACHE)
-     * ============================================================ */
+    int selected = -1;
+    int running = 1;
+    int result = 0;
     
-    int target_level = ctx->zoom_level + 1;
+    key_session_begin(0);
     
-    /* VERIFICAR SE JÁ EXISTE NO CACHE (CACHE HIT) */
-    if (ctx->zoom_buffers[target_level] != NULL) {
-        printf("\n[CACHE HIT] Nivel %d já existe no cache! Carregando...\n", target_level);
-        
-        /* Carregar do cache sem processar na FPGA */
-        ASM_Reset();
-        ASM_Pulse_Enable();
-        usleep(PULSE_DELAY_US);
-        
-        /* Restaurar imagem base */
-        for (int addr = 0; addr < IMG_WIDTH * IMG_HEIGHT; addr++) {
-            ASM_Store(addr, ctx->original_full_image[addr], 0);
+    while (running) {
+        struct timespec t0, t1;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        if (pip_composite(comp) < 0) {
+            printf("ERRO: Falha ao enviar composicao para a VRAM.\n");
+            result = -1;
+            break;
         }
+        cmd_refresh();
+        clock_gettime(CLOCK_MONOTONIC, &t1);
         
-        /* Sobrepor região do cache */
-        for (int row = 0; row < ctx->height; row++) {
-            for (int col = 0; col < ctx->width; col++) {
-                int img_addr = (ctx->y + row) * IMG_WIDTH + (ctx->x + col);
-                int buf_idx = row * ctx->width + col;
-                ASM_Store(img_addr, ctx->zoom_buffers[target_level][buf_idx], 0);
-            }
+        printf("\n\n=== PICTURE-IN-PICTURE ===\n");
+        printf("Ultima composicao: %d blocos, %d pixels enviados, %.1f ms\n",
+               comp->last_tiles, comp->last_pixels_sent, elapsed_ms(&t0, &t1));
+        for (int i = 0; i < PIP_MAX_WINDOWS; i++) {
+            const PipWindow *win = &comp->windows[i];
+            if (!win->active) continue;
+            printf(" %c[%d] Pos(%d,%d) Tamanho[%dx%d] Nivel %d (%s) Z=%d\n",
+                   (i == selected) ? '*' : ' ', i + 1, win->x, win->y,
+                   win->width, win->height, win->level,
+                   alg_names[win->algorithm], win->z);
         }
+        printf("Controles:\n [N] Nova janela (mouse)  [1-%d] Selecionar\n", PIP_MAX_WINDOWS);
+        printf(" [+] Zoom IN  [-] Zoom OUT  [A] Algoritmo  [T] Trazer para frente\n");
+        printf(" [X] Remover  [0] Voltar (ou ESC)\n");
+        printf("Aguardando comando... ");
         
-        ASM_Refresh();
-        usleep(REFRESH_DELAY_US);
+        int key = key_next();
+        lat_begin(&key_session.key_time);   /* Fechado pelo refresh da proxima composicao */
+        PipWindow *win = (selected >= 0) ? &comp->windows[selected] : NULL;
         
-        ctx->zoom_level = target_level;
-        printf(">>> ZOOM IN concluido! Nivel: %d (do cache)\n\n", ctx->zoom_level);
-        return 0;
+        switch (key) {
+            case 'n':
+            case 'N': {
+                if (!mouse_available()) {
+                    printf("\nERRO: Mouse nao inicializado.\n");
+                    break;
+                }
+                int c1x, c1y, c2x, c2y;
+                if (capture_mouse_area(&c1x, &c1y, &c2x, &c2y, 1) != 0) {
+                    break;
+                }
+                int x = (c1x < c2x) ? c1x : c2x;
+                int y = (c1y < c2y) ? c1y : c2y;
+                int id = pip_add_window(comp, x, y, abs(c2x - c1x), abs(c2y - c1y),
+                                        1, ZOOM_ALG_NEAREST);
+                if (id < 0) {
+                    printf("ERRO: Nao foi possivel criar a janela (limite %d ou area invalida).\n",
+                           PIP_MAX_WINDOWS);
+                } else {
+                    selected = id;
+                }
+                break;
+            }
+            
+            case '1': case '2': case '3': case '4': {
+                int id = key - '1';
+                if (id < PIP_MAX_WINDOWS && comp->windows[id].active) {
+                    selected = id;
+                }
+                break;
+            }
+            
+            case ZOOM_IN:
+            case '=':
+            case ZOOM_OUT:
+            case '_': {
+                if (!win) break;
+                int level = win->level + ((key == ZOOM_IN || key == '=') ? 1 : -1);
+                if (level < PIP_MIN_LEVEL || level > PIP_MAX_LEVEL) {
+                    printf("\nLimite de nivel atingido (%d a %d).\n", PIP_MIN_LEVEL, PIP_MAX_LEVEL);
+                    break;
+                }
+                pip_set_zoom(comp, selected, level,
+                             pip_algorithm_for_level(level, win->algorithm));
+                break;
+            }
+            
+            case 'a':
+            case 'A': {
+                if (!win) break;
+                int algorithm;
+                if (win->level < 0) {
+                    algorithm = (win->algorithm == ZOOM_ALG_DECIMATION) ? ZOOM_ALG_AVERAGE : ZOOM_ALG_DECIMATION;
+                } else {
+                    algorithm = (win->algorithm == ZOOM_ALG_NEAREST) ? ZOOM_ALG_REPLICATION : ZOOM_ALG_NEAREST;
+                }
+                pip_set_zoom(comp, selected, win->level, algorithm);
+                break;
+            }
+            
+            case 't':
+            case 'T':
+                if (win) pip_raise(comp, selected);
+                break;
+            
+            case 'x':
+            case 'X':
+                if (win) {
+                    pip_remove_window(comp, selected);
+                    selected = -1;
+                }
+                break;
+            
+            case '0':
+            case 27: // ESC
+                running = 0;
+                break;
+            
+            default:
+                printf("\nComando invalido: '%c'\n", key);
+                break;
+        }
     }
     
-    /* CACHE MISS: PROCESSAR NA FPGA */
-    printf("\n[CACHE MISS] Nivel %d nao existe. Processando na FPGA...\n", target_level);
-    
-    /* Alocar buffers */
-    uint8_t *current_image = (uint8_t*)malloc(IMG_WIDTH * IMG_HEIGHT);
-    uint8_t *region_buffer = (uint8_t*)malloc(ctx->width * ctx->height);
+    key_session_end();
     
-    if (!current_image || !region_buffer) {
-        printf("ERRO: Falha ao alocar memoria.\n");
-        if (current_image) free(current_image);
-        if (region_buffer) free(region_buffer);
+    /* Remover as janelas da tela */
+    pip_cleanup(comp);
+    free(comp);
+    vram_sync_frame(base_frame);
+    cmd_refresh();
+    return result;
+}
+
+
+/* ===================================================================
+ * CONTINUOUS ZOOM (BILINEAR)
+ * =================================================================== */
+
+/**
+ * @brief Renders a window magnified by zoom_q4/16 around its own center
+ *
+ * The source center is clamped so the magnified view never leaves the
+ * image. At 1.0x the window shows the base image unchanged.
+ */
+int continuous_zoom_render(uint8_t *frame, const uint8_t *base_frame,
+                           int x, int y, int width, int height, int zoom_q4) {
+    int32_t step = (ZOOM_Q4_ONE << 16) / zoom_q4;
+    int64_t half_w = (int64_t)width * step / 2;
+    int64_t half_h = (int64_t)height * step / 2;
+    int64_t center_x = (int64_t)(2 * x + width) << 15;
+    int64_t center_y = (int64_t)(2 * y + height) << 15;
+    
+    if (center_x < half_w) center_x = half_w;
+    if (center_y < half_h) center_y = half_h;
+    if (center_x > ((int64_t)IMG_WIDTH << 16) - half_w) center_x = ((int64_t)IMG_WIDTH << 16) - half_w;
+    if (center_y > ((int64_t)IMG_HEIGHT << 16) - half_h) center_y = ((int64_t)IMG_HEIGHT << 16) - half_h;
+    
+    /* Centro do pixel de destino, em coordenadas de centro de pixel da origem */
+    int32_t origin_x = (int32_t)(center_x - half_w + step / 2 - (1 << 15));
+    int32_t origin_y = (int32_t)(center_y - half_h + step / 2 - (1 << 15));
+    
+    return zoom_bilinear(base_frame, IMG_WIDTH, IMG_WIDTH, IMG_HEIGHT,
+                         origin_x, origin_y, step,
+                         frame + y * IMG_WIDTH + x, IMG_WIDTH, width, height);
+}
+
+/**
+ * @brief Interactive fractional zoom (1.0x to 8.0x in 1/16 steps)
+ *
+ * Driven by the +/- keys and by the mouse wheel through the key session.
+ * Zoom keys and wheel ticks that piled up during a render are summed, so
+ * a burst produces a single update at the final factor.
+ *
+ * @param base_frame Image currently shown on screen
+ * @param x, y, width, height Window to magnify (full frame allowed)
+ * @return 0 on success, -1 on failure
+ */
+int continuous_zoom(const uint8_t *base_frame, int x, int y, int width, int height) {
+    uint8_t *frame = (uint8_t*)malloc(IMG_WIDTH * IMG_HEIGHT);
+    if (!frame) {
+        printf("ERRO: Falha ao alocar quadro do zoom continuo.\n");
         return -1;
     }
-    
-    /* PASSO 1: Obter imagem atual */
-    printf("\n[1/6] Preparando imagem atual...\n");
-    
-    if (ctx->zoom_level > 0) {
-        /* Já tem zoom regional aplicado, ler da tela (Primary mem) */
-        printf("  Lendo da FPGA (Primary Memory) - zoom regional nivel %d\n", ctx->zoom_level);
-        for (int addr = 0; addr < IMG_WIDTH * IMG_HEIGHT; addr++) {
-            current_image[addr] = (uint8_t)ASM_Load(addr, 0);
+    memcpy(frame, base_frame, IMG_WIDTH * IMG_HEIGHT);
+    
+    printf("\n=== ZOOM CONTINUO (bilinear) ===\n");
+    printf("Janela: Pos(%d,%d) Tamanho[%dx%d]\n", x, y, width, height);
+    printf("Controles: [+]/[-] ou roda do mouse | [0] Voltar (ou ESC)\n");
+    
+    key_session_begin(1);
+    
+    int zoom_q4 = ZOOM_Q4_ONE;
+    int shown_q4 = 0;      /* forca o primeiro desenho */
+    int input_pending = 0; /* Entrada ainda nao exibida (inicio da medicao) */
+    int running = 1;
+    int result = 0;
+    
+    while (running) {
+        if (zoom_q4 != shown_q4) {
+            struct timespec t0, t1, t2;
+            clock_gettime(CLOCK_MONOTONIC, &t0);
+            if (input_pending) {
+                lat_begin(&key_session.key_time);
+                input_pending = 0;
+            }
+            if (continuous_zoom_render(frame, base_frame, x, y, width, height, zoom_q4) != 0) {
+                result = -1;
+                break;
+            }
+            clock_gettime(CLOCK_MONOTONIC, &t1);
+            int sent = vram_sync_rect(frame + y * IMG_WIDTH + x, IMG_WIDTH, x, y, width, height);
+            if (sent < 0) {
+                result = -1;
+                break;
+            }
+            cmd_refresh();
+            clock_gettime(CLOCK_MONOTONIC, &t2);
+            
+            shown_q4 = zoom_q4;
+            LOG_INFO("[ZOOM] %d.%04dx | calculo %.2f ms | envio %.1f ms (%d pixels)      \r",
+                     zoom_q4 / ZOOM_Q4_ONE, (zoom_q4 % ZOOM_Q4_ONE) * 625,
+                     elapsed_ms(&t0, &t1), elapsed_ms(&t1, &t2), sent);
         }
-    } else {
-        /* Primeiro zoom regional, usar a imagem base salva */
-        printf("  Usando imagem base salva (nivel 0");
-        printf(global_zoom_level > 0 ? " - origem: mem 1)\n" : " - origem: mem 0)\n");
-        memcpy(current_image, ctx->original_full_image, IMG_WIDTH * IMG_HEIGHT);
+        
+        int key = key_next();
+        if (key == KEY_WHEEL) {
+            zoom_q4 += key_take_wheel() * CZOOM_WHEEL_STEP;
+        } else if (is_zoom_key(key)) {
+            zoom_q4 += key_zoom_net(key) * CZOOM_KEY_STEP;
+        } else if (key == '0' || key == 27) {
+            running = 0;
+            continue;
+        } else {
+            continue;
+        }
+        
+        if (zoom_q4 < ZOOM_Q4_MIN) zoom_q4 = ZOOM_Q4_MIN;
+        if (zoom_q4 > ZOOM_Q4_MAX) zoom_q4 = ZOOM_Q4_MAX;
+        input_pending = (zoom_q4 != shown_q4);     /* Ja no limite: nada a exibir */
     }
     
-    /* PASSO 2: Salvar estado ATUAL da região no cache ANTES de processar */
-    printf("\n[2/6] Salvando estado atual no buffer (nivel %d)...\n", ctx->zoom_level);
+    key_session_end();
     
-    /* Alocar buffer para este nível */
-    ctx->zoom_buffers[ctx->zoom_level] = (uint8_t*)malloc(ctx->width * ctx->height);
-    if (ctx->zoom_buffers[ctx->zoom_level] == NULL) {
-        printf("ERRO: Falha ao alocar buffer de zoom.\n");
-        free(current_image);
-        free(region_buffer);
+    vram_sync_frame(base_frame);
+    cmd_refresh();
+    free(frame);
+    log_flush();
+    printf("\n>>> Zoom continuo encerrado.\n");
+    return result;
+}
+
+
+/* ===================================================================
+ * GLOBAL WHEEL ZOOM
+ * =================================================================== */
+
+/**
+ * @brief Resets the FPGA with a cached level in primary memory
+ */
+int wheel_zoom_load(WheelZoom *wz, int level) {
+    cmd_reset(0);
+    
+    if (cmd_upload_frame(wz->frames[level]) < 0) {
+        printf("ERRO: Falha ao enviar o nivel %d.\n", level);
+        return -1;
+    }
+    wz->hw_base = level;
+    wz->hw_level = level;
+    return 0;
+}
+
+/**
+ * @brief Runs NearestNeighbor once more over the current hardware level
+ *
+ * The result is read back once and cached, so the level can be shown
+ * again later without the coprocessor.
+ */
+int wheel_zoom_step(WheelZoom *wz) {
+    int status = run_algorithm(&NearestNeighbor);
+    if (status != EV_COPROC_DONE) {
+        printf("ERRO: %s no NearestNeighbor!\n", (status == EV_COPROC_ERROR) ? "Flag de erro" :
+               (status < 0) ? "Falha no laco de eventos" : "Timeout");
         return -1;
     }
+    ASM_Pulse_Enable();
     
-    ctx->buffer_sizes[ctx->zoom_level] = ctx->width * ctx->height;
+    wz->hw_level++;
+    wz->fpga_runs++;
     
-    /* Extrair e salvar região atual */
-    for (int row = 0; row < ctx->height; row++) {
-        for (int col = 0; col < ctx->width; col++) {
-            int img_addr = (ctx->y + row) * IMG_WIDTH + (ctx->x + col);
-            int buf_idx = row * ctx->width + col;
-            ctx->zoom_buffers[ctx->zoom_level][buf_idx] = current_image[img_addr];
-            region_buffer[buf_idx] = current_image[img_addr];
+    if (wz->frames[wz->hw_level] == NULL) {
+        uint8_t *frame = (uint8_t*)malloc(IMG_WIDTH * IMG_HEIGHT);
+        if (frame && res_read(RES_SECONDARY, frame, IMG_WIDTH, 0, 0, IMG_WIDTH, IMG_HEIGHT) == 0) {
+            wz->frames[wz->hw_level] = frame;
+        } else {
+            free(frame);
         }
     }
+    return 0;
+}
+
+/**
+ * @brief Moves the global zoom straight to a level
+ *
+ * A cached level is shown from primary memory without running the
+ * coprocessor. Otherwise the runs start from the highest cached level
+ * below the target (or continue the current chain) and only the final
+ * level stays on screen; the levels passed on the way are cached.
+ * @param target Desired level (clamped to 0..MAX_ZOOM_IN_LEVEL)
+ * @return 0 on success, -1 on failure
+ */
+int wheel_zoom_to(WheelZoom *wz, int target) {
+    if (target < 0) target = 0;
+    if (target > MAX_ZOOM_IN_LEVEL) target = MAX_ZOOM_IN_LEVEL;
     
-    printf("  Estado salvo: %d pixels no buffer[%d]\n",
-           ctx->buffer_sizes[ctx->zoom_level], ctx->zoom_level);
-    
-    /* PASSO 3: Reset e enviar IMAGEM COMPLETA para FPGA */
-    printf("\n[3/6] RESET e enviando IMAGEM COMPLETA para FPGA...\n");
-    ASM_Reset();
-    ASM_Pulse_Enable();
-    usleep(PULSE_DELAY_US);
+    if (target == wz->shown) {
+        return 0;
+    }
+    wz->requests++;
+    session_op_begin(SES_OP_WHEEL);
     
-    /* Enviar imagem completa (não apenas a região) */
-    for (int addr = 0; addr < IMG_WIDTH * IMG_HEIGHT; addr++) {
-        ASM_Store(addr, current_image[addr], 0);
+    if (wz->frames[target] != NULL) {
+        if (wheel_zoom_load(wz, target) < 0) {
+            session_op_end(SES_OP_WHEEL, target);
+            return -1;
+        }
+        cmd_refresh();
+        wz->cache_hits++;
+        wz->shown = target;
+        session_op_end(SES_OP_WHEEL, target);
+        return 0;
     }
     
-    //ASM_Refresh();
-    usleep(REFRESH_DELAY_US);
-    printf("  Imagem completa enviada (%d pixels)\n", IMG_WIDTH * IMG_HEIGHT);
+    int base = target - 1;
+    while (wz->frames[base] == NULL) {
+        base--;
+    }
     
-    /* PASSO 4: Executar NearestNeighbor */
-    printf("\n[4/6] Executando NearestNeighbor na imagem completa...\n");
-    NearestNeighbor();
-    
-    int timeout = 0;
-    while (ASM_Get_Flag_Done() == 0) {
-        usleep(REFRESH_DELAY_US);
-        timeout++;
-        if (timeout > TIMEOUT_LOOPS) {
-            printf("ERRO: Timeout!\n");
-            free(region_buffer);
-            free(current_image);
+    /* Continuar a cadeia atual se ela ja passou do nivel base */
+    if (wz->hw_level < base || wz->hw_level > target) {
+        if (wheel_zoom_load(wz, base) < 0) {
+            session_op_end(SES_OP_WHEEL, target);
             return -1;
         }
     }
     
-    if (ASM_Get_Flag_Error() != 0) {
-        printf("ERRO: Flag de erro!\n");
-        free(region_buffer);
-        free(current_image);
-        return -1;
+    while (wz->hw_level < target) {
+        if (wheel_zoom_step(wz) < 0) {
+            session_op_end(SES_OP_WHEEL, target);
+            return -1;
+        }
+    }
+    wz->shown = target;
+    session_op_end(SES_OP_WHEEL, target);
+    return 0;
+}
+
+/**
+ * @brief Interactive global zoom: the wheel (or +/-) picks the level
+ *
+ * Ticks that arrive while a level is being computed are summed into one
+ * target. On exit the FPGA is left as the menu expects: image_data in
+ * primary memory and `shown` NearestNeighbor runs chained over it.
+ * @param zoom_level In: current global level (>= 0); out: final level
+ * @return 0 on success, -1 on coprocessor failure
+ */
+int wheel_zoom_session(uint8_t *image_data, int *zoom_level) {
+    WheelZoom wz;
+    int result = 0;
+    int running = 1;
+    
+    memset(&wz, 0, sizeof(wz));
+    wz.frames[0] = image_data;
+    wz.shown = *zoom_level;
+    wz.hw_level = *zoom_level;
+    
+    /* Quadro restaurado do historico: ja esta na primaria, sem cadeia */
+    if (*zoom_level > 0 && res_screen_memory() == RES_PRIMARY) {
+        uint8_t *frame = (uint8_t*)malloc(IMG_WIDTH * IMG_HEIGHT);
+        if (frame && res_read(RES_PRIMARY, frame, IMG_WIDTH, 0, 0, IMG_WIDTH, IMG_HEIGHT) == 0) {
+            wz.frames[*zoom_level] = frame;
+            wz.hw_base = *zoom_level;
+        } else {
+            free(frame);
+            wz.hw_level = -1;       /* Forca recarregar o nivel 0 */
+        }
     }
     
-    ASM_Pulse_Enable();
-    printf("  NearestNeighbor concluido\n");
+    printf("\n=== ZOOM GLOBAL PELA RODA DO MOUSE ===\n");
+    if (!mouse_available()) {
+        printf("AVISO: Mouse nao conectado; use [+] e [-] ou conecte um mouse.\n");
+    }
+    printf("Roda para frente: Zoom IN | para tras: Zoom OUT (niveis 0 a %d)\n", MAX_ZOOM_IN_LEVEL);
+    printf("[+]/[-] um nivel | [0] Voltar (ou ESC)\n");
     
-    /* PASSO 5: Ler APENAS a região processada da Secondary */
-    printf("\n[5/6] Lendo APENAS a regiao processada (%d,%d) %dx%d...\n",
-           ctx->x, ctx->y, ctx->width, ctx->height);
+    key_session_begin(1);
     
-    /* Ler apenas a região nas coordenadas corretas da imagem processada */
-    for (int row = 0; row < ctx->height; row++) {
-        for (int col = 0; col < ctx->width; col++) {
-            /* Lê da posição REAL da região na imagem processada (Secondary) */
-            int fpga_addr = (ctx->y + row) * IMG_WIDTH + (ctx->x + col);
-            int buf_idx = row * ctx->width + col;
-            region_buffer[buf_idx] = (uint8_t)ASM_Load(fpga_addr, 1);
+    while (running) {
+        printf("[RODA] Nivel %d | Execucoes FPGA: %d | Cache: %d acertos\n",
+               wz.shown, wz.fpga_runs, wz.cache_hits);
+        
+        int key = key_coalesce_zoom(key_next());
+        int target = wz.shown;
+        
+        if (key == KEY_WHEEL) {
+            target += key_take_wheel();
+        } else if (key == ZOOM_IN || key == '=') {
+            target++;
+        } else if (key == ZOOM_OUT || key == '_') {
+            target--;
+        } else if (key == '0' || key == 27) {
+            running = 0;
+            continue;
+        } else {
+            continue;
         }
+        
+        if (target < 0) target = 0;
+        if (target > MAX_ZOOM_IN_LEVEL) target = MAX_ZOOM_IN_LEVEL;
+        if (target == wz.shown) {
+            continue;
+        }
+        
+        struct timespec t0, t1;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        lat_begin(&key_session.key_time);
+        if (wheel_zoom_to(&wz, target) < 0) {
+            lat_cancel();
+            result = -1;
+            break;
+        }
+        /* Saida do coprocessador: exibida ao concluir, sem ASM_Refresh */
+        lat_refresh();
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        printf("  -> nivel %d em %.1f ms\n", wz.shown, elapsed_ms(&t0, &t1));
     }
     
-    printf("  Regiao lida: %d pixels\n", ctx->width * ctx->height);
+    key_session_end();
     
-    /* Alocar buffer para o novo nível e salvar no cache */
-    ctx->zoom_buffers[target_level] = (uint8_t*)malloc(ctx->width * ctx->height);
-    if (!ctx->zoom_buffers[target_level]) {
-        printf("ERRO: Falha ao alocar cache nivel %d.\n", target_level);
-        free(region_buffer);
-        free(current_image);
-        return -1;
+    /* Estado esperado pelo menu: image_data na primaria e `shown` execucoes encadeadas */
+    if (result == 0 && (wz.hw_base != 0 || wz.hw_level != wz.shown)) {
+        printf("Reencadeando %d execucao(oes) sobre a imagem original...\n", wz.shown);
+        if (wheel_zoom_load(&wz, 0) < 0) {
+            result = -1;
+        }
+        while (result == 0 && wz.hw_level < wz.shown) {
+            if (wheel_zoom_step(&wz) < 0) {
+                result = -1;
+            }
+        }
+        if (result == 0 && wz.shown == 0) {
+            cmd_refresh();
+        }
     }
     
-    ctx->buffer_sizes[target_level] = ctx->width * ctx->height;
-    memcpy(ctx->zoom_buffers[target_level], region_buffer, ctx->width * ctx->height);
-    
-    printf("  Regiao salva no cache[%d]: %d pixels\n", 
-           target_level, ctx->buffer_sizes[target_level]);
-    
-    /* PASSO 6: Reset, restaurar background e sobrepor resultado */
-    printf("\n[6/6] RESET, restaurando background e sobrepondo regiao processada...\n");
-    ASM_Reset();
-    ASM_Pulse_Enable();
-    usleep(PULSE_DELAY_US);
+    printf(">>> Zoom pela roda encerrado: nivel %d, %d pedidos, %d execucoes FPGA, %d do cache\n",
+           wz.shown, wz.requests, wz.fpga_runs, wz.cache_hits);
     
-    /* Restaurar imagem base completa (que veio da memória correta) */
-    for (int addr = 0; addr < IMG_WIDTH * IMG_HEIGHT; addr++) {
-        ASM_Store(addr, ctx->original_full_image[addr], 0);
+    for (int level = 1; level < WHEEL_ZOOM_LEVELS; level++) {
+        free(wz.frames[level]);
     }
     
-    /* Sobrepor apenas a região processada */
-    for (int row = 0; row < ctx->height; row++) {
-        for (int col = 0; col < ctx->width; col++) {
-            int img_addr = (ctx->y + row) * IMG_WIDTH + (ctx->x + col);
-            int buf_idx = row * ctx->width + col;
-            ASM_Store(img_addr, region_buffer[buf_idx], 0);
-        }
+    *zoom_level = (result == 0) ? wz.shown : wz.hw_level;
+    return result;
+}
+
+
+/* ===================================================================
+ * GLOBAL ZOOM HISTORY
+ * =================================================================== */
+
+/**
+ * @brief Records the frame on screen as the newest history entry
+ *
+ * Called after anything that changes what the global zoom shows. The
+ * frame comes from the cheapest source (residency_utils), so after an
+ * algorithm it is one readback that later reads reuse.
+ */
+void history_record_screen(int zoom_level) {
+    int mem = res_screen_memory();
+    uint8_t *frame = (uint8_t*)malloc(IMG_WIDTH * IMG_HEIGHT);
+    
+    if (!frame || mem < 0 ||
+        res_read(mem, frame, IMG_WIDTH, 0, 0, IMG_WIDTH, IMG_HEIGHT) != 0 ||
+        history_push(&zoom_history, frame, zoom_level) != 0) {
+        printf("AVISO: Quadro nao registrado no historico de zoom.\n");
     }
+    free(frame);
+}
+
+/**
+ * @brief Shows the previous (step = -1) or next (+1) frame of the history
+ *
+ * The exact frame is put in primary memory (only the pixels that differ
+ * are sent) and displayed; no algorithm runs. Later zooms continue from
+ * it, since after the reset the coprocessor starts from primary memory.
+ * @param zoom_level Updated to the level of the restored frame
+ * @return 0 on success, -1 if there is nothing in that direction or on
+ *         failure (the history position is then unchanged)
+ */
+int history_show(int step, int *zoom_level) {
+    uint8_t *frame = (uint8_t*)malloc(IMG_WIDTH * IMG_HEIGHT);
+    int level;
     
-    ASM_Refresh();
-    usleep(REFRESH_DELAY_US);
-    
-    /* Incrementar zoom level */
-    ctx->zoom_level = target_level;
+    if (!frame) {
+        printf("ERRO: Memoria insuficiente.\n");
+        return -1;
+    }
+    if (history_step(&zoom_history, step, frame, &level) != 0) {
+        printf("ERRO: Nada para %s no historico de zoom.\n", (step < 0) ? "desfazer" : "refazer");
+        free(frame);
+        return -1;
+    }
     
-    /* Liberar buffers temporários */
-    free(region_buffer);
-    free(current_image);
+    cmd_reset(0);
+    int sent = cmd_upload_frame(frame);
+    cmd_refresh();
     
-    printf("\n>>> ZOOM IN concluido! Nivel: %d (processado e cacheado)\n\n", ctx->zoom_level);
+    if (sent < 0) {
+        // The frame is not on screen: keep the history where it was
+        int previous_level;
+        history_step(&zoom_history, -step, frame, &previous_level);
+        free(frame);
+        printf("ERRO: Falha ao enviar o quadro do historico (%s).\n", vram_error_name(vram_last_error()));
+        return -1;
+    }
+    free(frame);
+    *zoom_level = level;
+    printf(">>> Quadro do nivel %d restaurado (%d pixels enviados, nenhum algoritmo).\n",
+           level, sent);
     return 0;
 }
 
-
 /* ===================================================================
  * MOUSE AREA SELECTION
  * =================================================================== */
 
 /**
  * @brief Captures two mouse clicks to define a rectangular area
+ *
+ * With show_cursor, a cursor sprite is drawn over the image in Primary
+ * Memory (see overlay_utils.h) and removed before returning, so callers
+ * can read the VRAM right after.
+ *
  * @param corner1_x Output: First corner X coordinate
  * @param corner1_y Output: First corner Y coordinate
  * @param corner2_x Output: Second corner X coordinate
  * @param corner2_y Output: Second corner Y coordinate
+ * @param show_cursor 1 if the screen shows Primary Memory (no algorithm applied)
  * @return 0 on success, -1 on failure
  */
-int capture_mouse_area(int *corner1_x, int *corner1_y, int *corner2_x, int *corner2_y) {
-    Cursor current_cursor = {0, 0};
-    MouseEvent event;
-    int read_status;
+int capture_mouse_area(int *corner1_x, int *corner1_y, int *corner2_x, int *corner2_y,
+                       int show_cursor) {
+    MousePacket packet;
+    int result = 0;
     int corners_captured = 0;
+    Cursor shown = {-1, -1};
+    struct timeval last_print = {0, 0};
+    struct timeval batch_time;
+    int batch_open = 0;
+    long reads_before = mouse_reader.reads;
+    long events_before = mouse_reader.events;
+    long packets_before = mouse_reader.packets;
+    
+    mouse_reader.cursor.x = 0;
+    mouse_reader.cursor.y = 0;
     
     printf("\n=== CAPTURA DE AREA COM MOUSE ===\n");
     printf("Instrucoes:\n");
@@ -867,42 +2849,108 @@ int capture_mouse_area(int *corner1_x, int *corner1_y, int *corner2_x, int *corn
     printf("  - Botao DIREITO: Define o segundo canto\n");
     printf("  - Mova o mouse para posicionar o cursor\n\n");
     
+    /* Cursor na tela: so com a imagem da Primary Memory exibida e conhecida */
+    int cursor_on = show_cursor && overlay_begin() == 0;
+    if (cursor_on) {
+        overlay_cursor_move(mouse_reader.cursor.x, mouse_reader.cursor.y);
+        overlay_flush();
+    } else if (show_cursor) {
+        printf("AVISO: Conteudo da VRAM desconhecido; cursor apenas no terminal.\n");
+    }
+    
     while (corners_captured < 2) {
-        read_status = read_and_process_mouse_event(mouse_fd_global, &current_cursor, &event);
+        /* Mouse desconectado: aguarda outro ser conectado */
+        if (mouse_next(&packet, 1) < 0) {
+            printf("ERRO: Captura cancelada.\n");
+            result = -1;
+            break;
+        }
         
-        if (read_status < 0) {
-            printf("ERRO: Falha na leitura do mouse\n");
-            return -1;
-        } else if (read_status == 0) {
-            printf("ERRO: EOF ao ler mouse\n");
-            return -1;
-        } else if (read_status == 1) {
-            /* Display movement events */
-            if (event.event_type == EV_REL) {
-                printf("[MOVIMENTO] CursorXY: (%d, %d)\r", 
-                       event.cursor_pos.x, event.cursor_pos.y);
-                fflush(stdout);
-            }
-            /* Handle button press events */
-            else if (event.event_type == EV_KEY && event.event_value == 1) {
-                if (event.event_code == BTN_LEFT_CODE && corners_captured == 0) {
-                    *corner1_x = event.cursor_pos.x;
-                    *corner1_y = event.cursor_pos.y;
-                    printf("\n[CANTO 1] Capturado em (%d, %d)\n", *corner1_x, *corner1_y);
-                    printf("Agora clique com o botao DIREITO para o segundo canto...\n");
-                    corners_captured = 1;
-                }
-                else if (event.event_code == BTN_RIGHT_CODE && corners_captured == 1) {
-                    *corner2_x = event.cursor_pos.x;
-                    *corner2_y = event.cursor_pos.y;
-                    printf("[CANTO 2] Capturado em (%d, %d)\n", *corner2_x, *corner2_y);
-                    corners_captured = 2;
+        if (!batch_open) {
+            batch_time = packet.time;
+            batch_open = 1;
+        }
+        
+        /* Cursor e retangulo: redesenhar uma vez por lote de relatorios */
+        if (cursor_on && !mouse_reader_pending(&mouse_reader)) {
+            lat_begin(&batch_time);
+            batch_open = 0;
+            overlay_cursor_move(packet.cursor_pos.x, packet.cursor_pos.y);
+            if (corners_captured == 1) {
+                /* Mesma area que sera selecionada: inicio no menor canto, tamanho |c2 - c1| */
+                int bx = (packet.cursor_pos.x < *corner1_x) ? packet.cursor_pos.x : *corner1_x;
+                int by = (packet.cursor_pos.y < *corner1_y) ? packet.cursor_pos.y : *corner1_y;
+                int bw = abs(packet.cursor_pos.x - *corner1_x);
+                int bh = abs(packet.cursor_pos.y - *corner1_y);
+                if (bw == 0 || bh == 0) {
+                    overlay_band_hide();
+                } else {
+                    overlay_band_set(bx, by, bx + bw - 1, by + bh - 1);
                 }
             }
+            int flushed = overlay_flush();
+            if (flushed < 0) {
+                printf("\nAVISO: Falha ao desenhar o cursor; cursor desativado.\n");
+                overlay_end();
+                cursor_on = 0;
+            } else if (flushed == 0) {
+                lat_cancel();   /* Nada mudou na tela */
+            }
+        }
+        
+        /* Handle button press events */
+        if ((packet.pressed & MOUSE_BTN_LEFT) && corners_captured == 0) {
+            *corner1_x = packet.cursor_pos.x;
+            *corner1_y = packet.cursor_pos.y;
+            log_flush();
+            printf("\n[CANTO 1] Capturado em (%d, %d)\n", *corner1_x, *corner1_y);
+            printf("Agora clique com o botao DIREITO para o segundo canto...\n");
+            corners_captured = 1;
+        }
+        else if ((packet.pressed & MOUSE_BTN_RIGHT) && corners_captured == 1) {
+            *corner2_x = packet.cursor_pos.x;
+            *corner2_y = packet.cursor_pos.y;
+            log_flush();
+            printf("[CANTO 2] Capturado em (%d, %d)\n", *corner2_x, *corner2_y);
+            corners_captured = 2;
+        }
+        /* Display movement: only the last report of a batch, at most every MOUSE_PRINT_INTERVAL_MS */
+        else if (!mouse_reader_pending(&mouse_reader) &&
+                 (packet.cursor_pos.x != shown.x || packet.cursor_pos.y != shown.y)) {
+            long since_ms = (packet.time.tv_sec - last_print.tv_sec) * 1000L +
+                            (packet.time.tv_usec - last_print.tv_usec) / 1000L;
+            if (since_ms >= MOUSE_PRINT_INTERVAL_MS) {
+                LOG_INFO("[MOVIMENTO] CursorXY: (%d, %d)   \r",
+                         packet.cursor_pos.x, packet.cursor_pos.y);
+                shown = packet.cursor_pos;
+                last_print = packet.time;
+            }
         }
     }
     
+    /* Remover o cursor antes de qualquer leitura da VRAM pelo chamador */
+    long cursor_flushes = 0, cursor_stores = 0;
+    if (cursor_on) {
+        overlay_end();
+        overlay_stats(&cursor_flushes, &cursor_stores);
+    }
+    
+    log_flush();
+    if (result != 0) {
+        return result;
+    }
+    
     printf("\n>>> Area capturada com sucesso!\n");
+    printf("    Mouse: %ld eventos em %ld leituras, %ld relatorios\n",
+           mouse_reader.events - events_before, mouse_reader.reads - reads_before,
+           mouse_reader.packets - packets_before);
+    if (cursor_on) {
+        printf("    Cursor: %ld atualizacoes, %ld pixels escritos", cursor_flushes, cursor_stores);
+        if (cursor_flushes > 0) {
+            printf(" (%.1f por atualizacao)", (double)cursor_stores / cursor_flushes);
+        }
+        printf("\n");
+    }
     return 0;
 }
 
@@ -939,6 +2987,13 @@ void display_menu(int image_loaded, int image_sent_to_fpga, int zoom_level) {
     printf("\n--- Zoom por área ---\n");
 
     printf(" 8. Zoom Regional (selecionar area com mouse)\n");
+    printf(" 9. Lupa em tempo real (segue o mouse)\n");
+    printf("11. Picture-in-picture (varias janelas com zoom)\n");
+    printf("12. Zoom continuo 1x-8x (bilinear, teclas +/- ou roda do mouse)\n");
+    printf("13. Zoom global pela roda do mouse\n");
+    printf("14. Latencia entrada -> tela (histogramas)\n");
+    printf("15. Desfazer zoom global (sem FPGA)\n");
+    printf("16. Refazer zoom global (sem FPGA)\n");
    
     printf("\n----------------------------------------------------------\n");
     printf(" 0. Encerrar API e Sair\n");
@@ -948,45 +3003,465 @@ void display_menu(int image_loaded, int image_sent_to_fpga, int zoom_level) {
 
 /**
  * @brief Checks if window reading is allowed and determines memory to read
- * @param zoom_level Current zoom level
+ *
+ * The window is read from whichever memory the screen shows, as tracked
+ * by residency_utils (any zoom in/out chain, not only zoom-in).
  * @param mem_sel_out Output: Memory selector (0 or 1)
  * @return 1 if allowed, 0 if not allowed
  */
-int can_read_window(int zoom_level, int *mem_sel_out) {
-    /* Reading rules:
-     * 1. If zoom_level > 0: Zoom-in was applied, image is processed
-     *    -> Read from SECONDARY memory (mem_sel = 1)
-     * 2. If zoom_level <= 0: At initial state or zoom-out was applied
-     *    -> Read from PRIMARY memory (mem_sel = 0)
-     * 3. Reading is NOT allowed if zoom-out was applied without returning to initial state
-     */
-    
-    if (zoom_level < 0) {
-        /* Zoom-out was applied and not compensated */
-        printf("ERRO: Nao e possivel ler a janela no estado atual de zoom.\n");
-        printf("   A leitura so e permitida quando:\n");
-        printf("   - Nenhum algoritmo foi executado ainda (zoom_level = 0)\n");
-        printf("   - Algoritmos de zoom-in foram usados (zoom_level > 0)\n");
-        printf("   Nivel de zoom atual: %d\n", zoom_level);
+int can_read_window(int *mem_sel_out) {
+    char content[96];
+    int mem = res_screen_memory();
+    
+    if (mem < 0) {
+        /* Algorithm failed: the secondary memory holds nothing known */
+        printf("ERRO: Nao e possivel ler a janela: conteudo da tela indefinido.\n");
+        printf("   O ultimo algoritmo falhou. Use Reset (7) ou reenvie a imagem.\n");
+        return 0;
+    }
+    
+    *mem_sel_out = mem;
+    res_describe(mem, content, sizeof(content));
+    printf("   [INFO] Tela: %s. Lendo da memoria %s.\n", content,
+           (mem == RES_SECONDARY) ? "SECUNDARIA" : "PRIMARIA");
+    
+    return 1;
+}
+
+/* ===================================================================
+ * BATCH MODE
+ * =================================================================== */
+
+/**
+ * @brief Prints the command-line usage
+ */
+void batch_usage(const char *program) {
+    printf("Uso: %s                      (menu interativo)\n", program);
+    printf("     %s -f <script|->        (passos lidos de um arquivo ou do stdin)\n", program);
+    printf("     %s \"<passo>\" ...        (um passo por argumento)\n", program);
+    printf("     %s --record <arquivo>   (menu interativo, sessao gravada)\n", program);
+    printf("     %s --replay <arquivo> [--fast]\n", program);
+    printf("                               (reproduz a sessao em tempo real ou o mais rapido possivel)\n");
+    printf("\nAntes de qualquer modo: --rt [--rt-cpu <n>] [--rt-prio <1-99>]\n");
+    printf("                               (perfil de tempo real: nucleo %d, SCHED_FIFO %d por padrao)\n",
+           RT_DEFAULT_CPU, RT_DEFAULT_PRIORITY);
+    printf("                  --metrics [--metrics-tcp <porta>]\n");
+    printf("                               (metricas Prometheus em %s e em 127.0.0.1:<porta>)\n",
+           METRICS_SOCKET_PATH);
+    printf("                  --verify <1-100>\n");
+    printf("                               (confere essa fracao da VRAM apos cada envio de quadro)\n");
+    printf("                  --log <arquivo>\n");
+    printf("                               (linhas de estado em arquivo, com tempo e nivel)\n");
+    printf("\nPassos (um por linha; '#' inicia comentario):\n");
+    printf("  load <arquivo.bmp>           Carrega e envia um BMP %dx%d\n", IMG_WIDTH, IMG_HEIGHT);
+    printf("  gradient                     Gera e envia o gradiente de teste\n");
+    printf("  nearest | replicate          Zoom IN global (NearestNeighbor / PixelReplication)\n");
+    printf("  decimate | average           Zoom OUT global (Decimation / BlockAveraging)\n");
+    printf("  region <x> <y> <w> <h> [n]   Zoom regional da area ate o nivel n (padrao 1)\n");
+    printf("  readback <x> <y> <w> <h> [arquivo.bmp]\n");
+    printf("                               Le a janela da tela (imprime ou grava)\n");
+    printf("  save <arquivo.bmp>           Grava a tela inteira\n");
+    printf("  verify [percentual]          Confere a VRAM com o espelho (padrao 100%%)\n");
+    printf("  reset                        Reset do coprocessador\n");
+    printf("  undo | redo                  Quadro anterior/seguinte do zoom global (sem FPGA)\n");
+}
+
+/**
+ * @brief Parses integer arguments of a step
+ * @return 0 if all `count` words are integers, -1 otherwise
+ */
+int batch_ints(char **words, int count, int *out) {
+    for (int i = 0; i < count; i++) {
+        char *end;
+        long value = strtol(words[i], &end, 10);
+        if (end == words[i] || *end != '\0') {
+            printf("ERRO: '%s' nao e um numero.\n", words[i]);
+            return -1;
+        }
+        out[i] = (int)value;
+    }
+    return 0;
+}
+
+/**
+ * @brief Runs one global zoom step with the same checks as menu options 3-6
+ * @return 0 on success, -1 on failure
+ */
+int batch_global_zoom(BatchState *st, const char *algo_name, void (*algo_func)(void), int zoom_in) {
+    if (!st->image_sent_to_fpga) {
+        printf("ERRO: Nenhuma imagem na VRAM do FPGA (use load ou gradient).\n");
+        return -1;
+    }
+    
+    if (zoom_in && (st->zoom_level >= MAX_ZOOM_IN_LEVEL || ASM_Get_Flag_Max_Zoom() == 1)) {
+        printf("ERRO: Nivel maximo de Zoom IN atingido (nivel %d).\n", st->zoom_level);
+        return -1;
+    }
+    if (!zoom_in && (st->zoom_level <= MIN_ZOOM_OUT_LEVEL || ASM_Get_Flag_Min_Zoom() == 1)) {
+        printf("ERRO: Nivel minimo de Zoom OUT atingido (nivel %d).\n", st->zoom_level);
+        return -1;
+    }
+    
+    if (execute_algorithm(algo_name, algo_func) != 0) {
+        return -1;
+    }
+    st->zoom_level += zoom_in ? 1 : -1;
+    printf("   Nivel de zoom atual: %d\n", st->zoom_level);
+    history_record_screen(st->zoom_level);
+    return 0;
+}
+
+/**
+ * @brief Reads a window of the screen and prints it or saves it as BMP
+ * @return 0 on success, -1 on failure
+ */
+int batch_readback(BatchState *st, int x, int y, int width, int height, const char *filename) {
+    int mem_sel;
+    
+    if (!st->image_sent_to_fpga) {
+        printf("ERRO: Nenhuma imagem na VRAM do FPGA (use load ou gradient).\n");
+        return -1;
+    }
+    if (!can_read_window(&mem_sel)) {
+        return -1;
+    }
+    
+    uint8_t *window = (uint8_t*)malloc(width > 0 && height > 0 ? width * height : 1);
+    if (!window) {
+        printf("ERRO: Memoria insuficiente.\n");
+        return -1;
+    }
+    
+    int result = read_fpga_window(window, x, y, width, height, mem_sel);
+    if (result == 0) {
+        if (filename) {
+            result = save_bmp(filename, window, width, height);
+            if (result == 0) {
+                printf("   [C] Janela %dx%d gravada em '%s'.\n", width, height, filename);
+            }
+        } else {
+            print_matrix(window, width, height);
+        }
+    }
+    
+    free(window);
+    return result;
+}
+
+/**
+ * @brief Executes one script step and prints how long it took
+ * @param line Step text (modified: split into words)
+ * @return 1 if a step ran, 0 for a blank/comment line, -1 on failure
+ */
+int batch_step(BatchState *st, char *line) {
+    char text[BATCH_LINE_LEN];
+    char *words[BATCH_MAX_WORDS];
+    int count = 0;
+    int args[5];
+    struct timespec start, end;
+    
+    /* Comentario ate o fim da linha */
+    char *comment = strchr(line, '#');
+    if (comment) *comment = '\0';
+    
+    for (char *word = strtok(line, " \t\r\n"); word; word = strtok(NULL, " \t\r\n")) {
+        if (count == BATCH_MAX_WORDS) {
+            printf("ERRO: Passo com argumentos demais.\n");
+            return -1;
+        }
+        words[count++] = word;
+    }
+    if (count == 0) {
         return 0;
     }
     
-    /* Determine which memory to read */
-    if (zoom_level > 0) {
-        *mem_sel_out = 1; // Secondary memory (processed image)
-        printf("   [INFO] Imagem processada detectada. Lendo da memoria SECUNDARIA.\n");
+    /* Texto normalizado do passo, para o relatorio */
+    text[0] = '\0';
+    for (int i = 0; i < count; i++) {
+        if (i > 0) strncat(text, " ", sizeof(text) - strlen(text) - 1);
+        strncat(text, words[i], sizeof(text) - strlen(text) - 1);
+    }
+    
+    st->steps++;
+    printf("\n>>> [passo %d] %s\n", st->steps, text);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    
+    const char *cmd = words[0];
+    int nargs = count - 1;
+    int result = -1;
+    
+    if (strcmp(cmd, "load") == 0 && nargs == 1) {
+        if (load_bmp(words[1], st->image_data) == 0 && send_image_to_fpga(st->image_data) == 0) {
+            st->image_sent_to_fpga = 1;
+            st->zoom_level = 0;
+            history_clear(&zoom_history);
+            history_record_screen(st->zoom_level);
+            result = 0;
+        }
+    } else if (strcmp(cmd, "gradient") == 0 && nargs == 0) {
+        generate_test_pattern(st->image_data);
+        if (send_image_to_fpga(st->image_data) == 0) {
+            st->image_sent_to_fpga = 1;
+            st->zoom_level = 0;
+            history_clear(&zoom_history);
+            history_record_screen(st->zoom_level);
+            result = 0;
+        }
+    } else if (strcmp(cmd, "nearest") == 0 && nargs == 0) {
+        result = batch_global_zoom(st, "NearestNeighbor", &NearestNeighbor, 1);
+    } else if (strcmp(cmd, "replicate") == 0 && nargs == 0) {
+        result = batch_global_zoom(st, "PixelReplication", &PixelReplication, 1);
+    } else if (strcmp(cmd, "decimate") == 0 && nargs == 0) {
+        result = batch_global_zoom(st, "Decimation", &Decimation, 0);
+    } else if (strcmp(cmd, "average") == 0 && nargs == 0) {
+        result = batch_global_zoom(st, "BlockAveraging", &BlockAveraging, 0);
+    } else if (strcmp(cmd, "region") == 0 && (nargs == 4 || nargs == 5)) {
+        args[4] = 1;
+        if (batch_ints(words + 1, nargs, args) != 0) {
+            /* Erro ja impresso */
+        } else if (!st->image_sent_to_fpga) {
+            printf("ERRO: Nenhuma imagem na VRAM do FPGA (use load ou gradient).\n");
+        } else if (args[4] < 0 || args[4] > MAX_REGIONAL_ZOOM_LEVELS - 1) {
+            printf("ERRO: Nivel regional deve estar entre 0 e %d.\n", MAX_REGIONAL_ZOOM_LEVELS - 1);
+        } else {
+            RegionalZoomContext ctx;
+            if (regional_zoom_init(&ctx, args[0], args[1], args[2], args[3], st->zoom_level) == 0) {
+                result = regional_zoom_to(&ctx, st->zoom_level, args[4]);
+                regional_zoom_cleanup(&ctx);
+                
+                /* A tela (base + regiao) agora esta na Primary Memory */
+                if (result == 0) {
+                    st->zoom_level = 0;
+                    history_record_screen(st->zoom_level);
+                }
+            }
+        }
+    } else if (strcmp(cmd, "readback") == 0 && (nargs == 4 || nargs == 5)) {
+        if (batch_ints(words + 1, 4, args) == 0) {
+            result = batch_readback(st, args[0], args[1], args[2], args[3],
+                                    (nargs == 5) ? words[5] : NULL);
+        }
+    } else if (strcmp(cmd, "save") == 0 && nargs == 1) {
+        result = batch_readback(st, 0, 0, IMG_WIDTH, IMG_HEIGHT, words[1]);
+    } else if (strcmp(cmd, "verify") == 0 && nargs <= 1) {
+        args[0] = 100;
+        if (nargs == 0 || batch_ints(words + 1, 1, args) == 0) {
+            VerifyReport report;
+            int bad = verify_primary(args[0], &report);
+            if (bad >= 0) {
+                verify_print(&report);
+            }
+            result = (bad == 0) ? 0 : -1;
+        }
+    } else if (strcmp(cmd, "reset") == 0 && nargs == 0) {
+        cmd_reset(1);
+        st->zoom_level = 0;
+        if (st->image_sent_to_fpga) {
+            history_record_screen(st->zoom_level);
+        }
+        result = 0;
+    } else if ((strcmp(cmd, "undo") == 0 || strcmp(cmd, "redo") == 0) && nargs == 0) {
+        if (!st->image_sent_to_fpga) {
+            printf("ERRO: Nenhuma imagem na VRAM do FPGA (use load ou gradient).\n");
+        } else {
+            result = history_show((cmd[0] == 'u') ? -1 : 1, &st->zoom_level);
+        }
     } else {
-        *mem_sel_out = 0; // Primary memory (original image)
-        printf("   [INFO] Imagem original. Lendo da memoria PRIMARIA.\n");
+        printf("ERRO: Passo invalido ou com argumentos errados: '%s'\n", text);
     }
     
-    return 1;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double ms = elapsed_ms(&start, &end);
+    st->total_ms += ms;
+    printf("<<< [passo %d] %-28s %s  %10.3f ms\n", st->steps, text,
+           (result == 0) ? "OK  " : "FALHA", ms);
+    
+    return (result == 0) ? 1 : -1;
+}
+
+/**
+ * @brief Non-interactive mode: runs the steps from a script or argv
+ *
+ * No mouse or menu: the steps run in order and the first failure stops
+ * the script. Each step prints its wall-clock time.
+ * @return Process exit status (0 = every step succeeded)
+ */
+int batch_main(int argc, char **argv) {
+    BatchState st = {0};
+    FILE *script = NULL;
+    char line[BATCH_LINE_LEN];
+    int status = 0;
+    
+    if (strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0) {
+        batch_usage(argv[0]);
+        return 0;
+    }
+    
+    if (strcmp(argv[1], "-f") == 0) {
+        if (argc != 3) {
+            batch_usage(argv[0]);
+            return 2;
+        }
+        script = (strcmp(argv[2], "-") == 0) ? stdin : fopen(argv[2], "r");
+        if (!script) {
+            printf("ERRO: Nao foi possivel abrir o script '%s'.\n", argv[2]);
+            return 2;
+        }
+    }
+    
+    st.image_data = malloc(IMG_WIDTH * IMG_HEIGHT);
+    if (!st.image_data) {
+        printf("ERRO FATAL: Nao foi possivel alocar memoria para a imagem!\n");
+        if (script && script != stdin) fclose(script);
+        return 1;
+    }
+    
+    printf("=== MODO LOTE ===\n");
+    volatile void *init_result = API_initialize();
+    if (init_result == (void*)-1 || init_result == (void*)-2) {
+        printf("ERRO FATAL: API_initialize falhou. Verifique o sudo e o mmap.\n");
+        free(st.image_data);
+        if (script && script != stdin) fclose(script);
+        return 1;
+    }
+    
+    /* Laco de eventos so para as esperas do coprocessador (sem stdin: pode ser o script) */
+    if (ev_init(&main_loop) != 0) {
+        printf("ERRO FATAL: Nao foi possivel criar o laco de eventos (epoll).\n");
+        API_close();
+        free(st.image_data);
+        if (script && script != stdin) fclose(script);
+        return 1;
+    }
+    
+    if (metrics_enabled) {
+        metrics_start(&main_loop, NULL, metrics_tcp_port);
+    }
+    
+    cmd_reset(1);
+    timing_calibrate();
+    timing_dump();
+    if (rt_requested()) {
+        rt_prefault(st.image_data, IMG_WIDTH * IMG_HEIGHT);
+        rt_start();
+        rt_dump();
+    }
+    history_init(&zoom_history, 0);
+    
+    if (script) {
+        int line_no = 0;
+        while (status == 0 && fgets(line, sizeof(line), script)) {
+            line_no++;
+            if (batch_step(&st, line) < 0) {
+                printf("ERRO: Script interrompido na linha %d.\n", line_no);
+                status = 1;
+            }
+        }
+        if (script != stdin) fclose(script);
+    } else {
+        for (int i = 1; status == 0 && i < argc; i++) {
+            snprintf(line, sizeof(line), "%s", argv[i]);
+            if (batch_step(&st, line) < 0) {
+                printf("ERRO: Execucao interrompida no argumento %d.\n", i);
+                status = 1;
+            }
+        }
+    }
+    
+    printf("\n=== MODO LOTE: %d passo(s), %.3f ms no total%s ===\n",
+           st.steps, st.total_ms, status ? ", COM FALHA" : "");
+    cmd_dump();
+    res_dump();
+    if (rt_requested()) {
+        rt_dump();
+    }
+    log_dump();
+    verify_dump();
+    history_dump(&zoom_history);
+    history_clear(&zoom_history);
+    
+    metrics_stop(&main_loop);
+    ev_close(&main_loop);
+    API_close();
+    free(st.image_data);
+    return status;
 }
 
 /* ===================================================================
  * MAIN PROGRAM
  * =================================================================== */
-int main(void) {
+int main(int argc, char **argv) {
+    /* Real-time profile, metrics, verification and log options come first; argv[0] is kept for the usage text */
+    int rt_on = 0, rt_cpu = -1, rt_priority = 0;
+    const char *log_path = NULL;
+    while (argc > 1) {
+        if (strcmp(argv[1], "--rt") == 0) {
+            rt_on = 1;
+            argv[1] = argv[0];
+            argv++;
+            argc--;
+        } else if (strcmp(argv[1], "--metrics") == 0) {
+            metrics_enabled = 1;
+            argv[1] = argv[0];
+            argv++;
+            argc--;
+        } else if (argc > 2 && strcmp(argv[1], "--metrics-tcp") == 0) {
+            metrics_enabled = 1;
+            metrics_tcp_port = atoi(argv[2]);
+            argv[2] = argv[0];
+            argv += 2;
+            argc -= 2;
+        } else if (argc > 2 && strcmp(argv[1], "--verify") == 0) {
+            char *end;
+            long percent = strtol(argv[2], &end, 10);
+            if (end == argv[2] || *end != '\0' || percent < 1 || percent > 100) {
+                printf("ERRO: --verify espera um percentual de 1 a 100 (recebido '%s').\n", argv[2]);
+                return 2;
+            }
+            cmd_set_verify((int)percent);
+            argv[2] = argv[0];
+            argv += 2;
+            argc -= 2;
+        } else if (argc > 2 && strcmp(argv[1], "--log") == 0) {
+            log_path = argv[2];
+            argv[2] = argv[0];
+            argv += 2;
+            argc -= 2;
+        } else if (argc > 2 && (strcmp(argv[1], "--rt-cpu") == 0 || strcmp(argv[1], "--rt-prio") == 0)) {
+            rt_on = 1;
+            if (strcmp(argv[1], "--rt-cpu") == 0) {
+                rt_cpu = atoi(argv[2]);
+            } else {
+                rt_priority = atoi(argv[2]);
+            }
+            argv[2] = argv[0];
+            argv += 2;
+            argc -= 2;
+        } else {
+            break;
+        }
+    }
+    if (rt_on) {
+        rt_request(rt_cpu, rt_priority);
+    }
+    
+    /* Status lines of the hot loops go through the asynchronous log */
+    log_init(log_path, LOG_LEVEL_MAX);
+    
+    /* Session recording or replay; any other arguments are batch steps */
+    if (argc == 3 && strcmp(argv[1], "--record") == 0) {
+        if (session_record_open(argv[2]) != 0) {
+            return 2;
+        }
+    } else if ((argc == 3 || argc == 4) && strcmp(argv[1], "--replay") == 0) {
+        int realtime = !(argc == 4 && strcmp(argv[3], "--fast") == 0);
+        if (session_replay_open(argv[2], realtime) != 0) {
+            return 2;
+        }
+    } else if (argc > 1) {
+        return batch_main(argc, argv);
+    }
+    
     /* System state variables */
     int image_loaded_in_memory = 0;
     int image_sent_to_fpga = 0;
@@ -994,10 +3469,8 @@ int main(void) {
    
     int option;
     char filename[256];
+    char line[64];
     
-    /* Mouse variables */
-    char device_path[MAX_PATH_LEN] = {0};
-    char device_name[MAX_PATH_LEN] = {0};
 
     /* Allocate image buffer */
     uint8_t *image_data = malloc(IMG_WIDTH * IMG_HEIGHT);
@@ -1020,31 +3493,54 @@ int main(void) {
     }
     
     printf(">>> API inicializada com sucesso.\n");
+    history_init(&zoom_history, 0);
+    
+    /* Event loop: stdin now (not read during a replay), mouse once it is opened */
+    if (ev_init(&main_loop) != 0 ||
+        (session_mode() != SESSION_REPLAY &&
+         (menu_input.source_id = ev_add_fd(&main_loop, STDIN_FILENO, EPOLLIN,
+                                           on_stdin_ready, &menu_input)) < 0)) {
+        printf("ERRO FATAL: Nao foi possivel criar o laco de eventos (epoll).\n");
+        API_close();
+        free(image_data);
+        return -1;
+    }
+    if (metrics_enabled) {
+        metrics_start(&main_loop, NULL, metrics_tcp_port);
+    }
     
     /* Reset FPGA to ensure clean state */
     printf("Executando reset inicial do FPGA...\n");
-    ASM_Reset();
-    ASM_Pulse_Enable();
-    usleep(PULSE_DELAY_US);
-    
-    printf(">>> Sistema inicializado e pronto para uso.\n");
+    cmd_reset(1);
     
-    /* Initialize mouse device */
-    printf("\nInicializando dispositivo de mouse...\n");
-    mouse_fd_global = find_and_open_mouse(device_path, device_name);
+    printf("Calibrando os tempos do driver...\n");
+    if (timing_calibrate() != 0) {
+        printf("!!! AVISO: calibracao falhou; usando os tempos padrao do driver.\n");
+    }
+    timing_dump();
     
-    if (mouse_fd_global < 0) {
-        if (errno == EACCES) {
-            printf("!!! AVISO: Permissao negada para mouse. Execute como root (sudo).\n");
-            printf("    A funcionalidade de selecao com mouse estara desabilitada.\n");
-        } else {
-            printf("!!! AVISO: Nao foi possivel encontrar/abrir um mouse valido.\n");
-            printf("    A funcionalidade de selecao com mouse estara desabilitada.\n");
+    if (rt_requested()) {
+        printf("Aplicando o perfil de tempo real (medicoes antes e depois)...\n");
+        rt_prefault(image_data, IMG_WIDTH * IMG_HEIGHT);
+        if (rt_start() != 0) {
+            printf("!!! AVISO: perfil de tempo real aplicado apenas em parte.\n");
         }
+        rt_dump();
+    }
+    
+    printf(">>> Sistema inicializado e pronto para uso.\n");
+    
+    /* Mouse: hotplug watcher now, first scan from the event loop (off the startup path).
+     * A replay takes the mouse from the recording instead. */
+    if (session_mode() == SESSION_REPLAY) {
+        printf(">>> Reproducao: mouse e teclado vem da gravacao.\n");
+    } else if (mouse_hotplug_init(&mouse_hotplug) == 0) {
+        ev_add_fd(&main_loop, mouse_hotplug.fd, EPOLLIN, on_hotplug_ready, NULL);
     } else {
-        printf(">>> Mouse inicializado com sucesso:\n");
-        printf("    Caminho: %s\n", device_path);
-        printf("    Nome: %s\n", device_name);
+        printf("!!! AVISO: inotify indisponivel; mouse conectado depois nao sera detectado.\n");
+    }
+    if (session_mode() != SESSION_REPLAY) {
+        ev_add_timer(&main_loop, 1, 0, on_initial_probe, NULL);
     }
     
     wait_for_enter();
@@ -1055,8 +3551,9 @@ int main(void) {
     while (1) {
         display_menu(image_loaded_in_memory, image_sent_to_fpga, zoom_level);
        
-        if (scanf("%d", &option) != 1) {
-            clear_input_buffer();
+        if (menu_read_line(line, sizeof(line)) != 0) {
+            option = 0;     /* EOF on stdin: exit */
+        } else if (sscanf(line, "%d", &option) != 1) {
             printf("Erro: Entrada invalida. Por favor, digite um numero.\n");
             wait_for_enter();
             continue;
@@ -1064,12 +3561,13 @@ int main(void) {
 
         printf("\n");
 
+        session_op_begin(SES_OP_MENU);
         switch (option) {
             /* ==================== LOAD BMP IMAGE ==================== */
             case 1: {
                 printf("=== CARREGANDO IMAGEM BMP ===\n");
                 printf("Digite o nome do arquivo BMP: ");
-                scanf("%255s", filename);
+                menu_read_line(filename, sizeof(filename));
                
                 if (load_bmp(filename, image_data) == 0) {
                     printf(">>> SUCESSO: Imagem BMP carregada no buffer C.\n");
@@ -1087,6 +3585,8 @@ int main(void) {
                         printf(">>> SUCESSO: Imagem enviada para a VRAM do FPGA.\n");
                         image_sent_to_fpga = 1;
                         zoom_level = 0;
+                        history_clear(&zoom_history);
+                        history_record_screen(zoom_level);
                     } else {
                         printf("ERRO FATAL: Falha ao enviar imagem para o FPGA.\n");
                         goto cleanup_error;
@@ -1116,6 +3616,8 @@ int main(void) {
                     printf(">>> SUCESSO: Imagem enviada para a VRAM do FPGA.\n");
                     image_sent_to_fpga = 1;
                     zoom_level = 0;
+                    history_clear(&zoom_history);
+                    history_record_screen(zoom_level);
                 } else {
                     printf("ERRO FATAL: Falha ao enviar imagem para o FPGA.\n");
                     goto cleanup_error;
@@ -1130,14 +3632,14 @@ int main(void) {
                     break;
                 }
                 
-                if (mouse_fd_global < 0) {
+                if (!mouse_available()) {
                     printf("ERRO: Mouse nao inicializado. Execute o programa com sudo.\n");
                     break;
                 }
 
                 /* Check if reading is allowed and determine memory selector */
                 int mem_sel;
-                if (!can_read_window(zoom_level, &mem_sel)) {
+                if (!can_read_window(&mem_sel)) {
                     break;
                 }
 
@@ -1145,7 +3647,8 @@ int main(void) {
                
                 /* Capture area with mouse */
                 int corner1_x, corner1_y, corner2_x, corner2_y;
-                if (capture_mouse_area(&corner1_x, &corner1_y, &corner2_x, &corner2_y) != 0) {
+                if (capture_mouse_area(&corner1_x, &corner1_y, &corner2_x, &corner2_y,
+                                       res_screen_memory() == RES_PRIMARY) != 0) {
                     printf("ERRO: Falha na captura da area com o mouse.\n");
                     break;
                 }
@@ -1218,6 +3721,7 @@ int main(void) {
                 }
                
                 printf("=== EXECUTANDO ALGORITMO (Zoom IN) ===\n");
+                lat_begin(&menu_input.time);
                 int result;
                 if (option == 3) {
                     result = execute_algorithm("NearestNeighbor", &NearestNeighbor);
@@ -1226,11 +3730,13 @@ int main(void) {
                 }
                
                 if (result == 0) {
+                    lat_refresh();      /* Saida exibida ao concluir o algoritmo */
                     zoom_level++;
                     printf("   Nivel de zoom atual: %d\n", zoom_level);
+                    history_record_screen(zoom_level);
                 } else {
-                    printf("ERRO FATAL: Falha na execucao do algoritmo.\n");
-                    goto cleanup_error;
+                    /* Imagem e caches preservados; Reset (7) ou Desfazer (15) seguem validos */
+                    printf("ERRO: Falha na execucao do algoritmo (recuperacao sem sucesso).\n");
                 }
                 break;
             }
@@ -1261,6 +3767,7 @@ int main(void) {
                 }
 
                 printf("=== EXECUTANDO ALGORITMO (Zoom OUT) ===\n");
+                lat_begin(&menu_input.time);
                 int result;
                 if (option == 5) {
                     result = execute_algorithm("Decimation", &Decimation);
@@ -1269,11 +3776,13 @@ int main(void) {
                 }
                
                 if (result == 0) {
+                    lat_refresh();      /* Saida exibida ao concluir o algoritmo */
                     zoom_level--;
                     printf("   Nivel de zoom atual: %d\n", zoom_level);
+                    history_record_screen(zoom_level);
                 } else {
-                    printf("ERRO FATAL: Falha na execucao do algoritmo.\n");
-                    goto cleanup_error;
+                    /* Imagem e caches preservados; Reset (7) ou Desfazer (15) seguem validos */
+                    printf("ERRO: Falha na execucao do algoritmo (recuperacao sem sucesso).\n");
                 }
                 break;
             }
@@ -1281,10 +3790,11 @@ int main(void) {
             /* ==================== RESET ==================== */
             case 7: {
                 printf("=== EXECUTANDO: RESET ===\n");
-                ASM_Reset();
+                cmd_reset(1);
                 zoom_level = 0;
-                ASM_Pulse_Enable();
-                usleep(PULSE_DELAY_US);
+                if (image_sent_to_fpga) {
+                    history_record_screen(zoom_level);
+                }
                 printf("   [C] Reset concluido. Flags zeradas.\n");
                 printf("   Nivel de zoom resetado para: %d\n", zoom_level);
                 break;
@@ -1296,20 +3806,11 @@ int main(void) {
                     break;
                 }
                 
-                if (mouse_fd_global < 0) {
+                if (!mouse_available()) {
                     printf("ERRO: Mouse nao inicializado.\n");
                     break;
                 }
                 
-                /* Validação: zoom regional só funciona com zoom_level >= 0 */
-                if (zoom_level < 0) {
-                    printf("\n=== ZOOM REGIONAL BLOQUEADO ===\n");
-                    printf("ERRO: Zoom Regional nao permitido com zoom-out aplicado.\n");
-                    printf("       Nivel de zoom atual: %d\n", zoom_level);
-                    printf("\nSolucao: Use 'Reset' (opcao 7) ou aplique zoom-in (opcoes 3 ou 4)\n");
-                    break;
-                }
-                
                 RegionalZoomContext regional_ctx;
                 
                 /* Passar zoom_level para regional_zoom_start */
@@ -1317,6 +3818,7 @@ int main(void) {
                     break;
                 
                 int regional_loop = 1;
+                key_session_begin(1);
                 while (regional_loop) {
                     printf("\n\n=== MENU ZOOM REGIONAL ===\n");
                     printf("Zoom Global: %d | Regional: %d/%d\n",
@@ -1341,11 +3843,12 @@ int main(void) {
                     }
                     printf("]\n");
                     
-                    printf("Controles:\n [+] Zoom IN\n [-] Zoom OUT\n [0] Voltar (ou ESC)\n");
+                    printf("Controles:\n [+] Zoom IN\n [-] Zoom OUT\n [Roda do mouse] Zoom IN/OUT\n [P] Pan (arrastar com mouse)\n [0] Voltar (ou ESC)\n");
                     printf("Aguardando comando... ");
-                    fflush(stdout);
                     
-                    char key = read_key_direct();
+                    /* Tecla mantida: so o ultimo pedido de zoom acumulado e atendido */
+                    int key = key_coalesce_zoom(key_next());
+                    lat_begin(&key_session.key_time);
                     
                     switch (key) {
                         case ZOOM_IN:
@@ -1359,6 +3862,21 @@ int main(void) {
                             regional_zoom_apply(&regional_ctx, image_data, zoom_level, ZOOM_OUT);
                             break;
                         
+                        case KEY_WHEEL: {
+                            /* Giros acumulados viram um unico nivel alvo */
+                            int target = regional_ctx.zoom_level + key_take_wheel();
+                            lat_begin(&key_session.key_time);
+                            printf("\n=== ZOOM PELA RODA: nivel %d -> %d ===\n",
+                                   regional_ctx.zoom_level, target);
+                            regional_zoom_to(&regional_ctx, zoom_level, target);
+                            break;
+                        }
+                        
+                        case 'p':
+                        case 'P':
+                            regional_zoom_pan(&regional_ctx);
+                            break;
+                        
                         case '0':
                         case 27: // ESC
                             regional_loop = 0;
@@ -1368,33 +3886,138 @@ int main(void) {
                             printf("\nComando invalido: '%c'\n", key);
                             break;
                     }
+                    
+                    /* Tecla que nao gerou atualizacao: nada a medir */
+                    lat_cancel();
                 }
                 
+                key_session_end();
+                
                 /* RESTAURAR IMAGEM ORIGINAL AO SAIR */
                 printf("\n=== SAINDO DO ZOOM REGIONAL ===\n");
                 printf("Restaurando imagem original...\n");
                 
-                ASM_Reset();
+                /* Ja resetado e com a base na VRAM quando nada mudou: a camada
+                 * de comandos so envia o que difere */
+                cmd_reset(0);
                 zoom_level = 0;
-                ASM_Pulse_Enable();
-                usleep(PULSE_DELAY_US);
                 
                 /* Reenviar a imagem original do buffer (image_data) */
-                for (int addr = 0; addr < IMG_WIDTH * IMG_HEIGHT; addr++) {
-                    ASM_Store(addr, image_data[addr], 0);
-                }
-                
-                ASM_Refresh();
-                usleep(REFRESH_DELAY_US);
+                cmd_upload_frame(image_data);
+                cmd_refresh();
                 
                 printf(">>> Imagem original restaurada!\n");
                 
                 /* Cleanup buffers */
                 regional_zoom_cleanup(&regional_ctx);
-                ASM_Reset();
+                cmd_reset(0);
+                history_record_screen(zoom_level);
+                break;
+            }
+
+
+            /* ==================== MAGNIFIER LENS ==================== */
+            case 9:
+            /* ==================== PICTURE-IN-PICTURE ==================== */
+            case 11:
+            /* ==================== CONTINUOUS ZOOM ==================== */
+            case 12: {
+                if (!image_sent_to_fpga) {
+                    printf("ERRO: Carregue uma imagem primeiro.\n");
+                    break;
+                }
+                
+                if (option == 9 && !mouse_available()) {
+                    printf("ERRO: Mouse nao inicializado.\n");
+                    break;
+                }
+                
+                uint8_t *screen = acquire_display_frame(image_data);
+                if (!screen) {
+                    printf("ERRO: Memoria insuficiente ou conteudo da tela indefinido.\n");
+                    break;
+                }
+                
+                if (option == 9) {
+                    magnifier_lens(screen);
+                } else if (option == 11) {
+                    pip_session(screen);
+                } else {
+                    printf("Alvo do zoom continuo: [F] Quadro inteiro  [R] Regiao (mouse): ");
+                    key_session_begin(0);
+                    int target = key_next();
+                    key_session_end();
+                    int c1x = 0, c1y = 0, c2x = IMG_WIDTH, c2y = IMG_HEIGHT;
+                    if ((target == 'r' || target == 'R') &&
+                        (!mouse_available() ||
+                         capture_mouse_area(&c1x, &c1y, &c2x, &c2y, screen == image_data) != 0)) {
+                        printf("\nERRO: Falha na captura da area com o mouse.\n");
+                    } else if (c1x == c2x || c1y == c2y) {
+                        printf("\nERRO: Area selecionada e vazia.\n");
+                    } else {
+                        continuous_zoom(screen, (c1x < c2x) ? c1x : c2x, (c1y < c2y) ? c1y : c2y,
+                                        abs(c2x - c1x), abs(c2y - c1y));
+                    }
+                }
+                
+                release_display_frame(screen, image_data, &zoom_level);
+                break;
+            }
+
+            /* ==================== GLOBAL WHEEL ZOOM ==================== */
+            case 13: {
+                if (!image_sent_to_fpga) {
+                    printf("ERRO: Carregue uma imagem primeiro.\n");
+                    break;
+                }
+                
+                if (zoom_level < 0) {
+                    printf("ERRO: Zoom pela roda parte de nivel >= 0 (atual %d). Use Reset (7).\n", zoom_level);
+                    break;
+                }
+                
+                if (wheel_zoom_session(image_data, &zoom_level) != 0) {
+                    printf("ERRO: Falha na execucao do algoritmo (recuperacao sem sucesso).\n");
+                    break;
+                }
+                history_record_screen(zoom_level);
+                break;
+            }
+
+            /* ==================== LATENCY REPORT ==================== */
+            case 14: {
+                lat_dump();
+                cmd_dump();
+                res_dump();
+                if (rt_requested()) {
+                    rt_dump();
+                }
+                log_dump();
+                verify_dump();
+                printf("\nDigite Z para zerar os histogramas ou Enter para continuar: ");
+                if (menu_read_line(line, sizeof(line)) == 0 && (line[0] == 'z' || line[0] == 'Z')) {
+                    lat_reset();
+                    cmd_stats_clear();
+                    res_stats_clear();
+                    printf("Histogramas zerados.\n");
+                }
                 break;
             }
 
+            /* ==================== GLOBAL ZOOM UNDO / REDO ==================== */
+            case 15:
+            case 16: {
+                if (!image_sent_to_fpga) {
+                    printf("ERRO: Carregue uma imagem primeiro.\n");
+                    break;
+                }
+                
+                lat_begin(&menu_input.time);
+                history_show((option == 15) ? -1 : 1, &zoom_level);
+                history_dump(&zoom_history);
+                printf("   Nivel de zoom atual: %d\n", zoom_level);
+                break;
+            }
 
             /* ==================== EXIT ==================== */
             case 0: {
@@ -1406,6 +4029,11 @@ int main(void) {
                     printf("Mouse fechado.\n");
                 }
                 
+                mouse_hotplug_close(&mouse_hotplug);
+                metrics_stop(&main_loop);
+                ev_close(&main_loop);
+                session_close();
+                history_clear(&zoom_history);
                 printf("Encerrando API...\n");
                 API_close();
                 free(image_data);
@@ -1417,6 +4045,7 @@ int main(void) {
                 printf("ERRO: Opcao invalida. Tente novamente.\n");
                 break;
         }
+        session_op_end(SES_OP_MENU, option);
 
         wait_for_enter();
     }
@@ -1426,6 +4055,11 @@ cleanup_error:
     if (mouse_fd_global >= 0) {
         close(mouse_fd_global);
     }
+    mouse_hotplug_close(&mouse_hotplug);
+    metrics_stop(&main_loop);
+    ev_close(&main_loop);
+    session_close();
+    history_clear(&zoom_history);
     API_close();
     free(image_data);
     return -1;
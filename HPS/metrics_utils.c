@@ -0,0 +1,386 @@
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "api.h"
+#include "event_loop.h"
+#include "metrics_utils.h"
+
+#define RESPONSE_MAX 16384
+
+Metrics metrics;
+
+/* Limites dos baldes de duração (microssegundos) */
+static const int64_t op_bounds_us[METRICS_OP_BUCKETS] = {
+    100, 1000, 5000, 10000, 50000, 100000, 500000, 1000000, 5000000
+};
+
+static const char *op_names[METRICS_OPS] = {
+    "menu", "algorithm", "upload", "regional", "wheel", "readback"
+};
+static const char *alg_names[METRICS_ALG_OPS] = { "unknown", "NN", "PR", "DEC", "BA" };
+static const char *alg_results[MET_ALG_RESULTS] = { "ok", "error", "timeout" };
+
+/* Sockets abertos */
+static int unix_fd = -1, tcp_fd = -1;
+static int unix_id = -1, tcp_id = -1;
+static char unix_path_open[sizeof(((struct sockaddr_un*)0)->sun_path)];
+
+typedef struct {
+    int fd;
+    int id;
+} MetricsClient;
+
+static MetricsClient clients[METRICS_MAX_CLIENTS] = {
+    { -1, -1 }, { -1, -1 }, { -1, -1 }, { -1, -1 }
+};
+
+/* Resposta em montagem */
+static char response[RESPONSE_MAX];
+static int response_len;
+
+/* Coleta anterior, para os bytes por segundo */
+static int64_t prev_scrape_ns;
+static uint64_t prev_stored, prev_loaded;
+
+
+/*
+ * --- FUNÇÕES INTERNAS ---
+ */
+
+static uint64_t load64(const uint64_t *value) {
+    return __atomic_load_n(value, __ATOMIC_RELAXED);
+}
+
+static int64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void out(const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    int len = vsnprintf(response + response_len, RESPONSE_MAX - response_len, fmt, args);
+    va_end(args);
+    if (len > 0) {
+        response_len += len;
+        if (response_len >= RESPONSE_MAX) {
+            response_len = RESPONSE_MAX - 1;
+        }
+    }
+}
+
+static void header(const char *name, const char *type, const char *help) {
+    out("# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+static void counter(const char *name, const char *help, uint64_t value) {
+    header(name, "counter", help);
+    out("%s %llu\n", name, (unsigned long long)value);
+}
+
+// Contadores do driver: os acumulados mais os atuais de lib.s
+static void driver_totals(uint64_t totals[8]) {
+    DriverStats st;
+    ASM_Get_Stats(&st);
+    const unsigned int current[8] = {
+        st.stores, st.loads, st.timeouts, st.hw_errors,
+        st.invalid_addr, st.retries, st.worst_spin, st.total_spin
+    };
+    for (int i = 0; i < 8; i++) {
+        totals[i] = load64(&metrics.driver[i]) + current[i];
+    }
+    // O pior caso não se soma
+    uint64_t worst = load64(&metrics.driver[6]);
+    totals[6] = (worst > current[6]) ? worst : current[6];
+}
+
+static void build_metrics(void) {
+    uint64_t drv[8];
+    const uint64_t *c = metrics.counters;
+
+    response_len = 0;
+    driver_totals(drv);
+
+    counter("pbl_pixels_stored_total", "Pixels escritos na VRAM (ASM_Store)", drv[0]);
+    counter("pbl_pixels_loaded_total", "Pixels lidos do barramento (ASM_Load)", drv[1]);
+    counter("pbl_driver_timeouts_total", "Operacoes sem FLAG_DONE mesmo apos a nova tentativa", drv[2]);
+    counter("pbl_driver_hw_errors_total", "Operacoes concluidas com FLAG_ERROR", drv[3]);
+    counter("pbl_driver_invalid_address_total", "Enderecos fora da imagem", drv[4]);
+    counter("pbl_driver_retries_total", "Pacotes repetidos apos um primeiro timeout", drv[5]);
+    header("pbl_driver_worst_polls", "gauge", "Maior numero de leituras de flags ate FLAG_DONE");
+    out("pbl_driver_worst_polls %llu\n", (unsigned long long)drv[6]);
+
+    // Vazão desde a coleta anterior (1 byte por pixel)
+    int64_t now = now_ns();
+    double store_rate = 0, load_rate = 0;
+    if (prev_scrape_ns != 0 && now > prev_scrape_ns) {
+        double seconds = (now - prev_scrape_ns) / 1e9;
+        store_rate = (drv[0] >= prev_stored) ? (drv[0] - prev_stored) / seconds : 0;
+        load_rate = (drv[1] >= prev_loaded) ? (drv[1] - prev_loaded) / seconds : 0;
+    }
+    prev_scrape_ns = now;
+    prev_stored = drv[0];
+    prev_loaded = drv[1];
+    header("pbl_bytes_per_second", "gauge", "Vazao do barramento desde a coleta anterior");
+    out("pbl_bytes_per_second{dir=\"store\"} %.1f\n", store_rate);
+    out("pbl_bytes_per_second{dir=\"load\"} %.1f\n", load_rate);
+
+    header("pbl_algorithm_runs_total", "counter", "Algoritmos executados por opcode e resultado");
+    for (int op = 0; op < METRICS_ALG_OPS; op++) {
+        for (int r = 0; r < MET_ALG_RESULTS; r++) {
+            out("pbl_algorithm_runs_total{op=\"%s\",result=\"%s\"} %llu\n", alg_names[op], alg_results[r],
+                (unsigned long long)load64(&metrics.algorithms[op][r]));
+        }
+    }
+
+    header("pbl_commands_total", "counter", "Comandos enviados ao coprocessador ou descartados");
+    out("pbl_commands_total{cmd=\"reset\",action=\"sent\"} %llu\n", (unsigned long long)load64(&c[MET_RESET_SENT]));
+    out("pbl_commands_total{cmd=\"reset\",action=\"elided\"} %llu\n", (unsigned long long)load64(&c[MET_RESET_ELIDED]));
+    out("pbl_commands_total{cmd=\"refresh\",action=\"sent\"} %llu\n", (unsigned long long)load64(&c[MET_REFRESH_SENT]));
+    out("pbl_commands_total{cmd=\"refresh\",action=\"elided\"} %llu\n", (unsigned long long)load64(&c[MET_REFRESH_ELIDED]));
+    out("pbl_commands_total{cmd=\"upload\",action=\"sent\"} %llu\n", (unsigned long long)load64(&c[MET_UPLOAD_SENT]));
+    out("pbl_commands_total{cmd=\"upload\",action=\"elided\"} %llu\n", (unsigned long long)load64(&c[MET_UPLOAD_ELIDED]));
+
+    header("pbl_upload_pixels_total", "counter", "Pixels de quadros enviados: escritos ou iguais a VRAM");
+    out("pbl_upload_pixels_total{action=\"sent\"} %llu\n", (unsigned long long)load64(&c[MET_UPLOAD_PIXELS_SENT]));
+    out("pbl_upload_pixels_total{action=\"elided\"} %llu\n", (unsigned long long)load64(&c[MET_UPLOAD_PIXELS_ELIDED]));
+
+    header("pbl_cache_hits_total", "counter", "Pixels lidos sem o barramento");
+    out("pbl_cache_hits_total{source=\"mirror\"} %llu\n", (unsigned long long)load64(&c[MET_READ_MIRROR]));
+    out("pbl_cache_hits_total{source=\"host_copy\"} %llu\n", (unsigned long long)load64(&c[MET_READ_COPY]));
+    counter("pbl_cache_misses_total", "Pixels lidos do barramento pela falta de copia no host", load64(&c[MET_READ_BUS]));
+    counter("pbl_reads_refused_total", "Leituras recusadas (conteudo da memoria indefinido)", load64(&c[MET_READ_REFUSED]));
+    counter("pbl_recoveries_total", "Recuperacoes apos timeout ou FLAG_ERROR", load64(&c[MET_RECOVERIES]));
+    counter("pbl_recoveries_failed_total", "Recuperacoes sem sucesso", load64(&c[MET_RECOVERIES_FAILED]));
+    counter("pbl_verify_tiles_total", "Blocos da VRAM conferidos com o espelho", load64(&c[MET_VERIFY_TILES]));
+    counter("pbl_verify_tiles_bad_total", "Blocos da VRAM diferentes do espelho", load64(&c[MET_VERIFY_TILES_BAD]));
+
+    header("pbl_operation_seconds", "histogram", "Duracao das operacoes");
+    for (int op = 0; op < METRICS_OPS; op++) {
+        uint64_t cumulative = 0;
+        for (int b = 0; b <= METRICS_OP_BUCKETS; b++) {
+            cumulative += load64(&metrics.op_buckets[op][b]);
+            if (b < METRICS_OP_BUCKETS) {
+                out("pbl_operation_seconds_bucket{op=\"%s\",le=\"%g\"} %llu\n", op_names[op],
+                    op_bounds_us[b] / 1e6, (unsigned long long)cumulative);
+            } else {
+                out("pbl_operation_seconds_bucket{op=\"%s\",le=\"+Inf\"} %llu\n", op_names[op],
+                    (unsigned long long)cumulative);
+            }
+        }
+        out("pbl_operation_seconds_sum{op=\"%s\"} %.6f\n", op_names[op], load64(&metrics.op_sum_us[op]) / 1e6);
+        out("pbl_operation_seconds_count{op=\"%s\"} %llu\n", op_names[op],
+            (unsigned long long)load64(&metrics.op_count[op]));
+    }
+}
+
+static void write_all(int fd, const char *data, int len) {
+    while (len > 0) {
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return;
+        }
+        data += n;
+        len -= n;
+    }
+}
+
+static void drop_client(struct EventLoop *loop, int slot) {
+    ev_remove(loop, clients[slot].id);
+    close(clients[slot].fd);
+    clients[slot].fd = -1;
+    clients[slot].id = -1;
+}
+
+// Pedido recebido: responde com as métricas e encerra a conexão
+static void on_client(struct EventLoop *loop, int id, uint32_t events, void *user) {
+    int slot = (int)(intptr_t)user;
+    char request[1024];
+    (void)id;
+    (void)events;
+
+    ssize_t n = recv(clients[slot].fd, request, sizeof(request) - 1, MSG_DONTWAIT);
+    if (n > 0) {
+        build_metrics();
+        if (n >= 4 && memcmp(request, "GET ", 4) == 0) {
+            char head[160];
+            int head_len = snprintf(head, sizeof(head),
+                                    "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\n"
+                                    "Content-Length: %d\r\nConnection: close\r\n\r\n", response_len);
+            write_all(clients[slot].fd, head, head_len);
+        }
+        write_all(clients[slot].fd, response, response_len);
+    } else if (n < 0 && (errno == EAGAIN || errno == EINTR)) {
+        return;
+    }
+    drop_client(loop, slot);
+}
+
+static void on_listen(struct EventLoop *loop, int id, uint32_t events, void *user) {
+    int listen_fd = (int)(intptr_t)user;
+    (void)id;
+    (void)events;
+
+    int fd = accept(listen_fd, NULL, NULL);
+    if (fd < 0) {
+        return;
+    }
+    for (int slot = 0; slot < METRICS_MAX_CLIENTS; slot++) {
+        if (clients[slot].fd < 0) {
+            clients[slot].id = ev_add_fd(loop, fd, EPOLLIN, on_client, (void*)(intptr_t)slot);
+            if (clients[slot].id >= 0) {
+                clients[slot].fd = fd;
+                return;
+            }
+            break;
+        }
+    }
+    close(fd);      // Sem espaço: o cliente tenta de novo
+}
+
+static int listen_unix(const char *path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    unlink(path);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, METRICS_MAX_CLIENTS) != 0) {
+        close(fd);
+        return -1;
+    }
+    strcpy(unix_path_open, path);
+    return fd;
+}
+
+static int listen_tcp(int port) {
+    struct sockaddr_in addr;
+    int one = 1;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, METRICS_MAX_CLIENTS) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+
+/*
+ * --- ATUALIZAÇÃO ---
+ */
+
+void metrics_algorithm(int op, int result) {
+    if (op < 0 || op >= METRICS_ALG_OPS) {
+        op = 0;
+    }
+    __atomic_fetch_add(&metrics.algorithms[op][result], 1, __ATOMIC_RELAXED);
+}
+
+void metrics_observe_op(int op, int64_t us) {
+    int bucket = 0;
+    while (bucket < METRICS_OP_BUCKETS && us > op_bounds_us[bucket]) {
+        bucket++;
+    }
+    __atomic_fetch_add(&metrics.op_buckets[op][bucket], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&metrics.op_count[op], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&metrics.op_sum_us[op], (uint64_t)us, __ATOMIC_RELAXED);
+}
+
+void metrics_fold_driver(void) {
+    uint64_t totals[8];
+    driver_totals(totals);
+    for (int i = 0; i < 8; i++) {
+        __atomic_store_n(&metrics.driver[i], totals[i], __ATOMIC_RELAXED);
+    }
+}
+
+
+/*
+ * --- SERVIDOR ---
+ */
+
+int metrics_start(struct EventLoop *loop, const char *unix_path, int tcp_port) {
+    const char *path = unix_path ? unix_path : METRICS_SOCKET_PATH;
+
+    unix_fd = listen_unix(path);
+    if (unix_fd >= 0) {
+        unix_id = ev_add_fd(loop, unix_fd, EPOLLIN, on_listen, (void*)(intptr_t)unix_fd);
+        if (unix_id < 0) {
+            close(unix_fd);
+            unlink(path);
+            unix_fd = -1;
+        }
+    }
+    if (unix_fd >= 0) {
+        printf(">>> Metricas em %s\n", path);
+    } else {
+        printf("!!! AVISO: socket de metricas %s indisponivel (%s).\n", path, strerror(errno));
+    }
+
+    if (tcp_port > 0) {
+        tcp_fd = listen_tcp(tcp_port);
+        if (tcp_fd >= 0) {
+            tcp_id = ev_add_fd(loop, tcp_fd, EPOLLIN, on_listen, (void*)(intptr_t)tcp_fd);
+            if (tcp_id < 0) {
+                close(tcp_fd);
+                tcp_fd = -1;
+            }
+        }
+        if (tcp_fd >= 0) {
+            printf(">>> Metricas em http://127.0.0.1:%d/metrics\n", tcp_port);
+        } else {
+            printf("!!! AVISO: porta de metricas %d indisponivel (%s).\n", tcp_port, strerror(errno));
+        }
+    }
+    return (unix_fd >= 0 || tcp_fd >= 0) ? 0 : -1;
+}
+
+void metrics_stop(struct EventLoop *loop) {
+    for (int slot = 0; slot < METRICS_MAX_CLIENTS; slot++) {
+        if (clients[slot].fd >= 0) {
+            drop_client(loop, slot);
+        }
+    }
+    if (unix_fd >= 0) {
+        ev_remove(loop, unix_id);
+        close(unix_fd);
+        unlink(unix_path_open);
+        unix_fd = unix_id = -1;
+    }
+    if (tcp_fd >= 0) {
+        ev_remove(loop, tcp_id);
+        close(tcp_fd);
+        tcp_fd = tcp_id = -1;
+    }
+}
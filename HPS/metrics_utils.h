@@ -0,0 +1,127 @@
+/*
+ * =========================================================================
+ * metrics_utils.h: Header do servidor de métricas (formato Prometheus)
+ * =========================================================================
+ *
+ * Expõe contadores e histogramas no formato de texto do Prometheus em um
+ * socket Unix local e, opcionalmente, em TCP no localhost. O servidor
+ * roda no laço de eventos (event_loop.h): cada conexão recebe o texto
+ * depois de enviar uma linha qualquer (um GET HTTP recebe a resposta
+ * HTTP), por exemplo:
+ *
+ *   curl --unix-socket /tmp/pbl_metrics.sock http://localhost/metrics
+ *   curl http://127.0.0.1:9100/metrics
+ *
+ * As atualizações são incrementos atômicos relaxados (sem trava), feitos
+ * uma vez por chamada, nunca por pixel: os pixels, timeouts e erros do
+ * driver vêm dos contadores do próprio lib.s (ASM_Get_Stats), lidos só
+ * na coleta, sem custo no laço do ASM_Store.
+ *
+ */
+
+#ifndef METRICS_UTILS_H
+#define METRICS_UTILS_H
+
+#include <stdint.h>
+
+struct EventLoop;
+
+/* ===================================================================
+ * Constantes
+ * =================================================================== */
+#define METRICS_SOCKET_PATH  "/tmp/pbl_metrics.sock"
+#define METRICS_MAX_CLIENTS  4
+#define METRICS_OP_BUCKETS   9       // Limites em metrics_utils.c, mais o +Inf
+#define METRICS_OPS          6       // SES_OP_* (session_utils.h)
+#define METRICS_ALG_OPS      5       // RES_OP_* (residency_utils.h), 0 = desconhecido
+
+/* Resultado de um algoritmo */
+#define MET_ALG_OK      0
+#define MET_ALG_ERROR   1
+#define MET_ALG_TIMEOUT 2
+#define MET_ALG_RESULTS 3
+
+/* Contadores simples */
+enum {
+    MET_RESET_SENT,
+    MET_RESET_ELIDED,
+    MET_REFRESH_SENT,
+    MET_REFRESH_ELIDED,
+    MET_UPLOAD_SENT,
+    MET_UPLOAD_ELIDED,               // Quadro idêntico ao espelho
+    MET_UPLOAD_PIXELS_SENT,
+    MET_UPLOAD_PIXELS_ELIDED,        // Iguais à VRAM (envio incremental)
+    MET_READ_MIRROR,                 // Pixels lidos sem barramento (acertos)
+    MET_READ_COPY,
+    MET_READ_BUS,                    // Pixels lidos do barramento (faltas)
+    MET_READ_REFUSED,                // Leituras recusadas (conteúdo indefinido)
+    MET_RECOVERIES,
+    MET_RECOVERIES_FAILED,
+    MET_VERIFY_TILES,                // Blocos conferidos com o espelho (verify_utils.h)
+    MET_VERIFY_TILES_BAD,
+    MET_COUNTERS
+};
+
+/* ===================================================================
+ * Estruturas de Dados
+ * =================================================================== */
+
+/**
+ * @brief Todos os contadores (atualizados com __atomic, sem trava)
+ */
+typedef struct {
+    uint64_t counters[MET_COUNTERS];
+    uint64_t algorithms[METRICS_ALG_OPS][MET_ALG_RESULTS];
+    uint64_t op_buckets[METRICS_OPS][METRICS_OP_BUCKETS + 1];
+    uint64_t op_count[METRICS_OPS];
+    uint64_t op_sum_us[METRICS_OPS];
+    uint64_t driver[8];              // DriverStats acumulados antes de ASM_Clear_Stats
+} Metrics;
+
+extern Metrics metrics;
+
+/* ===================================================================
+ * Protótipos das Funções
+ * =================================================================== */
+
+/**
+ * @brief Soma n a um contador MET_*
+ */
+static inline void met_add(int id, uint64_t n) {
+    __atomic_fetch_add(&metrics.counters[id], n, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Conta um algoritmo concluído
+ * @param op RES_OP_*
+ * @param result MET_ALG_*
+ */
+void metrics_algorithm(int op, int result);
+
+/**
+ * @brief Registra a duração de uma operação (chamada por session_op_end)
+ * @param op SES_OP_*
+ */
+void metrics_observe_op(int op, int64_t us);
+
+/**
+ * @brief Guarda os contadores do driver antes de ASM_Clear_Stats
+ *
+ * Os contadores expostos nunca diminuem, mesmo quando o relatório é zerado.
+ */
+void metrics_fold_driver(void);
+
+/**
+ * @brief Abre o socket Unix (e o TCP, se pedido) e registra no laço
+ * @param unix_path Caminho do socket (NULL = METRICS_SOCKET_PATH)
+ * @param tcp_port Porta em 127.0.0.1 (0 = sem TCP)
+ * @return 0 em caso de sucesso, -1 se nenhum socket pôde ser aberto
+ */
+int metrics_start(struct EventLoop *loop, const char *unix_path, int tcp_port);
+
+/**
+ * @brief Fecha os sockets e remove o arquivo do socket Unix
+ */
+void metrics_stop(struct EventLoop *loop);
+
+#endif /* METRICS_UTILS_H */
@@ -7,6 +7,10 @@
 #include <unistd.h>
 #include <dirent.h>
 #include <fcntl.h>
+#include <poll.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/inotify.h>
 #include <sys/ioctl.h>
 #include <sys/types.h>
 #include <linux/input.h>
@@ -142,3 +146,231 @@ int read_and_process_mouse_event(int mouse_fd, Cursor *current_cursor, MouseEven
     // Retorna 1 para indicar que um evento foi lido e processado certinho
     return 1;
 }
+
+
+/*
+ * --- FUNÇÃO 3: LEITURA EM LOTE (mouse_reader_next) ---
+ */
+
+// Limita o cursor à tela (x 0 - 319, y 0 - 239)
+static void clamp_cursor(Cursor *cursor) {
+    if (cursor->x < 0) cursor->x = 0;
+    if (cursor->x > 319) cursor->x = 319;
+    if (cursor->y < 0) cursor->y = 0;
+    if (cursor->y > 239) cursor->y = 239;
+}
+
+// Converte o código do botão em bit de MousePacket
+static int button_bit(int code) {
+    if (code == BTN_LEFT) return MOUSE_BTN_LEFT;
+    if (code == BTN_RIGHT) return MOUSE_BTN_RIGHT;
+    if (code == BTN_MIDDLE) return MOUSE_BTN_MIDDLE;
+    return 0;
+}
+
+// Após SYN_DROPPED: relê o estado real dos botões no driver
+static int query_buttons(int fd) {
+    unsigned long keys[NBITS(KEY_MAX)];
+    int buttons = 0;
+
+    memset(keys, 0, sizeof(keys));
+    if (ioctl(fd, EVIOCGKEY(sizeof(keys)), keys) < 0) return 0;
+
+    if (test_bit(BTN_LEFT, keys)) buttons |= MOUSE_BTN_LEFT;
+    if (test_bit(BTN_RIGHT, keys)) buttons |= MOUSE_BTN_RIGHT;
+    if (test_bit(BTN_MIDDLE, keys)) buttons |= MOUSE_BTN_MIDDLE;
+    return buttons;
+}
+
+void mouse_reader_init(MouseReader *reader, int fd) {
+    int clock = CLOCK_MONOTONIC;
+
+    memset(reader, 0, sizeof(*reader));
+    reader->fd = fd;
+
+    // Carimbos no relógio monotônico (medição de latência); falha não é grave
+    ioctl(fd, EVIOCSCLOCKID, &clock);
+}
+
+int mouse_reader_pending(const MouseReader *reader) {
+    return reader->pos < reader->count;
+}
+
+// Retorna 1 (relatório), 0 (EOF), -1 (erro) ou -2 (nada pronto, se !block)
+static int reader_next(MouseReader *reader, MousePacket *packet_out, int block) {
+    MousePacket *p = &reader->pending;
+
+    while (1) {
+        // Buffer vazio: um único read() traz todos os eventos já disponíveis
+        if (reader->pos >= reader->count) {
+            if (!block) {
+                struct pollfd pfd = { .fd = reader->fd, .events = POLLIN };
+                if (poll(&pfd, 1, 0) <= 0) return -2;
+            }
+
+            ssize_t bytes_read = read(reader->fd, reader->buffer, sizeof(reader->buffer));
+
+            if (bytes_read == 0) {
+                return 0;
+            }
+            if (bytes_read == -1) {
+                // ENODEV: mouse desconectado, tratado por quem chamou
+                if (errno != ENODEV) {
+                    perror("Erro ao ler o evento do mouse");
+                }
+                return -1;
+            }
+
+            reader->reads++;
+            reader->count = (int)(bytes_read / sizeof(struct input_event));
+            reader->pos = 0;
+            reader->events += reader->count;
+            continue;
+        }
+
+        const struct input_event *ev = &reader->buffer[reader->pos++];
+
+        if (ev->type == EV_SYN && ev->code == SYN_DROPPED) {
+            // Fila do kernel transbordou: o relatório atual está incompleto
+            reader->dropping = 1;
+            continue;
+        }
+
+        if (reader->dropping) {
+            if (ev->type == EV_SYN && ev->code == SYN_REPORT) {
+                int buttons = query_buttons(reader->fd);
+                p->dx = p->dy = p->wheel = 0;
+                p->pressed = buttons & ~p->buttons;
+                p->released = p->buttons & ~buttons;
+                p->buttons = buttons;
+                reader->dropping = 0;
+            }
+            continue;
+        }
+
+        if (ev->type == EV_REL) {
+            if (ev->code == REL_X) p->dx += ev->value;
+            else if (ev->code == REL_Y) p->dy += ev->value;
+            else if (ev->code == REL_WHEEL) p->wheel += ev->value;
+        } else if (ev->type == EV_KEY) {
+            int bit = button_bit(ev->code);
+            if (ev->value == 1) {
+                p->buttons |= bit;
+                p->pressed |= bit;
+            } else if (ev->value == 0) {
+                p->buttons &= ~bit;
+                p->released |= bit;
+            }
+        } else if (ev->type == EV_SYN && ev->code == SYN_REPORT) {
+            int empty = (p->dx == 0 && p->dy == 0 && p->wheel == 0 &&
+                         p->pressed == 0 && p->released == 0);
+            if (empty) continue;
+
+            // Movimento de todo o relatório aplicado de uma vez
+            reader->cursor.x += p->dx;
+            reader->cursor.y += p->dy;
+            clamp_cursor(&reader->cursor);
+
+            p->cursor_pos = reader->cursor;
+            p->time = ev->time;
+            *packet_out = *p;
+            reader->packets++;
+
+            p->dx = p->dy = p->wheel = 0;
+            p->pressed = p->released = 0;
+            return 1;
+        }
+    }
+}
+
+int mouse_reader_next(MouseReader *reader, MousePacket *packet_out) {
+    return reader_next(reader, packet_out, 1);
+}
+
+int mouse_reader_poll(MouseReader *reader, MousePacket *packet_out) {
+    int result = reader_next(reader, packet_out, 0);
+    if (result == -2) return 0;
+    return (result == 1) ? 1 : -1;
+}
+
+
+/*
+ * --- FUNÇÃO 4: HOTPLUG (mouse_hotplug_handle) ---
+ */
+
+int mouse_hotplug_init(MouseHotplug *hotplug) {
+    hotplug->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    hotplug->watch = -1;
+    if (hotplug->fd < 0) {
+        return -1;
+    }
+
+    // IN_ATTRIB: o udev ajusta as permissões depois de criar o nó
+    hotplug->watch = inotify_add_watch(hotplug->fd, "/dev/input",
+                                       IN_CREATE | IN_ATTRIB | IN_DELETE | IN_MOVED_TO);
+    if (hotplug->watch < 0) {
+        close(hotplug->fd);
+        hotplug->fd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+void mouse_hotplug_close(MouseHotplug *hotplug) {
+    if (hotplug->fd >= 0) {
+        close(hotplug->fd);
+        hotplug->fd = -1;
+    }
+}
+
+int mouse_hotplug_handle(MouseHotplug *hotplug, const char *current_path, int *removed_out,
+                         char *device_path_out, char *name_out) {
+    char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    int mouse_fd = -1;
+
+    *removed_out = 0;
+
+    while (1) {
+        ssize_t len = read(hotplug->fd, buffer, sizeof(buffer));
+        if (len <= 0) {
+            break;
+        }
+
+        for (char *ptr = buffer; ptr < buffer + len;
+             ptr += sizeof(struct inotify_event) + ((struct inotify_event*)ptr)->len) {
+            const struct inotify_event *ev = (const struct inotify_event*)ptr;
+
+            if (ev->len == 0 || strncmp(ev->name, "event", 5) != 0) continue;
+
+            char filename[MAX_PATH_LEN];
+            snprintf(filename, MAX_PATH_LEN, "/dev/input/%.240s", ev->name);
+
+            if (ev->mask & IN_DELETE) {
+                if (strcmp(filename, current_path) == 0) {
+                    *removed_out = 1;
+                }
+                continue;
+            }
+
+            // Já temos um mouse novo neste lote, ou é o próprio mouse ativo (se
+            // ele saiu neste lote, o mesmo caminho é uma reconexão rápida)
+            if (mouse_fd >= 0 || (!*removed_out && strcmp(filename, current_path) == 0)) continue;
+
+            int fd = open(filename, O_RDONLY);
+            if (fd < 0) continue;       // Sem permissão ainda: tenta de novo no IN_ATTRIB
+
+            if (!is_mouse(fd)) {
+                close(fd);
+                continue;
+            }
+
+            char name[MAX_PATH_LEN] = "Desconhecido";
+            ioctl(fd, EVIOCGNAME(sizeof(name)), name);
+            strncpy(device_path_out, filename, MAX_PATH_LEN);
+            strncpy(name_out, name, MAX_PATH_LEN);
+            mouse_fd = fd;
+        }
+    }
+
+    return mouse_fd;
+}
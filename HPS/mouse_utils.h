@@ -20,6 +20,16 @@
 #define NBITS(x) ((((x) - 1) / (sizeof(long) * 8)) + 1)
 #define test_bit(bit, array) ((array[(bit) / (sizeof(long) * 8)] >> ((bit) % (sizeof(long) * 8))) & 1)
 
+/* ===================================================================
+ * Leitura em lote
+ * =================================================================== */
+#define MOUSE_BATCH_EVENTS 64        // Eventos drenados por read()
+
+// Bits de botão em MousePacket
+#define MOUSE_BTN_LEFT   0x1
+#define MOUSE_BTN_RIGHT  0x2
+#define MOUSE_BTN_MIDDLE 0x4
+
 /* ===================================================================
  * Estruturas de Dados
  * =================================================================== */
@@ -42,6 +52,45 @@ typedef struct {
     Cursor   cursor_pos;   // Current cursor position after processing
 } MouseEvent;
 
+/**
+ * @brief Um relatório completo do mouse (tudo até o SYN_REPORT)
+ */
+typedef struct {
+    int dx, dy;             // Movimento relativo acumulado no relatório
+    int wheel;              // Giro acumulado da roda
+    int buttons;            // Estado dos botões após o relatório (MOUSE_BTN_*)
+    int pressed;            // Botões pressionados neste relatório
+    int released;           // Botões soltos neste relatório
+    Cursor cursor_pos;      // Posição do cursor após o relatório
+    struct timeval time;    // Carimbo do SYN_REPORT no kernel (CLOCK_MONOTONIC se suportado)
+} MousePacket;
+
+/**
+ * @brief Observador de hotplug em /dev/input (inotify)
+ */
+typedef struct {
+    int fd;                 // fd do inotify (pronto para leitura quando há eventos)
+    int watch;
+} MouseHotplug;
+
+/**
+ * @brief Leitor em lote: drena vários eventos por read() e os agrupa por relatório
+ */
+typedef struct {
+    int fd;
+    Cursor cursor;
+    struct input_event buffer[MOUSE_BATCH_EVENTS];
+    int count;              // Eventos válidos em buffer
+    int pos;                // Próximo evento a processar
+    MousePacket pending;    // Relatório em montagem
+    int dropping;           // SYN_DROPPED: descartar até o próximo SYN_REPORT
+
+    /* Estatísticas */
+    long reads;             // Chamadas a read()
+    long events;            // Eventos recebidos
+    long packets;           // Relatórios entregues
+} MouseReader;
+
 /* ===================================================================
  * Protótipos das Funções
  * =================================================================== */
@@ -70,4 +119,56 @@ int find_and_open_mouse(char *device_path_out, char *name_out);
  */
 int read_and_process_mouse_event(int mouse_fd, Cursor *current_cursor, MouseEvent *event_out);
 
+/**
+ * @brief Inicializa o leitor em lote sobre um mouse já aberto
+ * @param fd File descriptor do mouse
+ */
+void mouse_reader_init(MouseReader *reader, int fd);
+
+/**
+ * @brief Lê o próximo relatório do mouse
+ *
+ * Bloqueia apenas se não houver eventos no buffer. Relatórios sem
+ * movimento, roda ou mudança de botão são descartados.
+ * @param packet_out Relatório coalescido
+ * @return 1 se um relatório foi entregue, 0 para EOF, -1 em caso de erro
+ */
+int mouse_reader_next(MouseReader *reader, MousePacket *packet_out);
+
+/**
+ * @brief Versão não bloqueante de mouse_reader_next
+ * @return 1 se um relatório foi entregue, 0 se não há relatório pronto, -1 para erro ou EOF
+ */
+int mouse_reader_poll(MouseReader *reader, MousePacket *packet_out);
+
+/**
+ * @brief Indica se ainda há eventos no buffer (poll() no fd não os vê)
+ */
+int mouse_reader_pending(const MouseReader *reader);
+
+/**
+ * @brief Começa a observar a criação e remoção de nós em /dev/input
+ * @return 0 em caso de sucesso, -1 em caso de falha (hotplug indisponível)
+ */
+int mouse_hotplug_init(MouseHotplug *hotplug);
+
+/**
+ * @brief Para de observar /dev/input
+ */
+void mouse_hotplug_close(MouseHotplug *hotplug);
+
+/**
+ * @brief Trata os eventos pendentes do inotify (não bloqueia)
+ *
+ * Nós event* novos são testados com is_mouse. O nó do mouse ativo só é
+ * reaberto se foi removido no mesmo lote (reconexão rápida no mesmo nó).
+ * @param current_path Caminho do mouse ativo ("" se nenhum)
+ * @param removed_out Saída: 1 se o nó do mouse ativo foi removido
+ * @param device_path_out Caminho do mouse novo (size >= 256)
+ * @param name_out Nome do mouse novo (size >= 256)
+ * @return fd do primeiro mouse novo encontrado, ou -1 se nenhum
+ */
+int mouse_hotplug_handle(MouseHotplug *hotplug, const char *current_path, int *removed_out,
+                         char *device_path_out, char *name_out);
+
 #endif /* MOUSE_UTILS_H */
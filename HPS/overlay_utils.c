@@ -0,0 +1,259 @@
+#include <stdint.h>
+#include <string.h>
+#include "api.h"
+#include "vram_utils.h"
+#include "overlay_utils.h"
+#include "latency_utils.h"
+#include "command_utils.h"
+
+// Camadas (bits em layer[]); o cursor fica por cima do retângulo
+#define LAYER_CURSOR 0x1
+#define LAYER_BAND   0x2
+
+// Cores do cursor
+#define CURSOR_OUTLINE 0
+#define CURSOR_FILL    255
+
+// Seta: 'X' contorno, 'W' preenchimento, '.' transparente
+static const char *cursor_sprite[CURSOR_HEIGHT] = {
+    "X.......",
+    "XX......",
+    "XWX.....",
+    "XWWX....",
+    "XWWWX...",
+    "XWWWWX..",
+    "XWWWWWX.",
+    "XWWWWWWX",
+    "XWWXXXXX",
+    "XWX.....",
+    "XX......",
+};
+
+static int active = 0;
+static uint8_t layer[IMG_SIZE];          // Camadas que cobrem cada pixel
+static uint8_t displayed[IMG_SIZE];      // O que a VRAM contém de fato
+static uint8_t dirty_flag[IMG_SIZE];
+static int dirty_list[IMG_SIZE];
+static int dirty_count = 0;
+
+static int cursor_visible = 0;
+static int cursor_x, cursor_y;
+
+static int band_visible = 0;
+static int band_x0, band_y0, band_x1, band_y1;   // Cantos inclusivos
+
+static long total_flushes = 0;
+static long total_stores = 0;
+
+
+/*
+ * --- FUNÇÕES INTERNAS ---
+ */
+
+static void mark_dirty(int addr) {
+    if (!dirty_flag[addr]) {
+        dirty_flag[addr] = 1;
+        dirty_list[dirty_count++] = addr;
+    }
+}
+
+// Liga ou desliga a camada do cursor na pegada da posição (x, y)
+static void cursor_footprint(int x, int y, int on) {
+    for (int row = 0; row < CURSOR_HEIGHT; row++) {
+        if (y + row >= IMG_HEIGHT) break;
+
+        for (int col = 0; col < CURSOR_WIDTH; col++) {
+            if (x + col >= IMG_WIDTH) break;
+            if (cursor_sprite[row][col] == '.') continue;
+
+            int addr = (y + row) * IMG_WIDTH + x + col;
+            if (on) layer[addr] |= LAYER_CURSOR;
+            else    layer[addr] &= ~LAYER_CURSOR;
+            mark_dirty(addr);
+        }
+    }
+}
+
+// Liga ou desliga a camada do retângulo em um segmento horizontal ou vertical
+static void band_segment(int x0, int y0, int x1, int y1, int on) {
+    for (int y = y0; y <= y1; y++) {
+        for (int x = x0; x <= x1; x++) {
+            int addr = y * IMG_WIDTH + x;
+            if (on) layer[addr] |= LAYER_BAND;
+            else    layer[addr] &= ~LAYER_BAND;
+            mark_dirty(addr);
+        }
+    }
+}
+
+// Contorno do retângulo: quatro segmentos
+static void band_outline(int x0, int y0, int x1, int y1, int on) {
+    band_segment(x0, y0, x1, y0, on);
+    band_segment(x0, y1, x1, y1, on);
+    band_segment(x0, y0, x0, y1, on);
+    band_segment(x1, y0, x1, y1, on);
+}
+
+// Cor final de um pixel: camada de cima, senão a imagem do espelho
+static uint8_t compose(int addr) {
+    if (layer[addr] & LAYER_CURSOR) {
+        int row = addr / IMG_WIDTH - cursor_y;
+        int col = addr % IMG_WIDTH - cursor_x;
+        return (cursor_sprite[row][col] == 'X') ? CURSOR_OUTLINE : CURSOR_FILL;
+    }
+    if (layer[addr] & LAYER_BAND) {
+        // Tracejado fixo na tela: um pixel que continua no contorno não muda de cor
+        int x = addr % IMG_WIDTH;
+        int y = addr / IMG_WIDTH;
+        return (((x + y) / BAND_DASH) % 2) ? BAND_LIGHT : BAND_DARK;
+    }
+    return vram_mirror()[addr];
+}
+
+
+/*
+ * --- CICLO DE VIDA ---
+ */
+
+int overlay_begin(void) {
+    if (!vram_mirror_valid()) {
+        return -1;
+    }
+
+    memset(layer, 0, sizeof(layer));
+    memset(dirty_flag, 0, sizeof(dirty_flag));
+    memcpy(displayed, vram_mirror(), IMG_SIZE);
+    dirty_count = 0;
+    cursor_visible = 0;
+    band_visible = 0;
+    total_flushes = 0;
+    total_stores = 0;
+    active = 1;
+    return 0;
+}
+
+void overlay_end(void) {
+    if (!active) return;
+
+    overlay_cursor_hide();
+    overlay_band_hide();
+
+    // Restauração incompleta: a VRAM não corresponde mais ao espelho
+    if (overlay_flush() < 0) {
+        vram_mirror_invalidate();
+    }
+    active = 0;
+}
+
+
+/*
+ * --- CURSOR ---
+ */
+
+void overlay_cursor_move(int x, int y) {
+    if (!active) return;
+    if (cursor_visible && x == cursor_x && y == cursor_y) return;
+
+    if (cursor_visible) {
+        cursor_footprint(cursor_x, cursor_y, 0);
+    }
+    cursor_x = x;
+    cursor_y = y;
+    cursor_visible = 1;
+    cursor_footprint(cursor_x, cursor_y, 1);
+}
+
+void overlay_cursor_hide(void) {
+    if (!active || !cursor_visible) return;
+
+    cursor_footprint(cursor_x, cursor_y, 0);
+    cursor_visible = 0;
+}
+
+
+/*
+ * --- RETÂNGULO DE SELEÇÃO ---
+ */
+
+void overlay_band_set(int x0, int y0, int x1, int y1) {
+    if (!active) return;
+
+    // Normalizar e limitar à tela
+    if (x0 > x1) { int t = x0; x0 = x1; x1 = t; }
+    if (y0 > y1) { int t = y0; y0 = y1; y1 = t; }
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > IMG_WIDTH - 1) x1 = IMG_WIDTH - 1;
+    if (y1 > IMG_HEIGHT - 1) y1 = IMG_HEIGHT - 1;
+
+    if (band_visible && x0 == band_x0 && y0 == band_y0 && x1 == band_x1 && y1 == band_y1) {
+        return;
+    }
+
+    /*
+     * Apaga o contorno antigo e marca o novo; no flush, os pixels que
+     * continuam no contorno (arestas paradas) têm a mesma cor antes e
+     * depois e não são reenviados. Só os segmentos que se moveram vão
+     * ao barramento.
+     */
+    if (band_visible) {
+        band_outline(band_x0, band_y0, band_x1, band_y1, 0);
+    }
+    band_x0 = x0;
+    band_y0 = y0;
+    band_x1 = x1;
+    band_y1 = y1;
+    band_visible = 1;
+    band_outline(band_x0, band_y0, band_x1, band_y1, 1);
+}
+
+void overlay_band_hide(void) {
+    if (!active || !band_visible) return;
+
+    band_outline(band_x0, band_y0, band_x1, band_y1, 0);
+    band_visible = 0;
+}
+
+
+/*
+ * --- ENVIO À VRAM ---
+ */
+
+int overlay_flush(void) {
+    if (!active) return 0;
+
+    int stores = 0;
+    int failed = 0;
+
+    lat_stage_enter(LAT_STAGE_UPLOAD);
+    for (int i = 0; i < dirty_count; i++) {
+        int addr = dirty_list[i];
+        uint8_t value = compose(addr);
+        dirty_flag[addr] = 0;
+
+        // Pegadas antiga e nova se sobrepõem: só o que muda vai ao barramento
+        if (value == displayed[addr]) continue;
+
+        if (ASM_Store(addr, value, 0) != ERR_SUCCESS) {
+            failed = 1;
+            continue;
+        }
+        displayed[addr] = value;
+        stores++;
+    }
+    dirty_count = 0;
+    lat_stage_leave(LAT_STAGE_UPLOAD);
+
+    if (stores > 0) {
+        vram_refresh();
+        cmd_invalidate();       // A tela exibe a sobreposição, não o espelho
+        total_flushes++;
+        total_stores += stores;
+    }
+    return failed ? -1 : stores;
+}
+
+void overlay_stats(long *flushes_out, long *stores_out) {
+    *flushes_out = total_flushes;
+    *stores_out = total_stores;
+}
@@ -0,0 +1,88 @@
+/*
+ * =========================================================================
+ * overlay_utils.h: Header das sobreposições de tela (cursor, seleção)
+ * =========================================================================
+ *
+ * Desenha elementos temporários (o cursor do mouse e o retângulo de
+ * seleção) direto na Memória Principal, por cima da imagem. O espelho de
+ * vram_utils.h não é alterado: ele continua guardando a imagem real e
+ * serve de cópia dos pixels sob a sobreposição (save-under). Mover ou
+ * esconder um elemento reescreve apenas os pixels da pegada antiga e da
+ * nova cuja cor muda.
+ *
+ * Enquanto a sobreposição está ativa a VRAM difere do espelho apenas
+ * nas pegadas. overlay_end restaura a imagem, e deve ser chamada antes
+ * de qualquer leitura da Memória Principal ou escrita via vram_utils,
+ * para que nada da sobreposição vaze para leituras ou caches.
+ *
+ * A tela precisa estar exibindo a Memória Principal (sem algoritmo
+ * aplicado): cada atualização envia um Refresh.
+ *
+ */
+
+#ifndef OVERLAY_UTILS_H
+#define OVERLAY_UTILS_H
+
+#include <stdint.h>
+
+/* ===================================================================
+ * Constantes
+ * =================================================================== */
+#define CURSOR_WIDTH  8
+#define CURSOR_HEIGHT 11             // Seta com ponta (hotspot) no canto superior esquerdo
+
+#define BAND_DASH  4                 // Comprimento do traço do contorno
+#define BAND_DARK  0
+#define BAND_LIGHT 255
+
+/* ===================================================================
+ * Protótipos das Funções
+ * =================================================================== */
+
+/**
+ * @brief Ativa as sobreposições sobre o conteúdo atual da Memória Principal
+ * @return 0 em caso de sucesso, -1 se o espelho for inválido (conteúdo desconhecido)
+ */
+int overlay_begin(void);
+
+/**
+ * @brief Move (e mostra) o cursor; a tela muda só em overlay_flush
+ * @param x, y Posição da ponta da seta
+ */
+void overlay_cursor_move(int x, int y);
+
+/**
+ * @brief Esconde o cursor; a tela muda só em overlay_flush
+ */
+void overlay_cursor_hide(void);
+
+/**
+ * @brief Mostra ou move o retângulo de seleção; a tela muda só em overlay_flush
+ * @param x0, y0, x1, y1 Cantos opostos (inclusivos, em qualquer ordem)
+ */
+void overlay_band_set(int x0, int y0, int x1, int y1);
+
+/**
+ * @brief Esconde o retângulo de seleção; a tela muda só em overlay_flush
+ */
+void overlay_band_hide(void);
+
+/**
+ * @brief Escreve na VRAM os pixels alterados desde o último flush e envia o Refresh
+ * @return Número de pixels escritos, ou -1 em caso de falha
+ */
+int overlay_flush(void);
+
+/**
+ * @brief Remove todas as sobreposições e restaura a imagem do espelho
+ */
+void overlay_end(void);
+
+/**
+ * @brief Estatísticas desde overlay_begin
+ * @param flushes_out Número de flushes que escreveram pixels
+ * @param stores_out Número de pixels escritos
+ */
+void overlay_stats(long *flushes_out, long *stores_out);
+
+#endif /* OVERLAY_UTILS_H */
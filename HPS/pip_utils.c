@@ -0,0 +1,267 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "pip_utils.h"
+#include "zoom_utils.h"
+
+
+/*
+ * --- FUNÇÕES INTERNAS ---
+ */
+
+// Marca como sujos todos os blocos tocados pelo retângulo
+static void pip_mark_rect(PipCompositor *comp, int x, int y, int width, int height) {
+    int tx0 = x / TILE_SIZE;
+    int ty0 = y / TILE_SIZE;
+    int tx1 = (x + width - 1) / TILE_SIZE;
+    int ty1 = (y + height - 1) / TILE_SIZE;
+
+    for (int ty = ty0; ty <= ty1; ty++) {
+        for (int tx = tx0; tx <= tx1; tx++) {
+            comp->recompose[ty * TILES_X + tx] = 1;
+        }
+    }
+}
+
+// Renderiza o conteúdo da janela a partir do quadro base
+static void pip_render(const PipCompositor *comp, PipWindow *win) {
+    int w = win->width;
+    int h = win->height;
+    int center_x = win->x + w / 2;
+    int center_y = win->y + h / 2;
+
+    if (win->level >= 0) {
+        // Zoom in: janela de origem menor, centrada no centro da janela
+        int scale = 1 << win->level;
+        int src_w = (w + scale - 1) / scale;
+        int src_h = (h + scale - 1) / scale;
+        int src_x = center_x - src_w / 2;
+        int src_y = center_y - src_h / 2;
+
+        if (src_x < 0) src_x = 0;
+        if (src_y < 0) src_y = 0;
+        if (src_x > IMG_WIDTH - src_w) src_x = IMG_WIDTH - src_w;
+        if (src_y > IMG_HEIGHT - src_h) src_y = IMG_HEIGHT - src_h;
+
+        if (win->algorithm == ZOOM_ALG_REPLICATION) {
+            zoom_replicate(comp->base, IMG_WIDTH, src_x, src_y, scale,
+                           win->content, w, w, h);
+        } else {
+            zoom_nearest_rect(comp->base, IMG_WIDTH, src_x, src_y, scale,
+                              win->content, w, 0, 0, w, h);
+        }
+    } else {
+        // Zoom out: a origem pode não caber na imagem, o resto fica preto
+        int factor = 1 << -win->level;
+        int out_w = (w < IMG_WIDTH / factor) ? w : IMG_WIDTH / factor;
+        int out_h = (h < IMG_HEIGHT / factor) ? h : IMG_HEIGHT / factor;
+        int src_x = center_x - out_w * factor / 2;
+        int src_y = center_y - out_h * factor / 2;
+
+        if (src_x < 0) src_x = 0;
+        if (src_y < 0) src_y = 0;
+        if (src_x > IMG_WIDTH - out_w * factor) src_x = IMG_WIDTH - out_w * factor;
+        if (src_y > IMG_HEIGHT - out_h * factor) src_y = IMG_HEIGHT - out_h * factor;
+
+        if (out_w < w || out_h < h) {
+            memset(win->content, 0, w * h);
+        }
+
+        if (win->algorithm == ZOOM_ALG_AVERAGE) {
+            zoom_average(comp->base, IMG_WIDTH, src_x, src_y, factor,
+                         win->content, w, out_w, out_h);
+        } else {
+            zoom_decimate(comp->base, IMG_WIDTH, src_x, src_y, factor,
+                          win->content, w, out_w, out_h);
+        }
+    }
+
+    // Borda para separar a janela do fundo
+    memset(win->content, PIP_BORDER_COLOR, w);
+    memset(win->content + (h - 1) * w, PIP_BORDER_COLOR, w);
+    for (int row = 1; row < h - 1; row++) {
+        win->content[row * w] = PIP_BORDER_COLOR;
+        win->content[row * w + w - 1] = PIP_BORDER_COLOR;
+    }
+}
+
+// Índices das janelas ativas em ordem Z crescente
+static int pip_sorted_windows(const PipCompositor *comp, int *order) {
+    int count = 0;
+
+    for (int i = 0; i < PIP_MAX_WINDOWS; i++) {
+        if (!comp->windows[i].active) continue;
+
+        int pos = count++;
+        while (pos > 0 && comp->windows[order[pos - 1]].z > comp->windows[i].z) {
+            order[pos] = order[pos - 1];
+            pos--;
+        }
+        order[pos] = i;
+    }
+    return count;
+}
+
+
+/*
+ * --- CICLO DE VIDA ---
+ */
+
+void pip_init(PipCompositor *comp, const uint8_t *base) {
+    memset(comp->windows, 0, sizeof(comp->windows));
+    memset(comp->recompose, 1, sizeof(comp->recompose));
+    comp->base = base;
+    tiled_from_linear(&comp->base_tiles, base);
+    tiled_from_linear(&comp->composed, base);
+    comp->next_z = 0;
+    comp->last_tiles = 0;
+    comp->last_pixels_sent = 0;
+}
+
+void pip_cleanup(PipCompositor *comp) {
+    for (int i = 0; i < PIP_MAX_WINDOWS; i++) {
+        if (comp->windows[i].content != NULL) {
+            free(comp->windows[i].content);
+            comp->windows[i].content = NULL;
+        }
+        comp->windows[i].active = 0;
+    }
+}
+
+
+/*
+ * --- JANELAS ---
+ */
+
+int pip_add_window(PipCompositor *comp, int x, int y, int width, int height,
+                   int level, int algorithm) {
+    if (width <= 0 || height <= 0 || x < 0 || y < 0 ||
+        x + width > IMG_WIDTH || y + height > IMG_HEIGHT) {
+        return -1;
+    }
+    if (level < PIP_MIN_LEVEL || level > PIP_MAX_LEVEL) {
+        return -1;
+    }
+
+    for (int i = 0; i < PIP_MAX_WINDOWS; i++) {
+        PipWindow *win = &comp->windows[i];
+        if (win->active) continue;
+
+        win->content = (uint8_t*)malloc(width * height);
+        if (!win->content) {
+            return -1;
+        }
+
+        win->active = 1;
+        win->x = x;
+        win->y = y;
+        win->width = width;
+        win->height = height;
+        win->level = level;
+        win->algorithm = algorithm;
+        win->z = comp->next_z++;
+
+        pip_render(comp, win);
+        pip_mark_rect(comp, x, y, width, height);
+        return i;
+    }
+    return -1;
+}
+
+void pip_remove_window(PipCompositor *comp, int id) {
+    if (id < 0 || id >= PIP_MAX_WINDOWS || !comp->windows[id].active) {
+        return;
+    }
+
+    PipWindow *win = &comp->windows[id];
+    pip_mark_rect(comp, win->x, win->y, win->width, win->height);
+    free(win->content);
+    win->content = NULL;
+    win->active = 0;
+}
+
+int pip_set_zoom(PipCompositor *comp, int id, int level, int algorithm) {
+    if (id < 0 || id >= PIP_MAX_WINDOWS || !comp->windows[id].active) {
+        return -1;
+    }
+    if (level < PIP_MIN_LEVEL || level > PIP_MAX_LEVEL) {
+        return -1;
+    }
+
+    PipWindow *win = &comp->windows[id];
+    win->level = level;
+    win->algorithm = algorithm;
+    pip_render(comp, win);
+    pip_mark_rect(comp, win->x, win->y, win->width, win->height);
+    return 0;
+}
+
+void pip_raise(PipCompositor *comp, int id) {
+    if (id < 0 || id >= PIP_MAX_WINDOWS || !comp->windows[id].active) {
+        return;
+    }
+
+    PipWindow *win = &comp->windows[id];
+    win->z = comp->next_z++;
+    pip_mark_rect(comp, win->x, win->y, win->width, win->height);
+}
+
+
+/*
+ * --- COMPOSIÇÃO ---
+ */
+
+int pip_composite(PipCompositor *comp) {
+    int order[PIP_MAX_WINDOWS];
+    int count = pip_sorted_windows(comp, order);
+    int tiles = 0;
+    uint8_t tile[TILE_PIXELS];
+
+    for (int index = 0; index < TILE_COUNT; index++) {
+        if (!comp->recompose[index]) continue;
+
+        int x0 = (index % TILES_X) * TILE_SIZE;
+        int y0 = (index / TILES_X) * TILE_SIZE;
+
+        // Fundo: um único bloco contíguo
+        memcpy(tile, comp->base_tiles.tiles[index], TILE_PIXELS);
+
+        // Janelas de trás para frente
+        for (int k = 0; k < count; k++) {
+            const PipWindow *win = &comp->windows[order[k]];
+            int ix0 = (win->x > x0) ? win->x : x0;
+            int iy0 = (win->y > y0) ? win->y : y0;
+            int ix1 = (win->x + win->width < x0 + TILE_SIZE) ?
+                      win->x + win->width : x0 + TILE_SIZE;
+            int iy1 = (win->y + win->height < y0 + TILE_SIZE) ?
+                      win->y + win->height : y0 + TILE_SIZE;
+
+            if (ix0 >= ix1 || iy0 >= iy1) continue;
+
+            for (int y = iy0; y < iy1; y++) {
+                memcpy(tile + (y - y0) * TILE_SIZE + (ix0 - x0),
+                       win->content + (y - win->y) * win->width + (ix0 - win->x),
+                       ix1 - ix0);
+            }
+        }
+
+        // Só blocos que mudaram de fato vão para a VRAM
+        if (memcmp(comp->composed.tiles[index], tile, TILE_PIXELS) != 0) {
+            memcpy(comp->composed.tiles[index], tile, TILE_PIXELS);
+            comp->composed.dirty[index] = 1;
+        }
+
+        comp->recompose[index] = 0;
+        tiles++;
+    }
+
+    int sent = tiled_upload_dirty(&comp->composed, NULL);
+    if (sent < 0) {
+        return -1;
+    }
+
+    comp->last_tiles = tiles;
+    comp->last_pixels_sent = sent;
+    return sent;
+}
@@ -0,0 +1,108 @@
+/*
+ * =========================================================================
+ * pip_utils.h: Header do compositor picture-in-picture
+ * =========================================================================
+ *
+ * Permite várias janelas ampliadas/reduzidas ao mesmo tempo, cada uma com
+ * seu nível e algoritmo, compostas sobre o quadro base em ordem Z.
+ *
+ * A composição usa o quadro em blocos de tile_utils.h. Alterar uma janela
+ * marca apenas os blocos que ela cobre (antes e depois da alteração);
+ * somente esses blocos são recompostos, e apenas os que mudaram de fato
+ * são enviados à VRAM.
+ *
+ */
+
+#ifndef PIP_UTILS_H
+#define PIP_UTILS_H
+
+#include <stdint.h>
+#include "api.h"
+#include "tile_utils.h"
+
+/* ===================================================================
+ * Constantes
+ * =================================================================== */
+#define PIP_MAX_WINDOWS 4
+#define PIP_MIN_LEVEL  -2            // Zoom out até 1/4
+#define PIP_MAX_LEVEL   3            // Zoom in até 8x
+
+#define PIP_BORDER_COLOR 255
+
+/* ===================================================================
+ * Estruturas de Dados
+ * =================================================================== */
+
+/**
+ * @brief Uma janela picture-in-picture
+ */
+typedef struct {
+    int active;
+    int x, y;               // Posição na tela
+    int width, height;      // Tamanho na tela
+    int level;              // > 0: zoom in 2^level, < 0: zoom out 2^-level
+    int algorithm;          // ZOOM_ALG_* (ver zoom_utils.h)
+    int z;                  // Ordem Z (maior = na frente)
+    uint8_t *content;       // Conteúdo renderizado (width * height)
+} PipWindow;
+
+/**
+ * @brief Estado do compositor
+ */
+typedef struct {
+    const uint8_t *base;                        // Quadro de fundo (linhas, para os kernels)
+    TiledFrame base_tiles;                      // Quadro de fundo em blocos
+    TiledFrame composed;                        // Resultado da composição
+    PipWindow windows[PIP_MAX_WINDOWS];
+    uint8_t recompose[TILE_COUNT];              // Blocos a recompor
+    int next_z;
+
+    /* Estatísticas da última composição */
+    int last_tiles;
+    int last_pixels_sent;
+} PipCompositor;
+
+/* ===================================================================
+ * Protótipos das Funções
+ * =================================================================== */
+
+/**
+ * @brief Inicializa o compositor sobre um quadro base (todos os blocos sujos)
+ */
+void pip_init(PipCompositor *comp, const uint8_t *base);
+
+/**
+ * @brief Libera os buffers das janelas
+ */
+void pip_cleanup(PipCompositor *comp);
+
+/**
+ * @brief Cria uma janela na frente das demais
+ * @return Índice da janela, ou -1 se não houver espaço/memória
+ */
+int pip_add_window(PipCompositor *comp, int x, int y, int width, int height,
+                   int level, int algorithm);
+
+/**
+ * @brief Remove uma janela
+ */
+void pip_remove_window(PipCompositor *comp, int id);
+
+/**
+ * @brief Altera nível e algoritmo de uma janela e a renderiza de novo
+ * @return 0 em caso de sucesso, -1 se os parâmetros forem inválidos
+ */
+int pip_set_zoom(PipCompositor *comp, int id, int level, int algorithm);
+
+/**
+ * @brief Traz uma janela para a frente
+ */
+void pip_raise(PipCompositor *comp, int id);
+
+/**
+ * @brief Recompõe os blocos sujos e envia as diferenças à VRAM
+ * @return Número de pixels enviados, ou -1 em caso de falha
+ */
+int pip_composite(PipCompositor *comp);
+
+#endif /* PIP_UTILS_H */
@@ -0,0 +1,245 @@
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "api.h"
+#include "vram_utils.h"
+#include "residency_utils.h"
+#include "metrics_utils.h"
+
+static const char *op_names[] = { "?", "NN", "PR", "DEC", "BA" };
+
+/* Conteúdo das memórias (a Principal é descrita pelo espelho) */
+static Residency secondary;
+static int screen = RES_PRIMARY;
+
+/* Identificador do conteúdo da Memória Principal */
+static uint32_t next_frame_id = 1;
+static uint32_t primary_id;
+static uint32_t primary_hash;
+
+/* Cópia da Secundária no host e o conteúdo que ela tem */
+static uint8_t secondary_copy[IMG_SIZE];
+static Residency copy_of;
+
+/* Estatísticas (pixels) */
+static long from_mirror, from_copy, from_bus;
+static long refused;
+
+
+/*
+ * --- FUNÇÕES INTERNAS ---
+ */
+
+// Identificador do quadro na Memória Principal: muda quando o espelho muda
+static uint32_t primary_frame_id(void) {
+    if (!vram_mirror_valid()) {
+        return 0;
+    }
+    uint32_t hash = vram_mirror_hash();
+    if (primary_id == 0 || hash != primary_hash) {
+        primary_hash = hash;
+        primary_id = next_frame_id++;
+    }
+    return primary_id;
+}
+
+// Mesmo conteúdo conhecido (origem desconhecida nunca coincide)
+static int same_content(const Residency *a, const Residency *b) {
+    return a->valid && b->valid && a->frame_id != 0 && a->frame_id == b->frame_id &&
+           a->chain_len == b->chain_len && memcmp(a->chain, b->chain, a->chain_len) == 0;
+}
+
+static int read_bus(int mem, uint8_t *dst, int dst_stride, int x, int y, int width, int height) {
+    int errors = 0;
+
+    for (int row = 0; row < height; row++) {
+        uint8_t *out = dst + row * dst_stride;
+        int addr = (y + row) * IMG_WIDTH + x;
+        for (int col = 0; col < width; col++) {
+            int value = ASM_Load(addr + col, mem);
+            if (value < 0 || value > 255) {
+                errors++;
+                value = 0;
+            }
+            out[col] = (uint8_t)value;
+        }
+    }
+    from_bus += width * height;
+    met_add(MET_READ_BUS, width * height);
+    return errors;
+}
+
+static void copy_rect(const uint8_t *frame, uint8_t *dst, int dst_stride,
+                      int x, int y, int width, int height) {
+    for (int row = 0; row < height; row++) {
+        memcpy(dst + row * dst_stride, frame + (y + row) * IMG_WIDTH + x, width);
+    }
+}
+
+
+/*
+ * --- EVENTOS ---
+ */
+
+void res_reset(void) {
+    secondary.valid = 0;
+    screen = RES_PRIMARY;
+}
+
+void res_transform(int op, int ok) {
+    screen = RES_SECONDARY;
+    if (!ok) {
+        secondary.valid = 0;
+        return;
+    }
+
+    // Sem transformação válida na Secundária, o algoritmo parte da Principal
+    if (!secondary.valid) {
+        secondary.valid = 1;
+        secondary.frame_id = primary_frame_id();
+        secondary.chain_len = 0;
+    }
+    if (secondary.chain_len == RES_MAX_CHAIN) {
+        secondary.frame_id = 0;
+        return;
+    }
+    secondary.chain[secondary.chain_len++] = (uint8_t)op;
+}
+
+void res_show_primary(void) {
+    screen = RES_PRIMARY;
+}
+
+
+/*
+ * --- CONSULTA ---
+ */
+
+Residency res_get(int mem) {
+    if (mem == RES_SECONDARY) {
+        return secondary;
+    }
+
+    Residency primary;
+    memset(&primary, 0, sizeof(primary));
+    primary.valid = 1;              // Sempre legível; sem espelho, de origem desconhecida
+    primary.frame_id = primary_frame_id();
+    return primary;
+}
+
+Residency res_algorithm_input(void) {
+    return secondary.valid ? secondary : res_get(RES_PRIMARY);
+}
+
+int res_lookup(const Residency *content, uint8_t *frame_out) {
+    Residency primary = res_get(RES_PRIMARY);
+
+    if (same_content(content, &primary)) {
+        memcpy(frame_out, vram_mirror(), IMG_SIZE);
+        return 0;
+    }
+    if (same_content(content, &copy_of)) {
+        memcpy(frame_out, secondary_copy, IMG_SIZE);
+        return 0;
+    }
+    return -1;
+}
+
+int res_screen_memory(void) {
+    if (screen == RES_SECONDARY && !secondary.valid) {
+        return -1;
+    }
+    return screen;
+}
+
+void res_describe(int mem, char *out, int size) {
+    Residency content = res_get(mem);
+    int len;
+
+    if (!content.valid) {
+        snprintf(out, size, "indefinido");
+        return;
+    }
+    if (content.frame_id) {
+        len = snprintf(out, size, "quadro %u", (unsigned)content.frame_id);
+    } else {
+        len = snprintf(out, size, "quadro desconhecido");
+    }
+    for (int i = 0; i < content.chain_len && len > 0 && len < size; i++) {
+        int op = content.chain[i];
+        len += snprintf(out + len, size - len, " + %s", op_names[(op <= RES_OP_AVERAGE) ? op : 0]);
+    }
+}
+
+
+/*
+ * --- LEITURA ---
+ */
+
+int res_read(int mem, uint8_t *dst, int dst_stride, int x, int y, int width, int height) {
+    if (x < 0 || y < 0 || width <= 0 || height <= 0 ||
+        x + width > IMG_WIDTH || y + height > IMG_HEIGHT) {
+        return -1;
+    }
+
+    if (mem == RES_PRIMARY) {
+        if (vram_mirror_valid()) {
+            copy_rect(vram_mirror(), dst, dst_stride, x, y, width, height);
+            from_mirror += width * height;
+            met_add(MET_READ_MIRROR, width * height);
+            return 0;
+        }
+        return read_bus(mem, dst, dst_stride, x, y, width, height);
+    }
+
+    if (!secondary.valid) {
+        refused++;
+        met_add(MET_READ_REFUSED, 1);
+        return -1;
+    }
+    if (same_content(&copy_of, &secondary)) {
+        copy_rect(secondary_copy, dst, dst_stride, x, y, width, height);
+        from_copy += width * height;
+        met_add(MET_READ_COPY, width * height);
+        return 0;
+    }
+
+    int errors = read_bus(mem, dst, dst_stride, x, y, width, height);
+    if (errors != 0) {
+        return errors;
+    }
+
+    // Quadro inteiro de conteúdo conhecido: guardado para as próximas leituras
+    if (width == IMG_WIDTH && height == IMG_HEIGHT && secondary.frame_id != 0) {
+        for (int row = 0; row < IMG_HEIGHT; row++) {
+            memcpy(secondary_copy + row * IMG_WIDTH, dst + row * dst_stride, IMG_WIDTH);
+        }
+        copy_of = secondary;
+    }
+    return 0;
+}
+
+
+/*
+ * --- RELATÓRIO ---
+ */
+
+void res_dump(void) {
+    char text[96];
+
+    printf("\n=== CONTEUDO DAS MEMORIAS ===\n");
+    res_describe(RES_PRIMARY, text, sizeof(text));
+    printf("Principal:  %s%s\n", text, (screen == RES_PRIMARY) ? "  (na tela)" : "");
+    res_describe(RES_SECONDARY, text, sizeof(text));
+    printf("Secundaria: %s%s\n", text, (screen == RES_SECONDARY) ? "  (na tela)" : "");
+    printf("Pixels lidos: %ld do espelho, %ld da copia no host, %ld do barramento",
+           from_mirror, from_copy, from_bus);
+    printf(" (%ld leituras recusadas)\n", refused);
+}
+
+void res_stats_clear(void) {
+    from_mirror = from_copy = from_bus = 0;
+    refused = 0;
+}
@@ -0,0 +1,134 @@
+/*
+ * =========================================================================
+ * residency_utils.h: Header do rastreador de conteúdo das memórias
+ * =========================================================================
+ *
+ * Registra, para cada memória do coprocessador, o que ela contém: o
+ * quadro de origem (identificador do conteúdo da Memória Principal), a
+ * cadeia de transformações aplicada a ele e se o conteúdo é válido. A
+ * memória exibida na tela também é acompanhada.
+ *
+ * Com isso a escolha de onde ler deixa de depender do nível de zoom:
+ * a leitura vem da memória que a tela exibe, e da fonte mais barata que
+ * tem aquele conteúdo:
+ *
+ *   Memória Principal  - o espelho (vram_utils.h), sem acesso ao barramento
+ *   Memória Secundária - a cópia no host, se o mesmo quadro com a mesma
+ *                        cadeia já foi lido; senão o barramento (leituras
+ *                        do quadro inteiro viram a nova cópia)
+ *
+ * Os eventos chegam pela camada de comandos (command_utils.h).
+ *
+ */
+
+#ifndef RESIDENCY_UTILS_H
+#define RESIDENCY_UTILS_H
+
+#include <stdint.h>
+
+/* ===================================================================
+ * Constantes
+ * =================================================================== */
+
+/* Memórias (mem_sel de ASM_Load) */
+#define RES_PRIMARY    0
+#define RES_SECONDARY  1
+#define RES_MEMORIES   2
+
+/* Transformações (algoritmos do coprocessador) */
+#define RES_OP_NEAREST   1           // NearestNeighbor
+#define RES_OP_REPLICATE 2           // PixelReplication
+#define RES_OP_DECIMATE  3           // Decimation
+#define RES_OP_AVERAGE   4           // BlockAveraging
+
+#define RES_MAX_CHAIN    8           // Além disso a origem passa a ser desconhecida
+
+/* ===================================================================
+ * Estruturas de Dados
+ * =================================================================== */
+
+/**
+ * @brief Conteúdo de uma memória
+ */
+typedef struct {
+    int valid;                       // Contém uma imagem definida
+    uint32_t frame_id;               // Quadro de origem (0 = desconhecido)
+    int chain_len;
+    uint8_t chain[RES_MAX_CHAIN];    // RES_OP_* aplicadas ao quadro, em ordem
+} Residency;
+
+/* ===================================================================
+ * Protótipos das Funções
+ * =================================================================== */
+
+/**
+ * @brief Reset do coprocessador: a Secundária fica indefinida e a
+ *        Memória Principal passa a ser a tela
+ */
+void res_reset(void);
+
+/**
+ * @brief Algoritmo concluído: a Secundária recebe a transformação e é exibida
+ * @param op RES_OP_*
+ * @param ok 0 se o algoritmo falhou (conteúdo da Secundária indefinido)
+ */
+void res_transform(int op, int ok);
+
+/**
+ * @brief Refresh: a tela exibe a Memória Principal
+ */
+void res_show_primary(void);
+
+/**
+ * @brief Conteúdo atual de uma memória
+ * @param mem RES_PRIMARY ou RES_SECONDARY
+ */
+Residency res_get(int mem);
+
+/**
+ * @brief Conteúdo sobre o qual o próximo algoritmo vai operar
+ *
+ * A Secundária, se ela tem uma cadeia válida (os algoritmos encadeiam);
+ * senão a Memória Principal.
+ */
+Residency res_algorithm_input(void);
+
+/**
+ * @brief Quadro inteiro com um dado conteúdo, se o host tiver uma cópia
+ * @param content Conteúdo procurado (de res_get ou res_algorithm_input)
+ * @param frame_out Buffer IMG_WIDTH x IMG_HEIGHT
+ * @return 0 se copiado do espelho ou da cópia da Secundária, -1 se o host não o tem
+ */
+int res_lookup(const Residency *content, uint8_t *frame_out);
+
+/**
+ * @brief Memória que a tela exibe
+ * @return RES_PRIMARY, RES_SECONDARY, ou -1 se o conteúdo exibido é indefinido
+ */
+int res_screen_memory(void);
+
+/**
+ * @brief Descrição legível do conteúdo ("quadro 3 + NN + NN")
+ */
+void res_describe(int mem, char *out, int size);
+
+/**
+ * @brief Lê uma janela de uma memória pela fonte mais barata
+ * @param dst Destino (primeiro pixel da janela)
+ * @param dst_stride Largura de linha do destino
+ * @return 0 em caso de sucesso, -1 se a memória é inválida, ou o número
+ *         de leituras do barramento com erro (lidas como 0)
+ */
+int res_read(int mem, uint8_t *dst, int dst_stride, int x, int y, int width, int height);
+
+/**
+ * @brief Imprime de onde vieram os pixels lidos
+ */
+void res_dump(void);
+
+/**
+ * @brief Zera as estatísticas
+ */
+void res_stats_clear(void);
+
+#endif /* RESIDENCY_UTILS_H */
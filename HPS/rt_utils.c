@@ -0,0 +1,196 @@
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <sched.h>
+#include <malloc.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "api.h"
+#include "rt_utils.h"
+
+static RtReport report = {
+    .cpu = RT_DEFAULT_CPU,
+    .priority = RT_DEFAULT_PRIORITY,
+};
+
+
+/*
+ * --- FUNÇÕES INTERNAS ---
+ */
+
+static int64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int compare_long(const void *a, const void *b) {
+    long x = *(const long*)a;
+    long y = *(const long*)b;
+    return (x > y) - (x < y);
+}
+
+// Toca RT_STACK_PREFAULT bytes de pilha para que as páginas já existam
+static void prefault_stack(void) {
+    volatile uint8_t stack[RT_STACK_PREFAULT];
+    long page = sysconf(_SC_PAGESIZE);
+
+    for (long i = 0; i < RT_STACK_PREFAULT; i += page) {
+        stack[i] = 0;
+    }
+    (void)stack[0];
+}
+
+static int apply_affinity(void) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(report.cpu, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+        printf("!!! AVISO: nao foi possivel fixar no nucleo %d (%s).\n", report.cpu, strerror(errno));
+        return 0;
+    }
+    return RT_APPLIED_AFFINITY;
+}
+
+static int apply_fifo(void) {
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = report.priority;
+    if (sched_setscheduler(0, SCHED_FIFO, &param) != 0) {
+        printf("!!! AVISO: SCHED_FIFO %d recusado (%s).\n", report.priority, strerror(errno));
+        return 0;
+    }
+    return RT_APPLIED_FIFO;
+}
+
+static int apply_mlock(void) {
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        printf("!!! AVISO: mlockall falhou (%s).\n", strerror(errno));
+        return 0;
+    }
+    // Memória liberada fica com o processo (travada); nada de mmap por bloco
+    mallopt(M_TRIM_THRESHOLD, -1);
+    mallopt(M_MMAP_MAX, 0);
+    prefault_stack();
+    return RT_APPLIED_MLOCK;
+}
+
+
+/*
+ * --- PERFIL ---
+ */
+
+void rt_request(int cpu, int priority) {
+    report.requested = 1;
+    report.cpu = (cpu >= 0) ? cpu : RT_DEFAULT_CPU;
+    report.priority = (priority > 0) ? priority : RT_DEFAULT_PRIORITY;
+}
+
+int rt_requested(void) {
+    return report.requested;
+}
+
+int rt_start(void) {
+    if (!report.requested) {
+        return 0;
+    }
+
+    rt_measure(&report.before);
+    report.applied = apply_affinity() | apply_fifo() | apply_mlock();
+    rt_measure(&report.after);
+    report.measured = 1;
+
+    ASM_Clear_Stats();
+    return (report.applied == (RT_APPLIED_AFFINITY | RT_APPLIED_FIFO | RT_APPLIED_MLOCK)) ? 0 : -1;
+}
+
+void rt_prefault(void *buffer, size_t size) {
+    volatile uint8_t *bytes = (volatile uint8_t*)buffer;
+    long page = sysconf(_SC_PAGESIZE);
+
+    for (size_t i = 0; i < size; i += page) {
+        bytes[i] = bytes[i];
+    }
+    if (size > 0) {
+        bytes[size - 1] = bytes[size - 1];
+    }
+}
+
+
+/*
+ * --- MEDIÇÃO ---
+ */
+
+void rt_measure(RtJitter *out) {
+    static long samples[RT_JITTER_OPS];
+    int64_t wake_total = 0;
+
+    memset(out, 0, sizeof(*out));
+
+    // LOADs seguidos do mesmo endereço: só o barramento e o escalonador variam
+    for (int i = 0; i < RT_JITTER_OPS; i++) {
+        int64_t start = now_ns();
+        ASM_Load(0, 0);
+        samples[i] = (long)(now_ns() - start);
+    }
+    qsort(samples, RT_JITTER_OPS, sizeof(long), compare_long);
+    out->op_min_ns = samples[0];
+    out->op_p50_ns = samples[RT_JITTER_OPS / 2];
+    out->op_p99_ns = samples[RT_JITTER_OPS * 99 / 100];
+    out->op_max_ns = samples[RT_JITTER_OPS - 1];
+
+    // Atraso ao acordar: quanto depois do prazo a thread volta a rodar
+    for (int i = 0; i < RT_JITTER_WAKES; i++) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_nsec += RT_JITTER_SLEEP_NS;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
+
+        long late = (long)(now_ns() - ((int64_t)deadline.tv_sec * 1000000000LL + deadline.tv_nsec));
+        wake_total += late;
+        if (late > out->wake_max_ns) {
+            out->wake_max_ns = late;
+        }
+    }
+    out->wake_avg_ns = (long)(wake_total / RT_JITTER_WAKES);
+}
+
+
+/*
+ * --- RELATÓRIO ---
+ */
+
+const RtReport *rt_report(void) {
+    return &report;
+}
+
+static void print_jitter(const char *label, const RtJitter *j) {
+    printf("%-7s LOAD min %6ld | p50 %6ld | p99 %7ld | max %8ld ns  (oscilacao %ld)\n",
+           label, j->op_min_ns, j->op_p50_ns, j->op_p99_ns, j->op_max_ns, j->op_max_ns - j->op_min_ns);
+    printf("        acordar: atraso medio %6ld | max %8ld ns\n", j->wake_avg_ns, j->wake_max_ns);
+}
+
+void rt_dump(void) {
+    printf("\n=== PERFIL DE TEMPO REAL ===\n");
+    if (!report.requested) {
+        printf("Desligado (use --rt).\n");
+        return;
+    }
+    printf("Nucleo %d: %s | SCHED_FIFO %d: %s | mlockall: %s\n",
+           report.cpu, (report.applied & RT_APPLIED_AFFINITY) ? "OK" : "FALHOU",
+           report.priority, (report.applied & RT_APPLIED_FIFO) ? "OK" : "FALHOU",
+           (report.applied & RT_APPLIED_MLOCK) ? "OK" : "FALHOU");
+    if (report.measured) {
+        print_jitter("Antes:", &report.before);
+        print_jitter("Depois:", &report.after);
+    }
+}
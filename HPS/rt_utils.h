@@ -0,0 +1,116 @@
+/*
+ * =========================================================================
+ * rt_utils.h: Header do perfil de tempo real (opcional)
+ * =========================================================================
+ *
+ * Os laços de espera do driver (lib.s) disputam os dois núcleos do HPS
+ * com o terminal, o kernel e o que mais estiver rodando: uma falta de
+ * página ou uma preempção no meio de um envio de 76800 pixels aparece
+ * como um travamento visível. O perfil de tempo real:
+ *
+ *   - fixa o processo (uma única thread, a que usa o barramento) em um núcleo
+ *   - passa-o para SCHED_FIFO com a prioridade pedida
+ *   - trava toda a memória (mlockall) e impede que o malloc devolva ou
+ *     mapeie memória nova depois disso
+ *   - pré-carrega a pilha e os buffers de quadro (sem faltas de página)
+ *
+ * A oscilação (jitter) é medida antes e depois: duração de LOADs
+ * seguidos e atraso ao acordar de esperas de 1 ms (clock_nanosleep).
+ * Requer sudo, como o resto do programa.
+ *
+ */
+
+#ifndef RT_UTILS_H
+#define RT_UTILS_H
+
+#include <stddef.h>
+
+/* ===================================================================
+ * Constantes
+ * =================================================================== */
+#define RT_DEFAULT_CPU      1
+#define RT_DEFAULT_PRIORITY 50       // SCHED_FIFO: 1 a 99
+#define RT_STACK_PREFAULT   (256 * 1024)
+
+#define RT_JITTER_OPS       4096     // LOADs cronometrados por medição
+#define RT_JITTER_WAKES     200      // Esperas de RT_JITTER_SLEEP_NS por medição
+#define RT_JITTER_SLEEP_NS  1000000L
+
+/* Partes do perfil aplicadas (RtReport.applied) */
+#define RT_APPLIED_AFFINITY 1
+#define RT_APPLIED_FIFO     2
+#define RT_APPLIED_MLOCK    4
+
+/* ===================================================================
+ * Estruturas de Dados
+ * =================================================================== */
+
+/**
+ * @brief Uma medição de oscilação (nanossegundos)
+ */
+typedef struct {
+    long op_min_ns, op_p50_ns, op_p99_ns, op_max_ns;   // Duração de um LOAD
+    long wake_avg_ns, wake_max_ns;                     // Atraso ao acordar
+} RtJitter;
+
+/**
+ * @brief Estado do perfil e as medições antes/depois
+ */
+typedef struct {
+    int requested;
+    int cpu;
+    int priority;
+    int applied;                     // RT_APPLIED_*
+    int measured;                    // before e after preenchidos
+    RtJitter before;
+    RtJitter after;
+} RtReport;
+
+/* ===================================================================
+ * Protótipos das Funções
+ * =================================================================== */
+
+/**
+ * @brief Pede o perfil (antes de rt_start)
+ * @param cpu Núcleo (-1 = RT_DEFAULT_CPU)
+ * @param priority Prioridade SCHED_FIFO (0 = RT_DEFAULT_PRIORITY)
+ */
+void rt_request(int cpu, int priority);
+
+/**
+ * @brief Informa se o perfil foi pedido
+ */
+int rt_requested(void);
+
+/**
+ * @brief Mede, aplica o perfil e mede de novo
+ *
+ * Deve rodar com o driver inicializado e o coprocessador parado; os
+ * contadores do driver são zerados no fim. Sem pedido, não faz nada.
+ * Cada parte que falha (sem permissão, núcleo inexistente) gera um aviso
+ * e as outras continuam.
+ * @return 0 se todas as partes foram aplicadas, -1 caso contrário
+ */
+int rt_start(void);
+
+/**
+ * @brief Pré-carrega um buffer (uma escrita por página, conteúdo preservado)
+ */
+void rt_prefault(void *buffer, size_t size);
+
+/**
+ * @brief Mede a oscilação atual
+ */
+void rt_measure(RtJitter *out);
+
+/**
+ * @brief Estado do perfil
+ */
+const RtReport *rt_report(void);
+
+/**
+ * @brief Imprime o perfil aplicado e a oscilação antes/depois
+ */
+void rt_dump(void);
+
+#endif /* RT_UTILS_H */
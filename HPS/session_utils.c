@@ -0,0 +1,348 @@
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include "session_utils.h"
+#include "metrics_utils.h"
+
+#define SESSION_MAGIC   "PBLS"
+#define SESSION_VERSION 2
+
+#pragma pack(push, 1)
+typedef struct {
+    char magic[4];
+    uint16_t version;
+    uint16_t flags;
+} SessionFileHeader;
+
+typedef struct {
+    uint8_t type;
+    uint8_t code;
+    uint16_t len;               // Bytes de conteúdo após o cabeçalho
+    uint32_t delta_us;          // Desde o registro anterior (satura em ~71 min)
+} SessionRecord;
+#pragma pack(pop)
+
+/**
+ * @brief Tempos de um tipo de operação
+ */
+typedef struct {
+    long count;
+    int64_t total_us;
+    int64_t max_us;
+} SessionOpStats;
+
+static const char *op_names[SES_OPS] = {
+    "menu", "algoritmo", "envio", "regional", "roda", "leitura"
+};
+
+static int mode = SESSION_OFF;
+
+/* Gravação */
+static FILE *record_file = NULL;
+static int64_t last_record_ns;
+
+/* Reprodução: arquivo inteiro em memória */
+static uint8_t *replay_data = NULL;
+static size_t replay_size;
+static size_t replay_pos;
+static int replay_realtime;
+static int replay_ended;
+static long replay_inputs;
+static int64_t replay_offset_us;     // Instante gravado do último registro lido
+static int64_t recorded_total_us;
+
+/* Operações */
+static int64_t session_start_ns;
+static int64_t op_since_ns[SES_OPS];
+static int op_depth[SES_OPS];
+static SessionOpStats live_ops[SES_OPS];
+static SessionOpStats recorded_ops[SES_OPS];
+
+
+/*
+ * --- FUNÇÕES INTERNAS ---
+ */
+
+static int64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void op_account(SessionOpStats *stats, int64_t us) {
+    stats->count++;
+    stats->total_us += us;
+    if (us > stats->max_us) stats->max_us = us;
+}
+
+// Registro na posição pos, validado contra o fim do arquivo
+static const SessionRecord *record_at(size_t pos) {
+    if (pos + sizeof(SessionRecord) > replay_size) {
+        return NULL;
+    }
+    const SessionRecord *rec = (const SessionRecord*)(replay_data + pos);
+    if (pos + sizeof(SessionRecord) + rec->len > replay_size) {
+        return NULL;
+    }
+    return rec;
+}
+
+static void replay_stop(const char *reason) {
+    if (!replay_ended) {
+        printf("\n[REPLAY] %s (%ld entradas reproduzidas).\n", reason, replay_inputs);
+        replay_ended = 1;
+    }
+}
+
+static void print_ms(int64_t us) {
+    printf(" %10.3f", us / 1000.0);
+}
+
+
+/*
+ * --- ABERTURA ---
+ */
+
+int session_record_open(const char *path) {
+    SessionFileHeader header;
+
+    record_file = fopen(path, "wb");
+    if (!record_file) {
+        printf("ERRO: Nao foi possivel criar a gravacao '%s': %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    memcpy(header.magic, SESSION_MAGIC, 4);
+    header.version = SESSION_VERSION;
+    header.flags = 0;
+    fwrite(&header, sizeof(header), 1, record_file);
+
+    mode = SESSION_RECORD;
+    session_start_ns = now_ns();
+    last_record_ns = session_start_ns;
+    printf("[REC] Gravando a sessao em '%s'.\n", path);
+    return 0;
+}
+
+int session_replay_open(const char *path, int realtime) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        printf("ERRO: Nao foi possivel abrir a gravacao '%s': %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    replay_data = (size > 0) ? (uint8_t*)malloc(size) : NULL;
+    if (!replay_data || fread(replay_data, 1, size, file) != (size_t)size) {
+        printf("ERRO: Falha ao ler a gravacao '%s'.\n", path);
+        free(replay_data);
+        replay_data = NULL;
+        fclose(file);
+        return -1;
+    }
+    fclose(file);
+    replay_size = (size_t)size;
+
+    const SessionFileHeader *header = (const SessionFileHeader*)replay_data;
+    if (replay_size < sizeof(*header) || memcmp(header->magic, SESSION_MAGIC, 4) != 0 ||
+        header->version != SESSION_VERSION) {
+        printf("ERRO: '%s' nao e uma gravacao de sessao (versao %d).\n", path, SESSION_VERSION);
+        free(replay_data);
+        replay_data = NULL;
+        return -1;
+    }
+
+    // Primeira passada: valida os registros e soma os tempos gravados
+    long inputs = 0;
+    size_t pos = sizeof(*header);
+    const SessionRecord *rec;
+    while ((rec = record_at(pos)) != NULL) {
+        recorded_total_us += rec->delta_us;
+        if (rec->type == SES_REC_OP && rec->code < SES_OPS && rec->len == 8) {
+            uint32_t us;
+            memcpy(&us, (const uint8_t*)(rec + 1) + 4, sizeof(us));
+            op_account(&recorded_ops[rec->code], us);
+        } else if (rec->type != SES_REC_OP) {
+            inputs++;
+        }
+        pos += sizeof(*rec) + rec->len;
+    }
+    if (pos != replay_size) {
+        printf("AVISO: Gravacao truncada; reproduzindo os %ld registros completos.\n", inputs);
+        replay_size = pos;
+    }
+
+    replay_pos = sizeof(*header);
+    replay_realtime = realtime;
+    mode = SESSION_REPLAY;
+    session_start_ns = now_ns();
+    printf("[REPLAY] '%s': %ld entradas, %.1f s gravados, modo %s.\n", path, inputs,
+           recorded_total_us / 1e6, realtime ? "tempo real" : "o mais rapido possivel");
+    return 0;
+}
+
+int session_mode(void) {
+    return mode;
+}
+
+
+/*
+ * --- REGISTROS ---
+ */
+
+void session_put(int type, int code, const void *payload, int len) {
+    if (mode != SESSION_RECORD || record_file == NULL) {
+        return;
+    }
+
+    int64_t now = now_ns();
+    int64_t delta = (now - last_record_ns) / 1000;
+    last_record_ns = now;
+
+    SessionRecord rec;
+    rec.type = (uint8_t)type;
+    rec.code = (uint8_t)code;
+    rec.len = (uint16_t)len;
+    rec.delta_us = (delta > UINT32_MAX) ? UINT32_MAX : (uint32_t)delta;
+
+    if (fwrite(&rec, sizeof(rec), 1, record_file) != 1 ||
+        (len > 0 && fwrite(payload, 1, len, record_file) != (size_t)len)) {
+        printf("\n[REC] ERRO ao gravar; gravacao interrompida.\n");
+        fclose(record_file);
+        record_file = NULL;
+        return;
+    }
+
+    // Linha do menu: fronteira natural para não perder a sessão em uma queda
+    if (type == SES_REC_LINE) {
+        fflush(record_file);
+    }
+}
+
+int session_get(int type, int *code_out, void *payload_out, int size) {
+    if (mode != SESSION_REPLAY || replay_ended) {
+        return -1;
+    }
+
+    const SessionRecord *rec;
+    while ((rec = record_at(replay_pos)) != NULL && rec->type == SES_REC_OP) {
+        replay_offset_us += rec->delta_us;
+        replay_pos += sizeof(*rec) + rec->len;
+    }
+
+    if (rec == NULL) {
+        replay_stop("Fim da gravacao");
+        return -1;
+    }
+    if (rec->type != type) {
+        char reason[96];
+        snprintf(reason, sizeof(reason), "Dessincronizada: esperado registro %d, gravado %d",
+                 type, rec->type);
+        replay_stop(reason);
+        return -1;
+    }
+
+    replay_offset_us += rec->delta_us;
+    replay_pos += sizeof(*rec) + rec->len;
+    replay_inputs++;
+
+    if (replay_realtime) {
+        int64_t due = session_start_ns + replay_offset_us * 1000;
+        struct timespec ts = { (time_t)(due / 1000000000LL), (long)(due % 1000000000LL) };
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+        }
+    }
+
+    if (code_out) *code_out = rec->code;
+    int copy = (rec->len < size) ? rec->len : size;
+    if (payload_out && copy > 0) {
+        memcpy(payload_out, rec + 1, copy);
+    }
+    return rec->len;
+}
+
+
+/*
+ * --- OPERAÇÕES ---
+ */
+
+void session_op_begin(int op) {
+    if (op_depth[op]++ == 0) {
+        op_since_ns[op] = now_ns();
+    }
+}
+
+void session_op_end(int op, int arg) {
+    if (op_depth[op] == 0 || --op_depth[op] > 0) {
+        return;
+    }
+
+    int64_t us = (now_ns() - op_since_ns[op]) / 1000;
+    op_account(&live_ops[op], us);
+    metrics_observe_op(op, us);
+
+    if (mode == SESSION_RECORD) {
+        uint8_t payload[8];
+        int32_t arg32 = arg;
+        uint32_t us32 = (us > UINT32_MAX) ? UINT32_MAX : (uint32_t)us;
+        memcpy(payload, &arg32, 4);
+        memcpy(payload + 4, &us32, 4);
+        session_put(SES_REC_OP, op, payload, sizeof(payload));
+    }
+}
+
+
+/*
+ * --- ENCERRAMENTO ---
+ */
+
+void session_close(void) {
+    int64_t total_us = (now_ns() - session_start_ns) / 1000;
+
+    if (mode == SESSION_RECORD) {
+        if (record_file) {
+            fclose(record_file);
+            record_file = NULL;
+        }
+        printf("[REC] Gravacao encerrada (%.1f s).\n", total_us / 1e6);
+    } else if (mode == SESSION_REPLAY) {
+        replay_stop("Sessao encerrada");
+
+        printf("\n=== REPRODUCAO: %.3f s (gravacao: %.3f s) ===\n",
+               total_us / 1e6, recorded_total_us / 1e6);
+        printf("%-10s %6s %10s %10s %10s %6s %10s %8s\n", "Operacao", "n", "media(ms)",
+               "max(ms)", "total(ms)", "n grv", "media grv", "delta");
+        for (int op = 0; op < SES_OPS; op++) {
+            const SessionOpStats *live = &live_ops[op];
+            const SessionOpStats *rec = &recorded_ops[op];
+            if (live->count == 0 && rec->count == 0) continue;
+
+            printf("%-10s %6ld", op_names[op], live->count);
+            print_ms(live->count ? live->total_us / live->count : 0);
+            print_ms(live->max_us);
+            print_ms(live->total_us);
+            printf(" %6ld", rec->count);
+            print_ms(rec->count ? rec->total_us / rec->count : 0);
+            if (live->count && rec->count && rec->total_us > 0) {
+                double live_mean = (double)live->total_us / live->count;
+                double rec_mean = (double)rec->total_us / rec->count;
+                printf(" %+7.1f%%", (live_mean - rec_mean) * 100.0 / rec_mean);
+            }
+            printf("\n");
+        }
+        printf("(menu inclui o tempo de espera por entrada; compare reproducoes no mesmo modo)\n");
+
+        free(replay_data);
+        replay_data = NULL;
+    }
+
+    mode = SESSION_OFF;
+}
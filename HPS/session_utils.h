@@ -0,0 +1,133 @@
+/*
+ * =========================================================================
+ * session_utils.h: Header da gravação e reprodução de sessões
+ * =========================================================================
+ *
+ * Grava em um arquivo binário compacto tudo o que o programa consumiu
+ * de entrada (linhas do menu, teclas, relatórios do mouse e as decisões
+ * que dependem do tempo, como quantos relatórios foram drenados juntos)
+ * e a duração de cada operação do coprocessador. A gravação é feita no
+ * ponto de consumo, não no dispositivo: na reprodução o programa recebe
+ * exatamente as mesmas entradas, na mesma ordem, e percorre o mesmo
+ * caminho, qualquer que seja a velocidade da máquina.
+ *
+ * A reprodução pode respeitar os intervalos gravados (tempo real) ou
+ * entregar cada entrada assim que pedida (o mais rápido possível). Ao
+ * final, o tempo total e o de cada tipo de operação são comparados com
+ * os da gravação: reproduções da mesma sessão em builds diferentes
+ * revelam regressões de desempenho.
+ *
+ * Formato: cabeçalho de 8 bytes ("PBLS", versão) seguido de registros
+ * com cabeçalho de 8 bytes (tipo, código, tamanho do conteúdo, µs desde
+ * o registro anterior) e o conteúdo.
+ *
+ */
+
+#ifndef SESSION_UTILS_H
+#define SESSION_UTILS_H
+
+#include <stdint.h>
+
+/* ===================================================================
+ * Constantes
+ * =================================================================== */
+
+/* Modos */
+#define SESSION_OFF    0
+#define SESSION_RECORD 1
+#define SESSION_REPLAY 2
+
+/* Tipos de registro de entrada */
+#define SES_REC_LINE     1           // Linha do menu (texto; vazio + código 1 = EOF)
+#define SES_REC_KEY      2           // Tecla devolvida por key_next (int32)
+#define SES_REC_WHEEL    3           // Giros devolvidos por key_take_wheel (int32)
+#define SES_REC_COALESCE 4           // key_coalesce_zoom: tecla final e substituídas (2 x int32)
+#define SES_REC_MOUSE    5           // Relatório do mouse (vazio = mouse perdido)
+#define SES_REC_MORE     6           // Decisão de drenagem: havia mais relatórios na fila (código)
+#define SES_REC_AVAIL    7           // Mouse disponível no momento da checagem (código)
+#define SES_REC_OP       9           // Operação concluída (código = SES_OP_*)
+#define SES_REC_ZOOM_NET 10          // key_zoom_net: passos líquidos e teclas consumidas (2 x int32)
+
+/* Operações medidas */
+#define SES_OP_MENU      0           // Opção do menu inteira (arg = opção)
+#define SES_OP_ALGORITHM 1           // Espera de um algoritmo no coprocessador (arg = status)
+#define SES_OP_UPLOAD    2           // Envio da imagem inteira para a VRAM
+#define SES_OP_REGIONAL  3           // regional_zoom_to (arg = nível alvo)
+#define SES_OP_WHEEL     4           // wheel_zoom_to (arg = nível alvo)
+#define SES_OP_READBACK  5           // Leitura de janela da VRAM (arg = pixels)
+#define SES_OPS          6
+
+#define SES_MAX_PAYLOAD  512
+
+/* ===================================================================
+ * Estruturas de Dados
+ * =================================================================== */
+
+/**
+ * @brief Relatório do mouse como gravado (independente de MousePacket)
+ */
+typedef struct {
+    int16_t dx, dy;
+    int16_t wheel;
+    uint8_t buttons, pressed, released;
+    uint8_t pad;
+    int16_t cursor_x, cursor_y;
+} SessionMouse;
+
+/* ===================================================================
+ * Protótipos das Funções
+ * =================================================================== */
+
+/**
+ * @brief Começa a gravar a sessão em um arquivo
+ * @return 0 em caso de sucesso, -1 em caso de falha
+ */
+int session_record_open(const char *path);
+
+/**
+ * @brief Carrega uma gravação para reprodução
+ * @param realtime 1 para respeitar os intervalos gravados, 0 para o mais rápido possível
+ * @return 0 em caso de sucesso, -1 em caso de falha (arquivo ausente ou inválido)
+ */
+int session_replay_open(const char *path, int realtime);
+
+/**
+ * @brief Modo atual (SESSION_OFF, SESSION_RECORD ou SESSION_REPLAY)
+ */
+int session_mode(void);
+
+/**
+ * @brief Grava uma entrada consumida (sem efeito fora do modo de gravação)
+ * @param type SES_REC_*
+ * @param code Valor pequeno do registro (0 se não usado)
+ * @param payload Conteúdo (pode ser NULL com len = 0)
+ */
+void session_put(int type, int code, const void *payload, int len);
+
+/**
+ * @brief Próxima entrada gravada (modo de reprodução)
+ *
+ * Em tempo real, espera até o instante em que ela foi consumida na
+ * gravação. Um tipo diferente do pedido significa que o programa tomou
+ * outro caminho: a reprodução é encerrada.
+ * @param code_out Código do registro (pode ser NULL)
+ * @param payload_out Buffer do conteúdo (pode ser NULL)
+ * @param size Tamanho do buffer
+ * @return Tamanho do conteúdo, ou -1 no fim da gravação ou dessincronia
+ */
+int session_get(int type, int *code_out, void *payload_out, int size);
+
+/**
+ * @brief Marca início e fim de uma operação (medida em todos os modos)
+ *
+ * Na gravação, o fim também vira um registro SES_REC_OP.
+ */
+void session_op_begin(int op);
+void session_op_end(int op, int arg);
+
+/**
+ * @brief Encerra a sessão: fecha a gravação ou imprime o relatório da reprodução
+ */
+void session_close(void);
+
+#endif /* SESSION_UTILS_H */
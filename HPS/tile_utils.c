@@ -0,0 +1,140 @@
+#include <stdint.h>
+#include <string.h>
+#include "tile_utils.h"
+#include "vram_utils.h"
+
+
+/*
+ * --- CONVERSÃO ---
+ */
+
+void tiled_from_linear(TiledFrame *tf, const uint8_t *linear) {
+    for (int ty = 0; ty < TILES_Y; ty++) {
+        for (int tx = 0; tx < TILES_X; tx++) {
+            uint8_t *tile = tf->tiles[ty * TILES_X + tx];
+            const uint8_t *src = linear + ty * TILE_SIZE * IMG_WIDTH + tx * TILE_SIZE;
+
+            for (int row = 0; row < TILE_SIZE; row++) {
+                memcpy(tile + row * TILE_SIZE, src + row * IMG_WIDTH, TILE_SIZE);
+            }
+        }
+    }
+    memset(tf->dirty, 1, sizeof(tf->dirty));
+}
+
+
+/*
+ * --- OPERAÇÕES DE REGIÃO ---
+ */
+
+void tiled_extract_rect(const TiledFrame *tf, int x, int y, int width, int height,
+                        uint8_t *dst, int dst_stride) {
+    for (int ty = y / TILE_SIZE; ty <= (y + height - 1) / TILE_SIZE; ty++) {
+        int y0 = (ty * TILE_SIZE > y) ? ty * TILE_SIZE : y;
+        int y1 = ((ty + 1) * TILE_SIZE < y + height) ? (ty + 1) * TILE_SIZE : y + height;
+
+        for (int tx = x / TILE_SIZE; tx <= (x + width - 1) / TILE_SIZE; tx++) {
+            int x0 = (tx * TILE_SIZE > x) ? tx * TILE_SIZE : x;
+            int x1 = ((tx + 1) * TILE_SIZE < x + width) ? (tx + 1) * TILE_SIZE : x + width;
+            const uint8_t *tile = tf->tiles[ty * TILES_X + tx];
+
+            for (int py = y0; py < y1; py++) {
+                memcpy(dst + (py - y) * dst_stride + (x0 - x),
+                       tile + (py % TILE_SIZE) * TILE_SIZE + x0 % TILE_SIZE,
+                       x1 - x0);
+            }
+        }
+    }
+}
+
+void tiled_blit_rect(TiledFrame *tf, const uint8_t *src, int src_stride,
+                     int x, int y, int width, int height) {
+    for (int ty = y / TILE_SIZE; ty <= (y + height - 1) / TILE_SIZE; ty++) {
+        int y0 = (ty * TILE_SIZE > y) ? ty * TILE_SIZE : y;
+        int y1 = ((ty + 1) * TILE_SIZE < y + height) ? (ty + 1) * TILE_SIZE : y + height;
+
+        for (int tx = x / TILE_SIZE; tx <= (x + width - 1) / TILE_SIZE; tx++) {
+            int x0 = (tx * TILE_SIZE > x) ? tx * TILE_SIZE : x;
+            int x1 = ((tx + 1) * TILE_SIZE < x + width) ? (tx + 1) * TILE_SIZE : x + width;
+            int index = ty * TILES_X + tx;
+            uint8_t *tile = tf->tiles[index];
+
+            for (int py = y0; py < y1; py++) {
+                uint8_t *line = tile + (py % TILE_SIZE) * TILE_SIZE + x0 % TILE_SIZE;
+                const uint8_t *from = src + (py - y) * src_stride + (x0 - x);
+
+                if (memcmp(line, from, x1 - x0) != 0) {
+                    memcpy(line, from, x1 - x0);
+                    tf->dirty[index] = 1;
+                }
+            }
+        }
+    }
+}
+
+void tiled_copy_rect(TiledFrame *dst, const TiledFrame *src,
+                     int x, int y, int width, int height) {
+    for (int ty = y / TILE_SIZE; ty <= (y + height - 1) / TILE_SIZE; ty++) {
+        int y0 = (ty * TILE_SIZE > y) ? ty * TILE_SIZE : y;
+        int y1 = ((ty + 1) * TILE_SIZE < y + height) ? (ty + 1) * TILE_SIZE : y + height;
+
+        for (int tx = x / TILE_SIZE; tx <= (x + width - 1) / TILE_SIZE; tx++) {
+            int x0 = (tx * TILE_SIZE > x) ? tx * TILE_SIZE : x;
+            int x1 = ((tx + 1) * TILE_SIZE < x + width) ? (tx + 1) * TILE_SIZE : x + width;
+            int index = ty * TILES_X + tx;
+
+            // Bloco inteiro coberto: uma comparação e uma cópia contíguas
+            if (x1 - x0 == TILE_SIZE && y1 - y0 == TILE_SIZE) {
+                if (memcmp(dst->tiles[index], src->tiles[index], TILE_PIXELS) != 0) {
+                    memcpy(dst->tiles[index], src->tiles[index], TILE_PIXELS);
+                    dst->dirty[index] = 1;
+                }
+                continue;
+            }
+
+            for (int py = y0; py < y1; py++) {
+                int offset = (py % TILE_SIZE) * TILE_SIZE + x0 % TILE_SIZE;
+                if (memcmp(dst->tiles[index] + offset, src->tiles[index] + offset, x1 - x0) != 0) {
+                    memcpy(dst->tiles[index] + offset, src->tiles[index] + offset, x1 - x0);
+                    dst->dirty[index] = 1;
+                }
+            }
+        }
+    }
+}
+
+void tiled_mark_all(TiledFrame *tf) {
+    memset(tf->dirty, 1, sizeof(tf->dirty));
+}
+
+
+/*
+ * --- ENVIO À VRAM ---
+ */
+
+int tiled_upload_dirty(TiledFrame *tf, int *tiles_out) {
+    int sent = 0;
+    int tiles = 0;
+
+    for (int index = 0; index < TILE_COUNT; index++) {
+        if (!tf->dirty[index]) continue;
+
+        int x = (index % TILES_X) * TILE_SIZE;
+        int y = (index / TILES_X) * TILE_SIZE;
+
+        // O bloco já está em linhas de TILE_SIZE bytes: basta o passo certo
+        int result = vram_sync_rect(tf->tiles[index], TILE_SIZE, x, y, TILE_SIZE, TILE_SIZE);
+        if (result < 0) {
+            return -1;
+        }
+
+        tf->dirty[index] = 0;
+        sent += result;
+        tiles++;
+    }
+
+    if (tiles_out) {
+        *tiles_out = tiles;
+    }
+    return sent;
+}
@@ -0,0 +1,93 @@
+/*
+ * =========================================================================
+ * tile_utils.h: Header do quadro em blocos (tiled frame)
+ * =========================================================================
+ *
+ * Representação interna de um quadro IMG_WIDTH x IMG_HEIGHT dividido em
+ * blocos de TILE_SIZE x TILE_SIZE, cada bloco contíguo na memória (256
+ * bytes = 8 linhas de cache de 32 bytes no Cortex-A9). Operações de
+ * região (extração, sobreposição, detecção de diferenças) tocam apenas
+ * os blocos envolvidos, e cada bloco tem um bit de "sujo" que indica se
+ * precisa ser reenviado à VRAM.
+ *
+ * O envio lê cada bloco direto com passo TILE_SIZE, sem conversão para
+ * linhas (row-major); leituras de volta usam tiled_extract_rect.
+ *
+ */
+
+#ifndef TILE_UTILS_H
+#define TILE_UTILS_H
+
+#include <stdint.h>
+#include "api.h"
+
+/* ===================================================================
+ * Constantes
+ * =================================================================== */
+#define TILE_SIZE 16
+#define TILE_PIXELS (TILE_SIZE * TILE_SIZE)
+#define TILES_X (IMG_WIDTH / TILE_SIZE)       // 20
+#define TILES_Y (IMG_HEIGHT / TILE_SIZE)      // 15
+#define TILE_COUNT (TILES_X * TILES_Y)        // 300
+
+/* ===================================================================
+ * Estruturas de Dados
+ * =================================================================== */
+
+/**
+ * @brief Quadro em blocos com bits de sujo por bloco
+ */
+typedef struct {
+    uint8_t tiles[TILE_COUNT][TILE_PIXELS];  // Bloco (tx, ty) em tiles[ty * TILES_X + tx]
+    uint8_t dirty[TILE_COUNT];               // 1 = bloco difere do que está na VRAM
+} TiledFrame;
+
+/* ===================================================================
+ * Protótipos das Funções
+ * =================================================================== */
+
+/**
+ * @brief Converte um quadro em linhas para blocos (marca tudo como sujo)
+ */
+void tiled_from_linear(TiledFrame *tf, const uint8_t *linear);
+
+/**
+ * @brief Copia um retângulo do quadro em blocos para um buffer em linhas
+ * @param dst Buffer de destino (width x height)
+ * @param dst_stride Largura de linha do destino
+ */
+void tiled_extract_rect(const TiledFrame *tf, int x, int y, int width, int height,
+                        uint8_t *dst, int dst_stride);
+
+/**
+ * @brief Sobrepõe um buffer em linhas ao quadro em blocos
+ *
+ * Apenas blocos cujo conteúdo realmente muda são marcados como sujos.
+ * @param src Buffer de origem (width x height)
+ * @param src_stride Largura de linha da origem
+ */
+void tiled_blit_rect(TiledFrame *tf, const uint8_t *src, int src_stride,
+                     int x, int y, int width, int height);
+
+/**
+ * @brief Copia um retângulo entre dois quadros em blocos
+ *
+ * Blocos inteiramente cobertos são copiados com um único memcpy.
+ * Apenas blocos alterados de 'dst' são marcados como sujos.
+ */
+void tiled_copy_rect(TiledFrame *dst, const TiledFrame *src,
+                     int x, int y, int width, int height);
+
+/**
+ * @brief Marca todos os blocos como sujos (ex.: VRAM em estado desconhecido)
+ */
+void tiled_mark_all(TiledFrame *tf);
+
+/**
+ * @brief Envia os blocos sujos à VRAM (apenas pixels diferentes do espelho)
+ * @param tiles_out Saída opcional: número de blocos processados
+ * @return Número de pixels enviados, ou -1 em caso de falha
+ */
+int tiled_upload_dirty(TiledFrame *tf, int *tiles_out);
+
+#endif /* TILE_UTILS_H */
@@ -0,0 +1,268 @@
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include "api.h"
+#include "timing_utils.h"
+
+/**
+ * @brief Resultado de uma medição (TIMING_SAMPLES operações)
+ */
+typedef struct {
+    double avg_ns;
+    long p99_ns;
+    double polls_per_op;
+} TimingSample;
+
+static DriverTiming timing = {
+    .timeout_polls = DRV_DEFAULT_TIMEOUT_POLLS,
+    .settle_loops = DRV_DEFAULT_SETTLE_LOOPS,
+};
+
+
+/*
+ * --- FUNÇÕES INTERNAS ---
+ */
+
+static int64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int compare_long(const void *a, const void *b) {
+    long x = *(const long*)a;
+    long y = *(const long*)b;
+    return (x > y) - (x < y);
+}
+
+// Cronometra LOADs (ou STOREs do mesmo valor) no endereço 0 da Memória Principal
+static int measure(int store, unsigned int settle_loops, TimingSample *out) {
+    long samples[TIMING_SAMPLES];
+    int64_t total = 0;
+
+    ASM_Set_Timing(DRV_DEFAULT_TIMEOUT_POLLS, settle_loops);
+    int value = ASM_Load(0, 0);
+    if (value < 0) {
+        return -1;
+    }
+    ASM_Clear_Stats();
+
+    for (int i = 0; i < TIMING_SAMPLES; i++) {
+        int64_t start = now_ns();
+        int status = store ? ASM_Store(0, (unsigned char)value, 0) : ASM_Load(0, 0);
+        samples[i] = (long)(now_ns() - start);
+        if (status < 0) {
+            return -1;
+        }
+        total += samples[i];
+    }
+
+    DriverStats stats;
+    ASM_Get_Stats(&stats);
+    qsort(samples, TIMING_SAMPLES, sizeof(long), compare_long);
+
+    out->avg_ns = (double)total / TIMING_SAMPLES;
+    out->p99_ns = samples[TIMING_SAMPLES * 99 / 100];
+    out->polls_per_op = (double)stats.total_spin / TIMING_SAMPLES;
+    return 0;
+}
+
+// Escreve e relê TIMING_SETTLE_RUN pixels com a espera dada; 1 se tudo conferiu
+static int settle_holds(unsigned int settle_loops) {
+    ASM_Set_Timing(DRV_DEFAULT_TIMEOUT_POLLS, settle_loops);
+
+    for (int round = 0; round < TIMING_SETTLE_ROUNDS; round++) {
+        // Cada rodada troca todos os valores: um pixel não escrito não confere
+        int mask = (round & 1) ? 0xAA : 0x55;
+        for (int i = 0; i < TIMING_SETTLE_RUN; i++) {
+            if (ASM_Store(i, (unsigned char)((i * 7 + round) ^ mask), 0) < 0) {
+                return 0;
+            }
+        }
+        for (int i = 0; i < TIMING_SETTLE_RUN; i++) {
+            if (ASM_Load(i, 0) != (((i * 7 + round) ^ mask) & 0xFF)) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+// Menor espera correta entre DRV_DEFAULT_SETTLE_LOOPS / 2^k; -1 se nem o padrão passa
+static long find_settle_loops(void) {
+    uint8_t saved[TIMING_SETTLE_RUN];
+    long smallest = -1;
+
+    ASM_Set_Timing(DRV_DEFAULT_TIMEOUT_POLLS, DRV_DEFAULT_SETTLE_LOOPS);
+    for (int i = 0; i < TIMING_SETTLE_RUN; i++) {
+        int value = ASM_Load(i, 0);
+        if (value < 0) {
+            return -1;
+        }
+        saved[i] = (uint8_t)value;
+    }
+
+    for (int step = 0; step <= TIMING_SETTLE_STEPS; step++) {
+        unsigned int loops = (step < TIMING_SETTLE_STEPS) ? (DRV_DEFAULT_SETTLE_LOOPS >> step) : 0;
+        if (!settle_holds(loops)) {
+            break;
+        }
+        smallest = loops;
+    }
+
+    ASM_Set_Timing(DRV_DEFAULT_TIMEOUT_POLLS, DRV_DEFAULT_SETTLE_LOOPS);
+    for (int i = 0; i < TIMING_SETTLE_RUN; i++) {
+        ASM_Store(i, saved[i], 0);
+    }
+    return smallest;
+}
+
+// Converte para contagem do driver sem estourar unsigned int
+static unsigned int to_count(double value, unsigned int minimum) {
+    if (value >= (double)UINT_MAX) {
+        return UINT_MAX;
+    }
+    if (value < minimum) {
+        return minimum;
+    }
+    return (unsigned int)(value + 0.5);
+}
+
+// Lê "chave = valor" de TIMING_CONFIG_FILE (arquivo ausente não é erro)
+static void load_config(long *timeout_ns, long *settle_ns) {
+    FILE *file = fopen(TIMING_CONFIG_FILE, "r");
+    char line[128];
+    int line_no = 0;
+
+    if (!file) {
+        return;
+    }
+    while (fgets(line, sizeof(line), file)) {
+        char key[32];
+        long value;
+        line_no++;
+
+        char *comment = strchr(line, '#');
+        if (comment) {
+            *comment = '\0';
+        }
+        if (sscanf(line, " %31[a-z_] = %ld", key, &value) != 2) {
+            if (strspn(line, " \t\r\n") != strlen(line)) {
+                printf("!!! AVISO: %s:%d ignorada.\n", TIMING_CONFIG_FILE, line_no);
+            }
+            continue;
+        }
+        if (value < 0) {
+            printf("!!! AVISO: %s:%d: valor negativo ignorado.\n", TIMING_CONFIG_FILE, line_no);
+        } else if (strcmp(key, "timeout_ns") == 0) {
+            *timeout_ns = value;
+            timing.timeout_from_file = 1;
+        } else if (strcmp(key, "settle_ns") == 0) {
+            *settle_ns = value;
+            timing.settle_from_file = 1;
+        } else {
+            printf("!!! AVISO: %s:%d: chave '%s' desconhecida.\n", TIMING_CONFIG_FILE, line_no, key);
+        }
+    }
+    fclose(file);
+}
+
+
+/*
+ * --- CALIBRAÇÃO ---
+ */
+
+int timing_calibrate(void) {
+    TimingSample load, store, load_settle;
+
+    timing.calibrated = 0;
+    if (measure(0, 0, &load) != 0 || measure(1, 0, &store) != 0 ||
+        measure(0, DRV_DEFAULT_SETTLE_LOOPS, &load_settle) != 0 ||
+        load_settle.avg_ns <= load.avg_ns) {
+        ASM_Set_Timing(DRV_DEFAULT_TIMEOUT_POLLS, DRV_DEFAULT_SETTLE_LOOPS);
+        ASM_Clear_Stats();
+        return -1;
+    }
+
+    timing.loop_ns = (load_settle.avg_ns - load.avg_ns) / DRV_DEFAULT_SETTLE_LOOPS;
+    timing.polls_per_op = (load.polls_per_op + store.polls_per_op) / 2;
+    timing.op_p99_ns = (load.p99_ns > store.p99_ns) ? load.p99_ns : store.p99_ns;
+
+    // Sem espera, a operação é o pulso mais as leituras de flags: o custo
+    // por leitura fica superestimado, o que o piso em leituras compensa
+    double op_ns = (load.avg_ns + store.avg_ns) / 2;
+    timing.poll_ns = op_ns / ((timing.polls_per_op > 1) ? timing.polls_per_op : 1);
+
+    long timeout_ns = timing.op_p99_ns * TIMING_TIMEOUT_MARGIN;
+    if (timeout_ns < TIMING_MIN_TIMEOUT_NS) timeout_ns = TIMING_MIN_TIMEOUT_NS;
+    if (timeout_ns > TIMING_MAX_TIMEOUT_NS) timeout_ns = TIMING_MAX_TIMEOUT_NS;
+
+    // Um passo de margem acima da menor espera correta (o dobro, ou o menor passo se 0 passou)
+    long smallest = find_settle_loops();
+    unsigned int settle_loops = DRV_DEFAULT_SETTLE_LOOPS;
+    timing.settle_measured = (smallest >= 0);
+    if (timing.settle_measured) {
+        timing.settle_min_loops = (unsigned int)smallest;
+        settle_loops = (smallest > 0) ? (unsigned int)smallest * 2
+                                      : (DRV_DEFAULT_SETTLE_LOOPS >> (TIMING_SETTLE_STEPS - 1));
+        if (settle_loops > DRV_DEFAULT_SETTLE_LOOPS) {
+            settle_loops = DRV_DEFAULT_SETTLE_LOOPS;
+        }
+    }
+    long settle_ns = (long)(settle_loops * timing.loop_ns);
+
+    load_config(&timeout_ns, &settle_ns);
+    timing.timeout_ns = timeout_ns;
+    timing.settle_ns = settle_ns;
+
+    double polls = timeout_ns / timing.poll_ns;
+    if (!timing.timeout_from_file) {
+        double floor_polls = TIMING_TIMEOUT_MARGIN * timing.polls_per_op;
+        if (polls < floor_polls) polls = floor_polls;
+        if (polls < TIMING_MIN_POLLS) polls = TIMING_MIN_POLLS;
+    }
+    timing.timeout_polls = to_count(polls, 1);
+    timing.settle_loops = timing.settle_from_file ? to_count(settle_ns / timing.loop_ns, 0) : settle_loops;
+    timing.calibrated = 1;
+
+    ASM_Set_Timing(timing.timeout_polls, timing.settle_loops);
+    ASM_Clear_Stats();
+    return 0;
+}
+
+const DriverTiming *timing_current(void) {
+    return &timing;
+}
+
+
+/*
+ * --- RELATÓRIO ---
+ */
+
+void timing_dump(void) {
+    printf("\n=== TEMPOS DO DRIVER ===\n");
+    if (!timing.calibrated) {
+        printf("Sem calibracao: padroes de lib.s (%u leituras de flags, %u voltas de espera)\n",
+               timing.timeout_polls, timing.settle_loops);
+        return;
+    }
+    printf("Medido: %.1f ns por leitura de flags, %.2f ns por volta de espera\n",
+           timing.poll_ns, timing.loop_ns);
+    printf("        %.1f leituras de flags por operacao, p99 de %ld ns sem espera\n",
+           timing.polls_per_op, timing.op_p99_ns);
+    printf("Timeout: %ld ns = %u leituras de flags%s\n", timing.timeout_ns, timing.timeout_polls,
+           timing.timeout_from_file ? " (" TIMING_CONFIG_FILE ")" : "");
+    printf("Espera:  %ld ns = %u voltas por pixel", timing.settle_ns, timing.settle_loops);
+    if (timing.settle_from_file) {
+        printf(" (" TIMING_CONFIG_FILE ")\n");
+    } else if (timing.settle_measured) {
+        printf(" (menor correta: %u voltas, mais um passo de margem)\n", timing.settle_min_loops);
+    } else {
+        printf(" (padrao de lib.s: releitura incorreta mesmo com ele)\n");
+    }
+}
@@ -0,0 +1,95 @@
+/*
+ * =========================================================================
+ * timing_utils.h: Header da calibração dos tempos do driver (lib.s)
+ * =========================================================================
+ *
+ * O driver espera o FLAG_DONE de cada LOAD/STORE por um número fixo de
+ * leituras de flags (TIMEOUT_LIMIT) e, depois de cada pixel, gasta um
+ * laço de espera fixo (DELAY_COUNT). Quanto tempo isso dura depende da
+ * frequência da CPU e do estado das caches.
+ *
+ * Na inicialização, uma sequência de LOADs e STOREs na Memória Principal
+ * é cronometrada (clock_gettime, relógio monotônico), junto com os
+ * contadores do driver (leituras de flags por operação). Disso saem:
+ *
+ *   timeout - TIMING_TIMEOUT_MARGIN x a operação mais lenta medida (p99)
+ *   espera  - a menor espera com que um trecho escrito e relido logo em
+ *             seguida continua correto (testada do DELAY_COUNT padrão
+ *             para baixo, pela metade a cada passo), mais um passo de
+ *             margem; se nem o padrão passa, o padrão fica
+ *
+ * Os dois são guardados em nanossegundos e convertidos para o driver
+ * (leituras de flags e voltas do laço de espera, ASM_Set_Timing). O
+ * arquivo TIMING_CONFIG_FILE, se existir, substitui qualquer um deles:
+ *
+ *   # comentário
+ *   timeout_ns = 200000
+ *   settle_ns  = 0
+ *
+ */
+
+#ifndef TIMING_UTILS_H
+#define TIMING_UTILS_H
+
+/* ===================================================================
+ * Constantes
+ * =================================================================== */
+#define TIMING_CONFIG_FILE    "coproc_timing.cfg"
+#define TIMING_SAMPLES        256        // Operações cronometradas por medição
+#define TIMING_TIMEOUT_MARGIN 8
+#define TIMING_MIN_TIMEOUT_NS 20000L     // Limites do timeout calculado
+#define TIMING_MAX_TIMEOUT_NS 10000000L
+#define TIMING_MIN_POLLS      256        // Mínimo de leituras de flags por tentativa
+#define TIMING_SETTLE_RUN     32         // Pixels escritos e relidos por rodada
+#define TIMING_SETTLE_ROUNDS  8          // Rodadas por espera testada
+#define TIMING_SETTLE_STEPS   9          // Padrão, 1/2, ..., 1/256 (e por fim 0)
+
+/* ===================================================================
+ * Estruturas de Dados
+ * =================================================================== */
+
+/**
+ * @brief Tempos do driver e as medições de onde vieram
+ */
+typedef struct {
+    int calibrated;                  // Medições válidas (senão, padrões de lib.s)
+    double poll_ns;                  // Custo de uma leitura de flags
+    double loop_ns;                  // Custo de uma volta do laço de espera
+    double polls_per_op;             // Leituras de flags até o FLAG_DONE (média)
+    long op_p99_ns;                  // LOAD/STORE sem espera, percentil 99
+    long timeout_ns;
+    long settle_ns;
+    int timeout_from_file;           // Valor de TIMING_CONFIG_FILE
+    int settle_from_file;
+    int settle_measured;             // Espera mínima encontrada (senão, o padrão)
+    unsigned int settle_min_loops;   // Menor espera em que as releituras conferiram
+    unsigned int timeout_polls;      // Entregues a ASM_Set_Timing
+    unsigned int settle_loops;
+} DriverTiming;
+
+/* ===================================================================
+ * Protótipos das Funções
+ * =================================================================== */
+
+/**
+ * @brief Mede os tempos, aplica TIMING_CONFIG_FILE e configura o driver
+ *
+ * Deve rodar com o coprocessador parado (após o Reset). Escreve padrões
+ * de teste nos primeiros TIMING_SETTLE_RUN pixels da Memória Principal e
+ * restaura o conteúdo anterior; zera os contadores do driver no fim.
+ * @return 0 se calibrado, -1 se as medições falharam (ficam os padrões
+ *         de lib.s: sem os custos medidos o arquivo não tem como ser convertido)
+ */
+int timing_calibrate(void);
+
+/**
+ * @brief Tempos em uso
+ */
+const DriverTiming *timing_current(void);
+
+/**
+ * @brief Imprime os tempos em uso e de onde vieram
+ */
+void timing_dump(void);
+
+#endif /* TIMING_UTILS_H */
@@ -0,0 +1,228 @@
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "api.h"
+#include "vram_utils.h"
+#include "tile_utils.h"
+#include "metrics_utils.h"
+#include "verify_utils.h"
+
+/* Tabelas do CRC32: crc_table[k][b] = CRC de b seguido de k bytes zero */
+static uint32_t crc_table[8][256];
+static int crc_ready;
+
+static uint32_t rng_state;
+
+/* Totais */
+static long runs, tiles_checked, tiles_bad, pixels_read;
+static double total_ms;
+
+
+/*
+ * --- FUNÇÕES INTERNAS ---
+ */
+
+static void crc_init(void) {
+    for (int b = 0; b < 256; b++) {
+        uint32_t crc = (uint32_t)b;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+        }
+        crc_table[0][b] = crc;
+    }
+    for (int b = 0; b < 256; b++) {
+        for (int k = 1; k < 8; k++) {
+            uint32_t prev = crc_table[k - 1][b];
+            crc_table[k][b] = (prev >> 8) ^ crc_table[0][prev & 0xFF];
+        }
+    }
+    crc_ready = 1;
+}
+
+// Sorteio xorshift32 (semente do relógio na primeira chamada)
+static uint32_t rng_next(void) {
+    if (rng_state == 0) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        rng_state = (uint32_t)(ts.tv_nsec ^ (ts.tv_sec << 16)) | 1;
+    }
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+// Copia o bloco (tx, ty) de um quadro em linhas para 256 bytes contíguos
+static void gather_tile(const uint8_t *frame, int tx, int ty, uint8_t *tile) {
+    const uint8_t *src = frame + ty * TILE_SIZE * IMG_WIDTH + tx * TILE_SIZE;
+    for (int row = 0; row < TILE_SIZE; row++) {
+        memcpy(tile + row * TILE_SIZE, src + row * IMG_WIDTH, TILE_SIZE);
+    }
+}
+
+// Lê o bloco (tx, ty) da Memória Principal; retorna o número de leituras com erro
+static int load_tile(int tx, int ty, uint8_t *tile) {
+    int errors = 0;
+
+    for (int row = 0; row < TILE_SIZE; row++) {
+        int addr = (ty * TILE_SIZE + row) * IMG_WIDTH + tx * TILE_SIZE;
+        for (int col = 0; col < TILE_SIZE; col++) {
+            int value = ASM_Load(addr + col, 0);
+            if (value < 0 || value > 255) {
+                errors++;
+                value = 0;
+            }
+            tile[row * TILE_SIZE + col] = (uint8_t)value;
+        }
+    }
+    return errors;
+}
+
+
+/*
+ * --- CRC32 ---
+ */
+
+uint32_t verify_crc32(uint32_t crc, const uint8_t *data, size_t len) {
+    if (!crc_ready) {
+        crc_init();
+    }
+    crc = ~crc;
+
+    // 8 bytes por passo: as 8 consultas são independentes entre si
+    while (len >= 8) {
+        uint32_t lo = crc ^ ((uint32_t)data[0] | (uint32_t)data[1] << 8 |
+                             (uint32_t)data[2] << 16 | (uint32_t)data[3] << 24);
+        uint32_t hi = (uint32_t)data[4] | (uint32_t)data[5] << 8 |
+                      (uint32_t)data[6] << 16 | (uint32_t)data[7] << 24;
+        crc = crc_table[7][lo & 0xFF] ^ crc_table[6][(lo >> 8) & 0xFF] ^
+              crc_table[5][(lo >> 16) & 0xFF] ^ crc_table[4][lo >> 24] ^
+              crc_table[3][hi & 0xFF] ^ crc_table[2][(hi >> 8) & 0xFF] ^
+              crc_table[1][(hi >> 16) & 0xFF] ^ crc_table[0][hi >> 24];
+        data += 8;
+        len -= 8;
+    }
+    while (len-- > 0) {
+        crc = (crc >> 8) ^ crc_table[0][(crc ^ *data++) & 0xFF];
+    }
+    return ~crc;
+}
+
+
+/*
+ * --- VERIFICAÇÃO ---
+ */
+
+int verify_primary(int percent, VerifyReport *out) {
+    static uint16_t order[TILE_COUNT];
+    uint8_t expected[TILE_PIXELS];
+    uint8_t actual[TILE_PIXELS];
+    VerifyReport report;
+    struct timespec start, end;
+
+    if (!vram_mirror_valid()) {
+        printf("   [C] AVISO: espelho invalido, nada para verificar.\n");
+        return -1;
+    }
+    if (percent < 1) percent = 1;
+    if (percent > 100) percent = 100;
+
+    memset(&report, 0, sizeof(report));
+    report.percent = percent;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    // Sorteio sem repetição dos primeiros `count` blocos (Fisher-Yates parcial)
+    int count = (TILE_COUNT * percent + 99) / 100;
+    for (int i = 0; i < TILE_COUNT; i++) {
+        order[i] = (uint16_t)i;
+    }
+    if (count < TILE_COUNT) {
+        for (int i = 0; i < count; i++) {
+            int j = i + (int)(rng_next() % (uint32_t)(TILE_COUNT - i));
+            uint16_t swap = order[i];
+            order[i] = order[j];
+            order[j] = swap;
+        }
+    }
+
+    const uint8_t *mirror = vram_mirror();
+    for (int i = 0; i < count; i++) {
+        int tx = order[i] % TILES_X;
+        int ty = order[i] / TILES_X;
+
+        gather_tile(mirror, tx, ty, expected);
+        int errors = load_tile(tx, ty, actual);
+        uint32_t expected_crc = verify_crc32(0, expected, TILE_PIXELS);
+        uint32_t actual_crc = verify_crc32(0, actual, TILE_PIXELS);
+
+        report.tiles_checked++;
+        report.read_errors += errors;
+        if (expected_crc == actual_crc && errors == 0) {
+            continue;
+        }
+
+        report.tiles_bad++;
+        if (report.reported < VERIFY_MAX_REPORTED) {
+            VerifyMismatch *m = &report.mismatches[report.reported++];
+            m->tx = tx;
+            m->ty = ty;
+            m->expected_crc = expected_crc;
+            m->actual_crc = actual_crc;
+            m->pixels = 0;
+            for (int p = 0; p < TILE_PIXELS; p++) {
+                m->pixels += (expected[p] != actual[p]);
+            }
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    report.ms = (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1e6;
+
+    runs++;
+    tiles_checked += report.tiles_checked;
+    tiles_bad += report.tiles_bad;
+    pixels_read += (long)report.tiles_checked * TILE_PIXELS;
+    total_ms += report.ms;
+    met_add(MET_VERIFY_TILES, report.tiles_checked);
+    met_add(MET_VERIFY_TILES_BAD, report.tiles_bad);
+
+    if (out) {
+        *out = report;
+    }
+    return report.tiles_bad;
+}
+
+
+/*
+ * --- RELATÓRIO ---
+ */
+
+void verify_print(const VerifyReport *report) {
+    printf("   [C] Verificacao da VRAM (%d%%): %d de %d blocos lidos, %d divergente(s), %.1f ms\n",
+           report->percent, report->tiles_checked, TILE_COUNT, report->tiles_bad, report->ms);
+    if (report->read_errors > 0) {
+        printf("   [C] %d leitura(s) com erro\n", report->read_errors);
+    }
+    for (int i = 0; i < report->reported; i++) {
+        const VerifyMismatch *m = &report->mismatches[i];
+        printf("       bloco (%2d,%2d) em (%3d,%3d): CRC %08X esperado, %08X lido, %d pixel(s) diferente(s)\n",
+               m->tx, m->ty, m->tx * TILE_SIZE, m->ty * TILE_SIZE,
+               m->expected_crc, m->actual_crc, m->pixels);
+    }
+    if (report->tiles_bad > report->reported) {
+        printf("       ... e mais %d bloco(s)\n", report->tiles_bad - report->reported);
+    }
+}
+
+void verify_dump(void) {
+    printf("\n=== VERIFICACAO DA VRAM ===\n");
+    if (runs == 0) {
+        printf("Nenhuma verificacao (use --verify ou o passo verify).\n");
+        return;
+    }
+    printf("%ld verificacao(oes): %ld blocos lidos, %ld divergentes | %ld pixels lidos, %.1f ms no total\n",
+           runs, tiles_checked, tiles_bad, pixels_read, total_ms);
+}
@@ -0,0 +1,85 @@
+/*
+ * =========================================================================
+ * verify_utils.h: Header da verificação de integridade da VRAM
+ * =========================================================================
+ *
+ * Confere se a Memória Principal do FPGA tem o conteúdo do espelho
+ * (vram_utils.h) sem ler o quadro inteiro: a comparação é por bloco de
+ * TILE_SIZE x TILE_SIZE (tile_utils.h), com o CRC32 do bloco no espelho
+ * contra o CRC32 do mesmo bloco lido do barramento. Com uma fração
+ * menor que 100% apenas blocos sorteados são lidos, de modo que uma
+ * verificação em produção custa essa fração de uma leitura completa.
+ *
+ * O CRC32 (polinômio 0xEDB88320, o mesmo do zlib) usa tabelas
+ * "slicing-by-8": 8 bytes por passo, sem dependência entre as consultas
+ * de um mesmo passo.
+ *
+ */
+
+#ifndef VERIFY_UTILS_H
+#define VERIFY_UTILS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* ===================================================================
+ * Constantes
+ * =================================================================== */
+#define VERIFY_MAX_REPORTED 16       // Blocos divergentes guardados no relatório
+
+/* ===================================================================
+ * Estruturas de Dados
+ * =================================================================== */
+
+/**
+ * @brief Um bloco cuja leitura não confere com o espelho
+ */
+typedef struct {
+    int tx, ty;                      // Bloco (pixels tx*TILE_SIZE, ty*TILE_SIZE)
+    uint32_t expected_crc;
+    uint32_t actual_crc;
+    int pixels;                      // Pixels diferentes no bloco
+} VerifyMismatch;
+
+/**
+ * @brief Resultado de uma verificação
+ */
+typedef struct {
+    int percent;                     // Fração pedida do quadro
+    int tiles_checked;
+    int tiles_bad;
+    int read_errors;                 // ASM_Load com erro (contam como divergência)
+    double ms;
+    int reported;                    // Entradas válidas em mismatches
+    VerifyMismatch mismatches[VERIFY_MAX_REPORTED];
+} VerifyReport;
+
+/* ===================================================================
+ * Protótipos das Funções
+ * =================================================================== */
+
+/**
+ * @brief CRC32 de um buffer, continuando de um CRC anterior (0 no início)
+ */
+uint32_t verify_crc32(uint32_t crc, const uint8_t *data, size_t len);
+
+/**
+ * @brief Compara a Memória Principal com o espelho
+ * @param percent Fração dos blocos lida (1-100); abaixo de 100 os blocos
+ *                são sorteados a cada chamada
+ * @param out Relatório (pode ser NULL)
+ * @return Número de blocos divergentes, ou -1 se o espelho não é válido
+ */
+int verify_primary(int percent, VerifyReport *out);
+
+/**
+ * @brief Imprime o relatório de uma verificação
+ */
+void verify_print(const VerifyReport *report);
+
+/**
+ * @brief Imprime os totais de todas as verificações
+ */
+void verify_dump(void);
+
+#endif /* VERIFY_UTILS_H */
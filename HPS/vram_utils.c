@@ -0,0 +1,192 @@
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include "api.h"
+#include "vram_utils.h"
+#include "latency_utils.h"
+
+/* Espelho da Memória Principal (mem_sel = 0) */
+static uint8_t mirror[IMG_SIZE];
+static int mirror_is_valid = 0;
+
+/* Hash do espelho: XOR de mix(endereço, valor) sobre todos os pixels */
+static uint32_t mirror_hash = 0;
+static int mirror_hash_ready = 0;
+
+/* Código de retorno (ERR_*) da última escrita que falhou */
+static int last_error = ERR_SUCCESS;
+
+
+/*
+ * --- FUNÇÕES INTERNAS ---
+ */
+
+// Espalha (endereço, valor) em 32 bits (finalizador do MurmurHash3)
+static inline uint32_t pixel_mix(int addr, uint8_t value) {
+    uint32_t h = ((uint32_t)addr << 8) | value;
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+// Troca um pixel do espelho mantendo o hash
+static inline void mirror_set(int addr, uint8_t value) {
+    if (!mirror_hash_ready) {
+        for (int i = 0; i < IMG_SIZE; i++) {
+            mirror_hash ^= pixel_mix(i, mirror[i]);
+        }
+        mirror_hash_ready = 1;
+    }
+    mirror_hash ^= pixel_mix(addr, mirror[addr]) ^ pixel_mix(addr, value);
+    mirror[addr] = value;
+}
+
+
+/*
+ * --- ESTADO DO ESPELHO ---
+ */
+
+void vram_mirror_invalidate(void) {
+    mirror_is_valid = 0;
+}
+
+int vram_mirror_valid(void) {
+    return mirror_is_valid;
+}
+
+const uint8_t *vram_mirror(void) {
+    return mirror;
+}
+
+uint32_t vram_mirror_hash(void) {
+    if (!mirror_hash_ready) {
+        mirror_set(0, mirror[0]);
+    }
+    return mirror_hash;
+}
+
+
+/*
+ * --- ESCRITA COMPLETA (sem comparação) ---
+ */
+
+int vram_write_rect(const uint8_t *src, int src_stride,
+                    int x, int y, int width, int height) {
+    lat_stage_enter(LAT_STAGE_UPLOAD);
+    for (int row = 0; row < height; row++) {
+        const uint8_t *line = src + row * src_stride;
+        int addr = (y + row) * IMG_WIDTH + x;
+
+        for (int col = 0; col < width; col++, addr++) {
+            int status = ASM_Store(addr, line[col], 0);
+            if (status != ERR_SUCCESS) {
+                // Coprocessador travado: cada pixel custaria dois timeouts; o
+                // resto da janela fica para a recuperação, com o espelho inválido
+                last_error = status;
+                mirror_is_valid = 0;
+                lat_stage_leave(LAT_STAGE_UPLOAD);
+                return 1;
+            }
+            mirror_set(addr, line[col]);
+        }
+    }
+    lat_stage_leave(LAT_STAGE_UPLOAD);
+    return 0;
+}
+
+int vram_write_frame(const uint8_t *frame) {
+    int errors = vram_write_rect(frame, IMG_WIDTH, 0, 0, IMG_WIDTH, IMG_HEIGHT);
+    mirror_is_valid = (errors == 0);
+    return errors;
+}
+
+
+/*
+ * --- ESCRITA INCREMENTAL (apenas pixels alterados) ---
+ */
+
+int vram_sync_rect(const uint8_t *src, int src_stride,
+                   int x, int y, int width, int height) {
+    if (!mirror_is_valid) {
+        if (vram_write_rect(src, src_stride, x, y, width, height) != 0) {
+            return -1;
+        }
+        return width * height;
+    }
+
+    int sent = 0;
+
+    lat_stage_enter(LAT_STAGE_UPLOAD);
+    for (int row = 0; row < height; row++) {
+        const uint8_t *line = src + row * src_stride;
+        uint8_t *shadow = mirror + (y + row) * IMG_WIDTH + x;
+
+        // Linha idêntica: nada a enviar
+        if (memcmp(line, shadow, width) == 0) {
+            continue;
+        }
+
+        for (int col = 0; col < width; col++) {
+            if (line[col] == shadow[col]) {
+                continue;
+            }
+            int addr = (y + row) * IMG_WIDTH + x + col;
+            int status = ASM_Store(addr, line[col], 0);
+            if (status != ERR_SUCCESS) {
+                last_error = status;
+                mirror_is_valid = 0;
+                lat_stage_leave(LAT_STAGE_UPLOAD);
+                return -1;
+            }
+            mirror_set(addr, line[col]);
+            sent++;
+        }
+    }
+    lat_stage_leave(LAT_STAGE_UPLOAD);
+
+    return sent;
+}
+
+int vram_sync_frame(const uint8_t *frame) {
+    int sent = vram_sync_rect(frame, IMG_WIDTH, 0, 0, IMG_WIDTH, IMG_HEIGHT);
+    if (sent >= 0) {
+        mirror_is_valid = 1;
+    }
+    return sent;
+}
+
+
+/*
+ * --- ERROS ---
+ */
+
+int vram_last_error(void) {
+    return last_error;
+}
+
+const char *vram_error_name(int status) {
+    switch (status) {
+        case ERR_SUCCESS: return "sucesso";
+        case ERR_ADDR:    return "endereco invalido";
+        case ERR_TIMEOUT: return "timeout";
+        case ERR_HW:      return "erro de hardware (FLAG_ERROR)";
+        default:          return "codigo desconhecido";
+    }
+}
+
+
+/*
+ * --- REFRESH ---
+ */
+
+void vram_refresh(void) {
+    ASM_Refresh();
+    lat_refresh();      // Fim da medição entrada -> tela, se houver uma aberta
+    usleep(VRAM_REFRESH_SETTLE_US);
+}
@@ -0,0 +1,115 @@
+/*
+ * =========================================================================
+ * vram_utils.h: Header de utilitários de VRAM
+ * =========================================================================
+ *
+ * Mantém uma cópia no host (espelho) do conteúdo da Memória Principal do
+ * FPGA e oferece escritas de janelas retangulares. As escritas "sync"
+ * enviam pelo barramento apenas os pixels que diferem do espelho, o que
+ * torna atualizações incrementais (pan, lupa, sobreposições) baratas.
+ *
+ * Toda escrita na Memória Principal deve passar por estas funções para
+ * que o espelho continue coerente com o hardware. A exceção são as
+ * sobreposições temporárias de overlay_utils.h, que restauram a imagem
+ * do espelho ao terminar.
+ *
+ */
+
+#ifndef VRAM_UTILS_H
+#define VRAM_UTILS_H
+
+#include <stdint.h>
+
+/* ===================================================================
+ * Constantes
+ * =================================================================== */
+
+/*
+ * Tempo para o FPGA copiar a Memória Principal para a memória de vídeo
+ * após um ASM_Refresh (~6 ciclos x 76800 pixels a 100 MHz = 4.6 ms).
+ * Durante a cópia a FSM ignora novos comandos.
+ */
+#define VRAM_REFRESH_SETTLE_US 6000
+
+/* ===================================================================
+ * Protótipos das Funções
+ * =================================================================== */
+
+/**
+ * @brief Marca o espelho como inválido (conteúdo da VRAM desconhecido)
+ */
+void vram_mirror_invalidate(void);
+
+/**
+ * @brief Informa se o espelho reflete o conteúdo atual da Memória Principal
+ * @return 1 se válido, 0 caso contrário
+ */
+int vram_mirror_valid(void);
+
+/**
+ * @brief Acesso somente leitura ao espelho (IMG_WIDTH x IMG_HEIGHT)
+ */
+const uint8_t *vram_mirror(void);
+
+/**
+ * @brief Hash do conteúdo do espelho, mantido a cada pixel escrito (O(1))
+ *
+ * Conteúdos iguais têm o mesmo hash, qualquer que seja o caminho de
+ * escritas até eles.
+ */
+uint32_t vram_mirror_hash(void);
+
+/**
+ * @brief Escreve um quadro completo na Memória Principal (todos os pixels)
+ *
+ * Para na primeira escrita que falha; o espelho fica inválido.
+ * @param frame Buffer IMG_WIDTH x IMG_HEIGHT
+ * @return 0 em caso de sucesso, 1 se uma escrita falhou
+ */
+int vram_write_frame(const uint8_t *frame);
+
+/**
+ * @brief Escreve uma janela retangular na Memória Principal (todos os pixels)
+ *
+ * Para na primeira escrita que falha; o espelho fica inválido.
+ * @param src Origem dos dados (primeiro pixel da janela)
+ * @param src_stride Largura de linha do buffer de origem
+ * @param x, y Canto superior esquerdo na VRAM
+ * @param width, height Dimensões da janela
+ * @return 0 em caso de sucesso, 1 se uma escrita falhou
+ */
+int vram_write_rect(const uint8_t *src, int src_stride,
+                    int x, int y, int width, int height);
+
+/**
+ * @brief Escreve apenas os pixels da janela que diferem do espelho
+ *
+ * Com o espelho inválido, a janela é escrita por completo.
+ * @return Número de pixels enviados, ou -1 se alguma escrita falhou
+ */
+int vram_sync_rect(const uint8_t *src, int src_stride,
+                   int x, int y, int width, int height);
+
+/**
+ * @brief Versão de vram_sync_rect para o quadro inteiro
+ * @return Número de pixels enviados, ou -1 se alguma escrita falhou
+ */
+int vram_sync_frame(const uint8_t *frame);
+
+/**
+ * @brief Código de retorno de ASM_Store da última escrita que falhou
+ * @return ERR_ADDR, ERR_TIMEOUT, ERR_HW, ou ERR_SUCCESS se nenhuma falhou
+ */
+int vram_last_error(void);
+
+/**
+ * @brief Nome legível de um código de retorno ERR_* (api.h)
+ */
+const char *vram_error_name(int status);
+
+/**
+ * @brief Envia o Refresh (Memória Principal -> vídeo) e aguarda a cópia
+ */
+void vram_refresh(void);
+
+#endif /* VRAM_UTILS_H */
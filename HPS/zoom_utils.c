@@ -0,0 +1,213 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "zoom_utils.h"
+
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+
+/*
+ * --- VIZINHO MAIS PRÓXIMO (fator inteiro) ---
+ */
+
+void zoom_nearest_rect(const uint8_t *src, int src_stride,
+                       int src_x, int src_y, int scale,
+                       uint8_t *dst, int dst_stride,
+                       int dst_x, int dst_y, int width, int height) {
+    for (int row = 0; row < height; row++) {
+        int dy = dst_y + row;
+        const uint8_t *src_line = src + (src_y + dy / scale) * src_stride + src_x;
+        uint8_t *dst_line = dst + dy * dst_stride;
+
+        // Linhas repetidas do mesmo pixel de origem: copia a linha anterior
+        if (row > 0 && dy % scale != 0) {
+            memcpy(dst_line + dst_x, dst_line - dst_stride + dst_x, width);
+            continue;
+        }
+
+        for (int col = 0; col < width; col++) {
+            int dx = dst_x + col;
+            dst_line[dx] = src_line[dx / scale];
+        }
+    }
+}
+
+
+/*
+ * --- REPLICAÇÃO DE PIXEL ---
+ */
+
+void zoom_replicate(const uint8_t *src, int src_stride,
+                    int src_x, int src_y, int scale,
+                    uint8_t *dst, int dst_stride, int width, int height) {
+    for (int row = 0; row < height; row++) {
+        uint8_t *dst_line = dst + row * dst_stride;
+
+        if (row % scale != 0) {
+            memcpy(dst_line, dst_line - dst_stride, width);
+            continue;
+        }
+
+        const uint8_t *src_line = src + (src_y + row / scale) * src_stride + src_x;
+        for (int col = 0; col < width; col += scale) {
+            int run = (width - col < scale) ? width - col : scale;
+            memset(dst_line + col, src_line[col / scale], run);
+        }
+    }
+}
+
+
+/*
+ * --- DECIMAÇÃO ---
+ */
+
+void zoom_decimate(const uint8_t *src, int src_stride,
+                   int src_x, int src_y, int factor,
+                   uint8_t *dst, int dst_stride, int width, int height) {
+    for (int row = 0; row < height; row++) {
+        const uint8_t *src_line = src + (src_y + row * factor) * src_stride + src_x;
+        uint8_t *dst_line = dst + row * dst_stride;
+
+        for (int col = 0; col < width; col++) {
+            dst_line[col] = src_line[col * factor];
+        }
+    }
+}
+
+
+/*
+ * --- MÉDIA DE BLOCOS ---
+ */
+
+void zoom_average(const uint8_t *src, int src_stride,
+                  int src_x, int src_y, int factor,
+                  uint8_t *dst, int dst_stride, int width, int height) {
+    int area = factor * factor;
+
+    for (int row = 0; row < height; row++) {
+        const uint8_t *block_line = src + (src_y + row * factor) * src_stride + src_x;
+        uint8_t *dst_line = dst + row * dst_stride;
+
+        for (int col = 0; col < width; col++) {
+            const uint8_t *block = block_line + col * factor;
+            int sum = 0;
+
+            for (int i = 0; i < factor; i++) {
+                for (int j = 0; j < factor; j++) {
+                    sum += block[i * src_stride + j];
+                }
+            }
+            dst_line[col] = (uint8_t)((sum + area / 2) / area);
+        }
+    }
+}
+
+
+/*
+ * --- BILINEAR EM PONTO FIXO ---
+ */
+
+// Passada horizontal de uma linha: resultado em Q8 (valor * 256)
+static void bilinear_row(const uint8_t *src_line, const int16_t *x0, const int16_t *x1,
+                         const uint8_t *wx, uint16_t *out, int width) {
+    for (int i = 0; i < width; i++) {
+        int a = src_line[x0[i]];
+        int b = src_line[x1[i]];
+        out[i] = (uint16_t)(a * (256 - wx[i]) + b * wx[i]);
+    }
+}
+
+// Passada vertical: mistura duas linhas Q8 com o mesmo peso para a linha toda
+static void bilinear_blend(const uint16_t *top, const uint16_t *bottom, int wy,
+                           uint8_t *out, int width) {
+    int i = 0;
+
+#ifdef __ARM_NEON
+    uint16x4_t w_top = vdup_n_u16((uint16_t)(256 - wy));
+    uint16x4_t w_bottom = vdup_n_u16((uint16_t)wy);
+
+    for (; i + 8 <= width; i += 8) {
+        uint16x8_t t = vld1q_u16(top + i);
+        uint16x8_t b = vld1q_u16(bottom + i);
+
+        uint32x4_t lo = vmull_u16(vget_low_u16(t), w_top);
+        uint32x4_t hi = vmull_u16(vget_high_u16(t), w_top);
+        lo = vmlal_u16(lo, vget_low_u16(b), w_bottom);
+        hi = vmlal_u16(hi, vget_high_u16(b), w_bottom);
+
+        // Q16 -> inteiro com arredondamento
+        uint16x8_t sum = vcombine_u16(vrshrn_n_u32(lo, 16), vrshrn_n_u32(hi, 16));
+        vst1_u8(out + i, vmovn_u16(sum));
+    }
+#endif
+
+    for (; i < width; i++) {
+        uint32_t v = (uint32_t)top[i] * (256 - wy) + (uint32_t)bottom[i] * wy;
+        out[i] = (uint8_t)((v + (1u << 15)) >> 16);
+    }
+}
+
+// Limita a coordenada Q16 à imagem e separa vizinhos e peso de 8 bits
+static void bilinear_coord(int32_t pos, int limit, int16_t *i0, int16_t *i1, uint8_t *weight) {
+    int32_t max_pos = (int32_t)(limit - 1) << 16;
+
+    if (pos < 0) pos = 0;
+    if (pos > max_pos) pos = max_pos;
+
+    *i0 = (int16_t)(pos >> 16);
+    *i1 = (int16_t)((*i0 + 1 < limit) ? *i0 + 1 : *i0);
+    *weight = (uint8_t)((pos >> 8) & 0xFF);
+}
+
+int zoom_bilinear(const uint8_t *src, int src_stride, int src_width, int src_height,
+                  int32_t origin_x_q16, int32_t origin_y_q16, int32_t step_q16,
+                  uint8_t *dst, int dst_stride, int width, int height) {
+    int16_t *x0 = (int16_t*)malloc(2 * width * sizeof(int16_t));
+    uint8_t *wx = (uint8_t*)malloc(width);
+    uint16_t *rows = (uint16_t*)malloc(2 * width * sizeof(uint16_t));
+
+    if (!x0 || !wx || !rows) {
+        free(x0);
+        free(wx);
+        free(rows);
+        return -1;
+    }
+
+    // Tabela de colunas: igual para todas as linhas
+    int16_t *x1 = x0 + width;
+    for (int i = 0; i < width; i++) {
+        bilinear_coord(origin_x_q16 + i * step_q16, src_width, &x0[i], &x1[i], &wx[i]);
+    }
+
+    uint16_t *top = rows;
+    uint16_t *bottom = rows + width;
+    int cached_row = -2;    // linha de origem em 'top' ('bottom' = linha seguinte)
+
+    for (int j = 0; j < height; j++) {
+        int16_t y0, y1;
+        uint8_t wy;
+        bilinear_coord(origin_y_q16 + j * step_q16, src_height, &y0, &y1, &wy);
+
+        // Reaproveitar passadas horizontais já calculadas
+        if (y0 != cached_row) {
+            if (y0 == cached_row + 1) {
+                uint16_t *tmp = top;
+                top = bottom;
+                bottom = tmp;
+            } else {
+                bilinear_row(src + y0 * src_stride, x0, x1, wx, top, width);
+            }
+            bilinear_row(src + y1 * src_stride, x0, x1, wx, bottom, width);
+            cached_row = y0;
+        }
+
+        bilinear_blend(top, bottom, wy, dst + j * dst_stride, width);
+    }
+
+    free(x0);
+    free(wx);
+    free(rows);
+    return 0;
+}
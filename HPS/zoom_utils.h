@@ -0,0 +1,109 @@
+/*
+ * =========================================================================
+ * zoom_utils.h: Header de kernels de zoom no HPS
+ * =========================================================================
+ *
+ * Kernels de reamostragem executados na CPU ARM. São usados quando a
+ * atualização é pequena demais para compensar uma passada completa do
+ * coprocessador (ex.: faixas expostas durante o pan de uma janela).
+ *
+ */
+
+#ifndef ZOOM_UTILS_H
+#define ZOOM_UTILS_H
+
+#include <stdint.h>
+
+/* ===================================================================
+ * Algoritmos (mesmos do coprocessador)
+ * =================================================================== */
+#define ZOOM_ALG_NEAREST      0   // Vizinho mais próximo (zoom in)
+#define ZOOM_ALG_REPLICATION  1   // Replicação de pixel (zoom in)
+#define ZOOM_ALG_DECIMATION   2   // Decimação (zoom out)
+#define ZOOM_ALG_AVERAGE      3   // Média de blocos (zoom out)
+
+/* ===================================================================
+ * Zoom contínuo (ponto fixo)
+ * =================================================================== */
+#define ZOOM_Q4_ONE   16      // 1.0x em passos de 1/16
+#define ZOOM_Q4_MIN   16      // 1.0x
+#define ZOOM_Q4_MAX   128     // 8.0x
+
+/* ===================================================================
+ * Protótipos das Funções
+ * =================================================================== */
+
+/**
+ * @brief Vizinho mais próximo com fator inteiro, para uma sub-janela do destino
+ *
+ * O pixel de destino (dx, dy) recebe src[src_y + dy/scale][src_x + dx/scale].
+ * Apenas o retângulo [dst_x, dst_x+width) x [dst_y, dst_y+height) do
+ * destino é calculado, o que permite renderizar só as faixas novas.
+ *
+ * @param src Imagem de origem
+ * @param src_stride Largura de linha da origem
+ * @param src_x, src_y Canto da janela de origem
+ * @param scale Fator de ampliação (>= 1)
+ * @param dst Buffer de destino (a vista inteira)
+ * @param dst_stride Largura de linha do destino
+ * @param dst_x, dst_y Canto da sub-janela a calcular
+ * @param width, height Dimensões da sub-janela
+ */
+void zoom_nearest_rect(const uint8_t *src, int src_stride,
+                       int src_x, int src_y, int scale,
+                       uint8_t *dst, int dst_stride,
+                       int dst_x, int dst_y, int width, int height);
+
+/**
+ * @brief Replicação de pixel com fator inteiro (janela inteira do destino)
+ *
+ * Mesmo resultado do vizinho mais próximo para fatores inteiros, mas
+ * escreve cada pixel de origem como uma sequência (memset) e duplica as
+ * linhas repetidas, como o controlador de vídeo faz no hardware.
+ *
+ * @param width, height Dimensões do destino
+ */
+void zoom_replicate(const uint8_t *src, int src_stride,
+                    int src_x, int src_y, int scale,
+                    uint8_t *dst, int dst_stride, int width, int height);
+
+/**
+ * @brief Decimação: mantém um pixel a cada 'factor' em cada eixo
+ * @param width, height Dimensões do destino (origem = width*factor x height*factor)
+ */
+void zoom_decimate(const uint8_t *src, int src_stride,
+                   int src_x, int src_y, int factor,
+                   uint8_t *dst, int dst_stride, int width, int height);
+
+/**
+ * @brief Média de blocos factor x factor
+ * @param width, height Dimensões do destino (origem = width*factor x height*factor)
+ */
+void zoom_average(const uint8_t *src, int src_stride,
+                  int src_x, int src_y, int factor,
+                  uint8_t *dst, int dst_stride, int width, int height);
+
+/**
+ * @brief Interpolação bilinear em ponto fixo, separável (linhas e colunas)
+ *
+ * O pixel de destino (i, j) amostra a origem na coordenada
+ * (origin_x + i*step, origin_y + j*step), em Q16.16. Coordenadas fora da
+ * imagem são limitadas à borda. A passada horizontal é feita uma vez por
+ * linha de origem (reaproveitada enquanto o zoom repete a linha) e a
+ * vertical usa NEON quando disponível.
+ *
+ * @param src Imagem de origem
+ * @param src_stride Largura de linha da origem
+ * @param src_width, src_height Limites válidos da origem
+ * @param origin_x_q16, origin_y_q16 Coordenada do primeiro pixel (Q16.16)
+ * @param step_q16 Passo na origem por pixel de destino (Q16.16, = 1/zoom)
+ * @param dst Destino
+ * @param dst_stride Largura de linha do destino
+ * @param width, height Dimensões do destino
+ * @return 0 em caso de sucesso, -1 se faltar memória
+ */
+int zoom_bilinear(const uint8_t *src, int src_stride, int src_width, int src_height,
+                  int32_t origin_x_q16, int32_t origin_y_q16, int32_t step_q16,
+                  uint8_t *dst, int dst_stride, int width, int height);
+
+#endif /* ZOOM_UTILS_H */